@@ -300,5 +300,28 @@ CVarNext(CVar* cVar)
     return cVar + 1;
 }
 
+//------------------------------------------------------------------------------
+/**
+    Unknown names are reported and skipped, so cvars have to be created before
+    the command line is parsed.
+*/
+void
+CVarParseCommandLine(int argc, const char** argv)
+{
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (argv[i][0] != '-')
+            continue;
+
+        CVar* cVar = CVarGet(argv[i] + 1);
+        if (cVar == nullptr)
+        {
+            n_printf("Warning: Unknown CVar '%s' on command line.\n", argv[i] + 1);
+            continue;
+        }
+        CVarParseWrite(cVar, argv[++i]);
+    }
+}
+
 
 } // namespace Core
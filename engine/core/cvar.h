@@ -82,5 +82,7 @@ CVar* CVarsBegin();
 CVar* CVarsEnd();
 /// increment the iterator
 CVar* CVarNext(CVar*);
+/// Write "-name value" pairs from the command line to already created cvars
+void CVarParseCommandLine(int argc, const char** argv);
 
 } // namespace Core
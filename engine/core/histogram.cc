@@ -0,0 +1,77 @@
+//------------------------------------------------------------------------------
+//  histogram.cc
+//  @copyright (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "config.h"
+#include "histogram.h"
+#include <algorithm>
+
+namespace Core
+{
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+Histogram::Add(const Histogram& other)
+{
+    for (uint32_t i = 0; i < BucketCount; i++)
+        this->buckets[i] += other.buckets[i];
+    this->count += other.count;
+    this->sum += other.sum;
+    this->min = std::min(this->min, other.min);
+    this->max = std::max(this->max, other.max);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+Histogram::Clear()
+{
+    std::fill(std::begin(this->buckets), std::end(this->buckets), 0);
+    this->count = 0;
+    this->sum = 0;
+    this->min = UINT64_MAX;
+    this->max = 0;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Reports the middle of the bucket the percentile falls in, kept within
+    the recorded range so the extremes come out exact.
+*/
+uint64_t
+Histogram::Percentile(double percentile) const
+{
+    if (this->count == 0)
+        return 0;
+
+    uint64_t const rank = std::max<uint64_t>(1, (uint64_t)(std::clamp(percentile, 0.0, 100.0) / 100.0 * this->count + 0.5));
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < BucketCount; i++)
+    {
+        seen += this->buckets[i];
+        if (seen >= rank)
+        {
+            uint64_t const low = LowestValue(i);
+            uint64_t const high = i + 1 < BucketCount ? LowestValue(i + 1) : low;
+            return std::clamp(low + (high - low) / 2, this->min, this->max);
+        }
+    }
+    return this->max;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+uint64_t
+Histogram::LowestValue(uint32_t index)
+{
+    if (index < SubBucketCount)
+        return index;
+    uint32_t const shift = index / SubBucketHalf - 1;
+    return (uint64_t)(index - shift * SubBucketHalf) << shift;
+}
+
+} // namespace Core
@@ -0,0 +1,99 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @file histogram.h
+
+    @class Core::Histogram
+
+    Log-linear histogram of unsigned integer samples in the style of
+    HdrHistogram. Values below 2^SubBucketBits get a bucket each, above that
+    every power of two is split into 2^(SubBucketBits - 1) equal buckets, so
+    any recorded value is known to within about 3%. Values at or above
+    2^MaxBits share the last bucket.
+
+    Record is a bit scan and an increment, cheap enough to sample every tick
+    phase. Percentiles are read by walking the buckets.
+
+    @copyright
+    (C) 2024 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include <stdint.h>
+#include <bit>
+
+namespace Core
+{
+
+class Histogram
+{
+public:
+    /// values below 2^SubBucketBits are recorded exactly
+    static constexpr uint32_t SubBucketBits = 6;
+    /// values from 2^MaxBits up share the last bucket
+    static constexpr uint32_t MaxBits = 40;
+    static constexpr uint32_t SubBucketCount = 1u << SubBucketBits;
+    static constexpr uint32_t SubBucketHalf = SubBucketCount / 2;
+    static constexpr uint32_t BucketCount = (MaxBits - SubBucketBits + 1) * SubBucketHalf + SubBucketHalf;
+
+    /// add one sample
+    void Record(uint64_t value);
+    /// add all samples of other
+    void Add(const Histogram& other);
+    /// forget all samples
+    void Clear();
+
+    /// number of samples
+    uint64_t Count() const { return this->count; }
+    /// smallest and largest sample, 0 if empty
+    uint64_t Min() const { return this->count > 0 ? this->min : 0; }
+    uint64_t Max() const { return this->max; }
+    /// mean of the samples, exact
+    double Mean() const { return this->count > 0 ? (double)this->sum / this->count : 0.0; }
+    /// value below which percentile of 0..100 of the samples lie, to bucket precision
+    uint64_t Percentile(double percentile) const;
+
+private:
+    /// bucket of value
+    static uint32_t Index(uint64_t value);
+    /// smallest value in bucket index
+    static uint64_t LowestValue(uint32_t index);
+
+    uint64_t buckets[BucketCount] = {};
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t min = UINT64_MAX;
+    uint64_t max = 0;
+};
+
+//------------------------------------------------------------------------------
+/**
+    The shift drops all but the top SubBucketBits of the value, the top bit
+    of what is left is always set, so its lower half indexes the buckets of
+    the value's power of two.
+*/
+inline uint32_t
+Histogram::Index(uint64_t value)
+{
+    if (value >= (1ull << MaxBits))
+        return BucketCount - 1;
+    uint32_t const width = (uint32_t)std::bit_width(value);
+    uint32_t const shift = width > SubBucketBits ? width - SubBucketBits : 0;
+    return shift * SubBucketHalf + (uint32_t)(value >> shift);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline void
+Histogram::Record(uint64_t value)
+{
+    this->buckets[Index(value)]++;
+    this->count++;
+    this->sum += value;
+    if (value < this->min)
+        this->min = value;
+    if (value > this->max)
+        this->max = value;
+}
+
+} // namespace Core
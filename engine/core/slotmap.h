@@ -0,0 +1,345 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @file slotmap.h
+
+    @copyright
+    (C) 2024 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include <vector>
+#include <utility>
+#include "idpool.h"
+
+namespace Util
+{
+    //------------------------------------------------------------------------------
+    /**
+        Handle into a SlotMap, same layout as the other generational ids
+    */
+    struct SlotId
+    {
+        uint32_t index : 22; // 4M concurrent values
+        uint32_t generation : 10; // 1024 generations per index
+
+        static SlotId Create(uint32_t id)
+        {
+            SlotId ret;
+            ret.index = id & 0x003FFFFF;
+            ret.generation = (id & 0xFFC00000) >> 22;
+            return ret;
+        }
+        static SlotId Create(uint32_t index, uint32_t generation)
+        {
+            SlotId ret;
+            ret.index = index;
+            ret.generation = generation;
+            return ret;
+        }
+        explicit constexpr operator uint32_t() const
+        {
+            return ((generation << 22) & 0xFFC00000) + (index & 0x003FFFFF);
+        }
+        static SlotId Invalid()
+        {
+            return Create(0x003FFFFF, 0x3FF);
+        }
+        const bool operator==(const SlotId& rhs) const { return uint32_t(*this) == uint32_t(rhs); }
+        const bool operator!=(const SlotId& rhs) const { return uint32_t(*this) != uint32_t(rhs); }
+    };
+
+    //------------------------------------------------------------------------------
+    /**
+        Generational slot map
+
+        Values live densely packed in one array so iterating them is a linear
+        walk. Removal moves the last value into the hole, so the order of values
+        changes and pointers into the map are only valid until the next Insert or
+        Remove. Handles stay valid until their value is removed, stale handles are
+        caught by their generation.
+
+        Every value also has a unique 32 bit key, the network uuid, which is looked
+        up in O(1) through an open addressing index with linear probing.
+    */
+    template<typename T, typename ID_T = SlotId>
+    class SlotMap
+    {
+    public:
+        /// insert value under key, returns ID_T::Invalid() if the key is already in use
+        ID_T Insert(uint32_t key, T value);
+        /// remove value, returns false for a stale handle
+        bool Remove(ID_T id);
+        /// remove value by key, returns false if not present
+        bool RemoveKey(uint32_t key);
+        /// remove the value at dense index, the last value is moved to index
+        void RemoveAt(size_t index);
+        /// remove all values, keeps allocations
+        void Clear();
+
+        /// check if handle refers to a live value
+        bool IsValid(ID_T id) const;
+        /// get value by handle, nullptr if stale
+        T* Get(ID_T id);
+        /// get value by key, nullptr if not present
+        T* Find(uint32_t key);
+        /// get handle by key, ID_T::Invalid() if not present
+        ID_T FindId(uint32_t key) const;
+        /// get dense index by key, Size() if not present
+        size_t FindIndex(uint32_t key) const;
+        /// check if key is present
+        bool Contains(uint32_t key) const;
+
+        /// handle of the value at dense index
+        ID_T IdAt(size_t index) const { return this->ids[index]; }
+        /// key of the value at dense index
+        uint32_t KeyAt(size_t index) const { return this->keys[index]; }
+
+        size_t Size() const { return this->values.size(); }
+        bool Empty() const { return this->values.empty(); }
+        T& operator[](size_t index) { return this->values[index]; }
+        const T& operator[](size_t index) const { return this->values[index]; }
+        typename std::vector<T>::iterator begin() { return this->values.begin(); }
+        typename std::vector<T>::iterator end() { return this->values.end(); }
+        typename std::vector<T>::const_iterator begin() const { return this->values.begin(); }
+        typename std::vector<T>::const_iterator end() const { return this->values.end(); }
+
+    private:
+        static constexpr uint32_t EmptySlot = 0xFFFFFFFF;
+
+        /// index table slot of key, either holding it or the empty slot to put it in
+        size_t Probe(uint32_t key) const;
+        /// remove key from the index table
+        void Unindex(uint32_t key);
+        /// double the index table
+        void Grow();
+
+        IdPool<ID_T> pool;
+        /// dense arrays
+        std::vector<T> values;
+        std::vector<ID_T> ids;
+        std::vector<uint32_t> keys;
+        /// handle index -> dense index
+        std::vector<uint32_t> denseIndex;
+        /// open addressing key index, holds dense indices, size is a power of two
+        std::vector<uint32_t> table;
+    };
+
+    //------------------------------------------------------------------------------
+    /**
+        Fibonacci hashing, uuids are sequential so the low bits alone would cluster.
+    */
+    template<typename T, typename ID_T>
+    size_t
+        SlotMap<T, ID_T>::Probe(uint32_t key) const
+    {
+        size_t const mask = this->table.size() - 1;
+        size_t slot = (size_t)((key * 2654435769u) >> 7) & mask;
+        while (this->table[slot] != EmptySlot && this->keys[this->table[slot]] != key)
+            slot = (slot + 1) & mask;
+        return slot;
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+    */
+    template<typename T, typename ID_T>
+    void
+        SlotMap<T, ID_T>::Grow()
+    {
+        size_t const size = this->table.empty() ? 64 : this->table.size() * 2;
+        this->table.assign(size, EmptySlot);
+        for (uint32_t i = 0; i < (uint32_t)this->keys.size(); i++)
+            this->table[this->Probe(this->keys[i])] = i;
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+    */
+    template<typename T, typename ID_T>
+    ID_T
+        SlotMap<T, ID_T>::Insert(uint32_t key, T value)
+    {
+        // keep the load factor at or below one half
+        if ((this->values.size() + 1) * 2 > this->table.size())
+            this->Grow();
+
+        size_t const slot = this->Probe(key);
+        if (this->table[slot] != EmptySlot)
+            return ID_T::Invalid();
+
+        ID_T id;
+        this->pool.Allocate(id);
+        if (id.index >= this->denseIndex.size())
+            this->denseIndex.resize(id.index + 1);
+
+        uint32_t const index = (uint32_t)this->values.size();
+        this->denseIndex[id.index] = index;
+        this->table[slot] = index;
+        this->values.push_back(std::move(value));
+        this->ids.push_back(id);
+        this->keys.push_back(key);
+        return id;
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+        Backward shift deletion, moves later entries of the probe chain up so
+        lookups never need tombstones.
+    */
+    template<typename T, typename ID_T>
+    void
+        SlotMap<T, ID_T>::Unindex(uint32_t key)
+    {
+        size_t const mask = this->table.size() - 1;
+        size_t hole = this->Probe(key);
+        n_assert(this->table[hole] != EmptySlot);
+
+        size_t slot = hole;
+        while (true)
+        {
+            slot = (slot + 1) & mask;
+            if (this->table[slot] == EmptySlot)
+                break;
+            size_t const home = (size_t)((this->keys[this->table[slot]] * 2654435769u) >> 7) & mask;
+            // entry may move into the hole if its home is not cyclically within (hole, slot]
+            bool const between = (hole <= slot) ? (hole < home && home <= slot) : (hole < home || home <= slot);
+            if (!between)
+            {
+                this->table[hole] = this->table[slot];
+                hole = slot;
+            }
+        }
+        this->table[hole] = EmptySlot;
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+    */
+    template<typename T, typename ID_T>
+    void
+        SlotMap<T, ID_T>::RemoveAt(size_t index)
+    {
+        n_assert(index < this->values.size());
+        this->Unindex(this->keys[index]);
+        this->pool.Deallocate(this->ids[index]);
+
+        size_t const last = this->values.size() - 1;
+        if (index != last)
+        {
+            this->values[index] = std::move(this->values[last]);
+            this->ids[index] = this->ids[last];
+            this->keys[index] = this->keys[last];
+            this->denseIndex[this->ids[index].index] = (uint32_t)index;
+            this->table[this->Probe(this->keys[index])] = (uint32_t)index;
+        }
+        this->values.pop_back();
+        this->ids.pop_back();
+        this->keys.pop_back();
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+    */
+    template<typename T, typename ID_T>
+    bool
+        SlotMap<T, ID_T>::Remove(ID_T id)
+    {
+        if (!this->IsValid(id))
+            return false;
+        this->RemoveAt(this->denseIndex[id.index]);
+        return true;
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+    */
+    template<typename T, typename ID_T>
+    bool
+        SlotMap<T, ID_T>::RemoveKey(uint32_t key)
+    {
+        size_t const index = this->FindIndex(key);
+        if (index == this->values.size())
+            return false;
+        this->RemoveAt(index);
+        return true;
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+    */
+    template<typename T, typename ID_T>
+    void
+        SlotMap<T, ID_T>::Clear()
+    {
+        while (!this->values.empty())
+            this->RemoveAt(this->values.size() - 1);
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+    */
+    template<typename T, typename ID_T>
+    bool
+        SlotMap<T, ID_T>::IsValid(ID_T id) const
+    {
+        return this->pool.IsValid(id) && id.index < this->denseIndex.size() && this->denseIndex[id.index] < this->ids.size() && this->ids[this->denseIndex[id.index]] == id;
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+    */
+    template<typename T, typename ID_T>
+    T*
+        SlotMap<T, ID_T>::Get(ID_T id)
+    {
+        if (!this->IsValid(id))
+            return nullptr;
+        return &this->values[this->denseIndex[id.index]];
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+    */
+    template<typename T, typename ID_T>
+    size_t
+        SlotMap<T, ID_T>::FindIndex(uint32_t key) const
+    {
+        if (this->table.empty())
+            return this->values.size();
+        uint32_t const index = this->table[this->Probe(key)];
+        return (index == EmptySlot) ? this->values.size() : index;
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+    */
+    template<typename T, typename ID_T>
+    T*
+        SlotMap<T, ID_T>::Find(uint32_t key)
+    {
+        size_t const index = this->FindIndex(key);
+        return (index == this->values.size()) ? nullptr : &this->values[index];
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+    */
+    template<typename T, typename ID_T>
+    ID_T
+        SlotMap<T, ID_T>::FindId(uint32_t key) const
+    {
+        size_t const index = this->FindIndex(key);
+        return (index == this->values.size()) ? ID_T::Invalid() : this->ids[index];
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+    */
+    template<typename T, typename ID_T>
+    bool
+        SlotMap<T, ID_T>::Contains(uint32_t key) const
+    {
+        return this->FindIndex(key) != this->values.size();
+    }
+
+}
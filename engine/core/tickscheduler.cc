@@ -0,0 +1,108 @@
+//------------------------------------------------------------------------------
+//  tickscheduler.cc
+//  @copyright (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "config.h"
+#include "tickscheduler.h"
+#include <thread>
+
+namespace Core
+{
+
+//------------------------------------------------------------------------------
+/**
+*/
+TickScheduler::TickScheduler()
+{
+    this->SetTickRate(this->tickRate);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TickScheduler::SetTickRate(int ticksPerSecond)
+{
+    n_assert(ticksPerSecond > 0);
+    this->tickRate = ticksPerSecond;
+    this->tickDuration = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / ticksPerSecond));
+    this->nextTick = Clock::now() + this->tickDuration;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+int
+TickScheduler::GetTickRate() const
+{
+    return this->tickRate;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+double
+TickScheduler::GetTickDelta() const
+{
+    return 1.0 / this->tickRate;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TickScheduler::Start()
+{
+    this->tick = 0;
+    this->overruns = 0;
+    this->droppedTicks = 0;
+    this->nextTick = Clock::now() + this->tickDuration;
+}
+
+//------------------------------------------------------------------------------
+/**
+    The accumulator is kept as the time point of the next due tick, which
+    avoids drift from summing up rounded frame times.
+*/
+int
+TickScheduler::Advance()
+{
+    Clock::time_point const now = Clock::now();
+    if (now < this->nextTick)
+        return 0;
+
+    uint64_t due = 1 + (uint64_t)((now - this->nextTick) / this->tickDuration);
+    if (due > 1)
+        this->overruns++;
+
+    if (due > (uint64_t)this->maxCatchUpTicks)
+    {
+        // skip the backlog instead of trying to simulate all of it
+        this->droppedTicks += due - this->maxCatchUpTicks;
+        due = this->maxCatchUpTicks;
+        this->nextTick = now + this->tickDuration;
+    }
+    else
+    {
+        this->nextTick += this->tickDuration * due;
+    }
+
+    this->tick += due;
+    return (int)due;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+TickScheduler::WaitForNextTick()
+{
+    Clock::time_point const wakeUp = this->nextTick - this->spinThreshold;
+    if (Clock::now() < wakeUp)
+        std::this_thread::sleep_until(wakeUp);
+
+    while (Clock::now() < this->nextTick)
+        std::this_thread::yield();
+}
+
+} // namespace Core
@@ -0,0 +1,69 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @file tickscheduler.h
+
+    @class Core::TickScheduler
+
+    Fixed timestep scheduler.
+    Accumulates wall clock time and hands out a whole number of fixed size
+    ticks, independent of how long the surrounding frame took. If the loop
+    falls behind, at most maxCatchUpTicks are run in one go and the rest is
+    dropped, so a stall cannot snowball into a spiral of death.
+
+    WaitForNextTick() sleeps for the bulk of the remaining time and spins for
+    the last part, since OS sleeps are not precise enough for high tick rates.
+    
+    @copyright
+    (C) 2024 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include <chrono>
+
+namespace Core
+{
+
+class TickScheduler
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// constructor
+    TickScheduler();
+
+    /// set number of ticks per second, resets the accumulator
+    void SetTickRate(int ticksPerSecond);
+    /// get number of ticks per second
+    int GetTickRate() const;
+    /// get the fixed delta time of a tick in seconds
+    double GetTickDelta() const;
+
+    /// restart the clock, call once before entering the loop
+    void Start();
+    /// accumulate elapsed time and return the number of ticks to run now
+    int Advance();
+    /// block until the next tick is due
+    void WaitForNextTick();
+
+    /// number of ticks handed out since Start
+    uint64_t tick = 0;
+    /// number of Advance calls that had to run more than one tick to catch up
+    uint64_t overruns = 0;
+    /// number of ticks discarded because the loop fell too far behind
+    uint64_t droppedTicks = 0;
+    /// maximum number of ticks to run in one Advance call
+    int maxCatchUpTicks = 5;
+    /// how long before a tick is due we stop sleeping and start spinning
+#ifdef _WIN32
+    Clock::duration spinThreshold = std::chrono::microseconds(1500);
+#else
+    Clock::duration spinThreshold = std::chrono::microseconds(300);
+#endif
+
+private:
+    int tickRate = 60;
+    Clock::duration tickDuration;
+    Clock::time_point nextTick;
+};
+
+} // namespace Core
@@ -0,0 +1,96 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @file bytestream.h
+
+    @struct Net::ByteWriter
+    @struct Net::ByteReader
+
+    Minimal little endian byte stream for hand packed network payloads.
+    The writer appends to a caller owned vector so its capacity can be reused
+    between ticks. The reader never reads out of bounds, once it runs past the
+    end all reads return zero and Ok() returns false.
+
+    @copyright
+    (C) 2024 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include <vector>
+#include <cstring>
+
+namespace Net
+{
+
+struct ByteWriter
+{
+    explicit ByteWriter(std::vector<uint8_t>& buffer) : buffer(buffer) {}
+
+    void WriteU8(uint8_t value) { this->buffer.push_back(value); }
+    void WriteU16(uint16_t value) { this->WriteBytes(&value, sizeof(value)); }
+    /// low three bytes of value
+    void WriteU24(uint32_t value) { this->WriteBytes(&value, 3); }
+    void WriteU32(uint32_t value) { this->WriteBytes(&value, sizeof(value)); }
+    void WriteFloat(float value) { this->WriteBytes(&value, sizeof(value)); }
+    /// LEB128 variable length unsigned integer, 1 byte for values < 128
+    void WriteVarUint(uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            this->buffer.push_back((uint8_t)(value | 0x80));
+            value >>= 7;
+        }
+        this->buffer.push_back((uint8_t)value);
+    }
+    void WriteBytes(const void* data, size_t size)
+    {
+        const uint8_t* bytes = (const uint8_t*)data;
+        this->buffer.insert(this->buffer.end(), bytes, bytes + size);
+    }
+
+    std::vector<uint8_t>& buffer;
+};
+
+struct ByteReader
+{
+    ByteReader(const uint8_t* data, size_t size) : data(data), size(size) {}
+
+    uint8_t ReadU8() { uint8_t v = 0; this->ReadBytes(&v, sizeof(v)); return v; }
+    uint16_t ReadU16() { uint16_t v = 0; this->ReadBytes(&v, sizeof(v)); return v; }
+    uint32_t ReadU24() { uint32_t v = 0; this->ReadBytes(&v, 3); return v; }
+    uint32_t ReadU32() { uint32_t v = 0; this->ReadBytes(&v, sizeof(v)); return v; }
+    float ReadFloat() { float v = 0; this->ReadBytes(&v, sizeof(v)); return v; }
+    uint64_t ReadVarUint()
+    {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            uint8_t const byte = this->ReadU8();
+            value |= (uint64_t)(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
+                return value;
+        }
+        this->ok = false;
+        return 0;
+    }
+    void ReadBytes(void* out, size_t count)
+    {
+        if (!this->ok || this->size - this->pos < count)
+        {
+            this->ok = false;
+            memset(out, 0, count);
+            return;
+        }
+        memcpy(out, this->data + this->pos, count);
+        this->pos += count;
+    }
+    /// false if any read went past the end of the data
+    bool Ok() const { return this->ok; }
+    bool AtEnd() const { return this->pos == this->size; }
+
+    const uint8_t* data;
+    size_t size;
+    size_t pos = 0;
+    bool ok = true;
+};
+
+} // namespace Net
@@ -0,0 +1,303 @@
+//------------------------------------------------------------------------------
+//  capture.cc
+//  @copyright (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "config.h"
+#include "capture.h"
+#include <cstring>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Net
+{
+
+static_assert(sizeof(CaptureHeader) % 8 == 0 && sizeof(CaptureRecord) % 8 == 0, "records have to stay 8 byte aligned");
+
+//------------------------------------------------------------------------------
+/**
+*/
+static size_t
+Padded(size_t bytes)
+{
+    return (bytes + 7) & ~(size_t)7;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+CaptureWriter::CaptureWriter()
+{
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+CaptureWriter::~CaptureWriter()
+{
+    this->Close();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+CaptureWriter::Open(const char* path, uint32_t tickRate)
+{
+    this->Close();
+#if defined(__unix__) || defined(__APPLE__)
+    this->file = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+#else
+    this->file = fopen(path, "wb");
+#endif
+    if (!this->IsOpen())
+        return false;
+
+    CaptureHeader header;
+    header.tickRate = tickRate;
+    if (!this->Reserve(sizeof(header)))
+        return false;
+    this->Append(&header, sizeof(header));
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+CaptureWriter::Close()
+{
+#if defined(__unix__) || defined(__APPLE__)
+    if (this->mapping != nullptr)
+        munmap(this->mapping, this->capacity);
+    if (this->file != -1)
+    {
+        if (ftruncate(this->file, (off_t)this->size) != 0)
+            fprintf(stderr, "Could not trim the capture file.\n");
+        close(this->file);
+    }
+    this->file = -1;
+    this->mapping = nullptr;
+    this->capacity = 0;
+#else
+    if (this->file != nullptr)
+        fclose(this->file);
+    this->file = nullptr;
+#endif
+    this->size = 0;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+CaptureWriter::IsOpen() const
+{
+#if defined(__unix__) || defined(__APPLE__)
+    return this->file != -1;
+#else
+    return this->file != nullptr;
+#endif
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+CaptureWriter::Write(CaptureRecord record, const void* data, size_t dataLength)
+{
+    size_t const padded = Padded(dataLength);
+    if (!this->IsOpen() || !this->Reserve(sizeof(record) + padded))
+        return;
+
+    record.length = (uint32_t)dataLength;
+    std::memset(record.reserved, 0, sizeof(record.reserved));
+    this->Append(&record, sizeof(record));
+    if (dataLength > 0)
+        this->Append(data, dataLength);
+    if (padded > dataLength)
+    {
+        uint8_t const zeros[8] = {};
+        this->Append(zeros, padded - dataLength);
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    The mapping is replaced by a bigger one rather than extended in place,
+    which not every platform can do. That copies nothing, the pages belong to
+    the file.
+*/
+bool
+CaptureWriter::Reserve(size_t bytes)
+{
+#if defined(__unix__) || defined(__APPLE__)
+    if (this->size + bytes <= this->capacity)
+        return true;
+
+    size_t capacity = this->capacity;
+    while (capacity < this->size + bytes)
+        capacity += ChunkSize;
+
+    if (this->mapping != nullptr)
+        munmap(this->mapping, this->capacity);
+    this->mapping = nullptr;
+    if (ftruncate(this->file, (off_t)capacity) == 0)
+    {
+        void* mapping = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, this->file, 0);
+        if (mapping != MAP_FAILED)
+        {
+            this->mapping = (uint8_t*)mapping;
+            this->capacity = capacity;
+            return true;
+        }
+    }
+
+    fprintf(stderr, "Could not grow the capture file, stopped capturing.\n");
+    this->capacity = 0;
+    this->Close();
+    return false;
+#else
+    (void)bytes;
+    return true;
+#endif
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+CaptureWriter::Append(const void* data, size_t bytes)
+{
+#if defined(__unix__) || defined(__APPLE__)
+    std::memcpy(this->mapping + this->size, data, bytes);
+#else
+    fwrite(data, 1, bytes, this->file);
+#endif
+    this->size += bytes;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+CaptureReader::CaptureReader()
+{
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+CaptureReader::~CaptureReader()
+{
+    this->Close();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+CaptureReader::Open(const char* path)
+{
+    this->Close();
+#if defined(__unix__) || defined(__APPLE__)
+    int const file = open(path, O_RDONLY);
+    if (file == -1)
+        return false;
+    struct stat status;
+    if (fstat(file, &status) == 0 && status.st_size > 0)
+    {
+        void* mapping = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        if (mapping != MAP_FAILED)
+        {
+            this->mapping = mapping;
+            this->data = (const uint8_t*)mapping;
+            this->size = (size_t)status.st_size;
+        }
+    }
+    close(file);
+#else
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr)
+        return false;
+    fseek(file, 0, SEEK_END);
+    long const length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (length > 0)
+    {
+        this->contents.resize((size_t)length);
+        this->contents.resize(fread(this->contents.data(), 1, this->contents.size(), file));
+    }
+    fclose(file);
+    this->data = this->contents.data();
+    this->size = this->contents.size();
+#endif
+
+    if (this->size < sizeof(CaptureHeader))
+    {
+        this->Close();
+        return false;
+    }
+    std::memcpy(&this->header, this->data, sizeof(this->header));
+    if (this->header.magic != CaptureHeader::Magic || this->header.version != CaptureHeader::CurrentVersion ||
+        this->header.tickRate == 0 || this->header.tickRate > CaptureHeader::MaxTickRate)
+    {
+        this->Close();
+        return false;
+    }
+    this->Rewind();
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+CaptureReader::Close()
+{
+#if defined(__unix__) || defined(__APPLE__)
+    if (this->mapping != nullptr)
+        munmap(this->mapping, this->size);
+    this->mapping = nullptr;
+#else
+    this->contents.clear();
+#endif
+    this->data = nullptr;
+    this->size = 0;
+    this->position = 0;
+    this->header = CaptureHeader();
+}
+
+//------------------------------------------------------------------------------
+/**
+    A record cut off by the end of the file ends the log like a zero one.
+*/
+bool
+CaptureReader::Next(CaptureRecord& record, const uint8_t*& data)
+{
+    if (this->position + sizeof(CaptureRecord) > this->size)
+        return false;
+    std::memcpy(&record, this->data + this->position, sizeof(record));
+    if (record.kind == CaptureRecord::End || record.kind > CaptureRecord::Disconnect)
+        return false;
+
+    size_t const payload = this->position + sizeof(CaptureRecord);
+    if (payload + record.length > this->size)
+        return false;
+    data = this->data + payload;
+    this->position = payload + Padded(record.length);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+CaptureReader::Rewind()
+{
+    this->position = sizeof(CaptureHeader);
+}
+
+} // namespace Net
@@ -0,0 +1,148 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @file capture.h
+
+    @class Net::CaptureWriter
+    @class Net::CaptureReader
+
+    Append-only log of what a server received: the connects, packets and
+    disconnects of its peers and the start of every tick, in the order the
+    server handled them. Feeding the records back in that order replays the
+    session without sockets.
+
+    A log is a CaptureHeader followed by records, each a CaptureRecord and
+    its payload padded to 8 bytes. The writer maps the file and grows it in
+    chunks, so a record is a copy into memory. A server that dies leaves the
+    records written so far, followed by zeros the reader takes as the end.
+    Logs are in the byte order of the machine that wrote them.
+
+    @copyright
+    (C) 2024 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+namespace Net
+{
+
+struct CaptureHeader
+{
+    static constexpr uint32_t Magic = 0x50414353; // "SCAP"
+    static constexpr uint32_t CurrentVersion = 1;
+    /// highest tick rate a reader accepts, anything above is a corrupt header
+    static constexpr uint32_t MaxTickRate = 1000;
+
+    uint32_t magic = Magic;
+    uint32_t version = CurrentVersion;
+    /// server ticks per second during the session
+    uint32_t tickRate = 0;
+    uint32_t reserved = 0;
+};
+
+struct CaptureRecord
+{
+    enum Kind : uint8_t
+    {
+        /// zero, where the records of an unfinished log end
+        End,
+        /// a tick starts, time is the server time of the tick
+        Tick,
+        Connect,
+        /// payload is the packet's data
+        Receive,
+        Disconnect
+    };
+
+    /// server tick when the record was written, the tick that starts for Tick
+    uint64_t tick;
+    /// server time in ms
+    uint64_t time;
+    /// ENet's incomingPeerID of the peer
+    uint32_t peer;
+    /// payload bytes
+    uint32_t length;
+    /// the peer's round trip in ms and packet loss scaled by ENET_PEER_PACKET_LOSS_SCALE
+    uint32_t roundTripTime;
+    uint32_t packetLoss;
+    Kind kind;
+    uint8_t channel;
+    uint8_t reserved[6];
+};
+
+class CaptureWriter
+{
+public:
+    /// bytes the file grows by when the mapping is full
+    static constexpr size_t ChunkSize = 16 << 20;
+
+    /// constructor
+    CaptureWriter();
+    /// destructor, closes
+    ~CaptureWriter();
+    CaptureWriter(const CaptureWriter&) = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+    /// create or truncate the file at path and write the header
+    bool Open(const char* path, uint32_t tickRate);
+    /// cut the file to the records written and close it
+    void Close();
+    /// true between a successful Open and Close
+    bool IsOpen() const;
+
+    /// append a record, its length is set from dataLength
+    void Write(CaptureRecord record, const void* data, size_t dataLength);
+    /// bytes written including the header
+    size_t Size() const { return this->size; }
+
+private:
+    /// make room for bytes more, false and closed if the file can't grow
+    bool Reserve(size_t bytes);
+    void Append(const void* data, size_t bytes);
+
+#if defined(__unix__) || defined(__APPLE__)
+    int file = -1;
+    uint8_t* mapping = nullptr;
+    size_t capacity = 0;
+#else
+    FILE* file = nullptr;
+#endif
+    size_t size = 0;
+};
+
+class CaptureReader
+{
+public:
+    /// constructor
+    CaptureReader();
+    /// destructor, closes
+    ~CaptureReader();
+    CaptureReader(const CaptureReader&) = delete;
+    CaptureReader& operator=(const CaptureReader&) = delete;
+
+    /// map the log at path, false if it is missing, not a log of this version or its header is corrupt
+    bool Open(const char* path);
+    void Close();
+
+    /// header of the open log
+    const CaptureHeader& Header() const { return this->header; }
+    /// the next record and its payload, which stays valid until Close, false at the end
+    bool Next(CaptureRecord& record, const uint8_t*& data);
+    /// back to the first record
+    void Rewind();
+
+private:
+    CaptureHeader header;
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    size_t position = 0;
+#if defined(__unix__) || defined(__APPLE__)
+    void* mapping = nullptr;
+#else
+    std::vector<uint8_t> contents;
+#endif
+};
+
+} // namespace Net
@@ -0,0 +1,40 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @file channels.h
+
+    ENet channels of the game protocol. ENet orders reliable packets within a
+    channel and holds back everything behind one that is being resent, so
+    traffic that must not wait for each other goes on separate channels:
+
+    Events carries spawns and despawns, batched into one reliable message per
+    peer and tick, a lost despawn would leave the entity behind forever.
+    State carries snapshots, inputs and clock syncs, unreliable and sequenced,
+    only the newest matters and a late one is dropped by ENet.
+    Bulk carries the join data, connect and full game state, reliable and
+    large enough to be fragmented, without delaying the other two.
+
+    Client and server have to create their hosts with ChannelCount channels,
+    ENet connects with the smaller of both counts.
+
+    @copyright
+    (C) 2024 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include <stdint.h>
+
+namespace Net
+{
+
+enum class Channel : uint8_t
+{
+    Events,
+    State,
+    Bulk,
+    Count
+};
+
+/// channels to create hosts and connect with
+static constexpr size_t ChannelCount = (size_t)Channel::Count;
+
+} // namespace Net
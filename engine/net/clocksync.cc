@@ -0,0 +1,119 @@
+//------------------------------------------------------------------------------
+//  clocksync.cc
+//  @copyright (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "config.h"
+#include "clocksync.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace Net
+{
+
+//------------------------------------------------------------------------------
+/**
+*/
+uint64_t
+LocalTime()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//------------------------------------------------------------------------------
+/**
+    Requests go out quickly until the window is full, so a new connection has
+    a good estimate within a second.
+*/
+bool
+ClockSync::RequestDue(uint64_t localTime)
+{
+    uint64_t const interval = (this->sampleCount < WindowSize) ? FastInterval : Interval;
+    if (this->lastRequest != 0 && localTime - this->lastRequest < interval)
+        return false;
+    this->lastRequest = localTime;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+ClockSync::Seed(uint64_t serverTime, uint64_t localTime)
+{
+    if (this->Synchronized())
+        return;
+    this->targetOffset = (int64_t)serverTime - (int64_t)localTime;
+    this->offset = (double)this->targetOffset;
+    this->lastServerTime = 0;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+ClockSync::AddSample(uint64_t clientSend, uint64_t serverTime, uint64_t clientReceive)
+{
+    if (clientReceive < clientSend)
+        return;
+
+    Sample& sample = this->samples[this->sampleCount % WindowSize];
+    sample.roundTripTime = (uint32_t)(clientReceive - clientSend);
+    sample.offset = (int64_t)serverTime - (int64_t)(clientSend + sample.roundTripTime / 2);
+    this->sampleCount++;
+
+    // Newest first, so of equally fast samples the most recent wins
+    uint32_t const count = std::min(this->sampleCount, WindowSize);
+    const Sample* best = &sample;
+    for (uint32_t i = 1; i < count; i++)
+    {
+        const Sample& other = this->samples[(this->sampleCount - 1 - i) % WindowSize];
+        if (other.roundTripTime < best->roundTripTime)
+            best = &other;
+    }
+    this->targetOffset = best->offset;
+    this->roundTripTime = best->roundTripTime;
+
+    // A step may go backwards, so it is the one case that is not kept monotonic
+    if (this->sampleCount == 1 || std::abs(this->targetOffset - (int64_t)this->offset) > StepThreshold)
+    {
+        this->offset = (double)this->targetOffset;
+        this->lastServerTime = 0;
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    The slew rate is well below one, so the result keeps advancing while the
+    offset shrinks.
+*/
+uint64_t
+ClockSync::ServerTime(uint64_t localTime)
+{
+    if (localTime > this->lastLocalTime)
+    {
+        if (this->lastLocalTime != 0)
+        {
+            double const maxSlew = (double)(localTime - this->lastLocalTime) * SlewRate / 1000.0;
+            double const error = (double)this->targetOffset - this->offset;
+            this->offset += std::clamp(error, -maxSlew, maxSlew);
+        }
+        this->lastLocalTime = localTime;
+    }
+
+    int64_t const time = (int64_t)localTime + (int64_t)std::llround(this->offset);
+    if (time > (int64_t)this->lastServerTime)
+        this->lastServerTime = (uint64_t)time;
+    return this->lastServerTime;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+ClockSync::Reset()
+{
+    *this = ClockSync();
+}
+
+} // namespace Net
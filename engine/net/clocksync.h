@@ -0,0 +1,81 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @file clocksync.h
+
+    @class Net::ClockSync
+
+    Estimates the server clock on the client from NTP style request/reply
+    pairs. The client stamps a request with its local time t0, the server
+    replies with its own time t1 and the client stamps the reply's arrival
+    with t3. Assuming both legs take equally long the server's clock was
+    t1 - (t0 + t3) / 2 ahead.
+
+    Queueing only ever adds delay, so of the last WindowSize samples the one
+    with the shortest round trip is trusted. The reported server time slews
+    towards a new estimate instead of jumping and never decreases. Only the
+    first sample and errors above StepThreshold are corrected at once.
+
+    Both sides measure time with LocalTime, the server's is the server time.
+
+    @copyright
+    (C) 2024 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+
+namespace Net
+{
+
+/// monotonic clock of this process in ms
+uint64_t LocalTime();
+
+class ClockSync
+{
+public:
+    /// samples the estimate is filtered over
+    static constexpr uint32_t WindowSize = 8;
+    /// ms between requests until the window is full
+    static constexpr uint64_t FastInterval = 100;
+    /// ms between requests afterwards
+    static constexpr uint64_t Interval = 1000;
+    /// errors in ms above which the estimate steps instead of slewing
+    static constexpr int64_t StepThreshold = 250;
+    /// ms of correction per second of local time while slewing
+    static constexpr double SlewRate = 20.0;
+
+    /// true if a request should be sent at localTime, the request counts as sent
+    bool RequestDue(uint64_t localTime);
+    /// start from a one way server timestamp, replaced by the first sample
+    void Seed(uint64_t serverTime, uint64_t localTime);
+    /// add the reply to a request sent at clientSend, stamped with serverTime by the server and received at clientReceive
+    void AddSample(uint64_t clientSend, uint64_t serverTime, uint64_t clientReceive);
+    /// estimated server time at localTime, never less than a previous result unless the estimate stepped
+    uint64_t ServerTime(uint64_t localTime);
+    /// true once a reply was received
+    bool Synchronized() const { return this->sampleCount > 0; }
+    /// ms the server clock is ahead of the local one, slewed
+    int64_t Offset() const { return (int64_t)this->offset; }
+    /// round trip of the sample the estimate is based on
+    uint32_t RoundTripTime() const { return this->roundTripTime; }
+    /// forget all samples, for a new connection
+    void Reset();
+
+private:
+    struct Sample
+    {
+        int64_t offset;
+        uint32_t roundTripTime;
+    };
+
+    Sample samples[WindowSize] = {};
+    uint32_t sampleCount = 0;
+    uint64_t lastRequest = 0;
+    /// estimate of the best sample and the slewed offset that follows it
+    int64_t targetOffset = 0;
+    double offset = 0.0;
+    uint32_t roundTripTime = 0;
+    uint64_t lastLocalTime = 0;
+    uint64_t lastServerTime = 0;
+};
+
+} // namespace Net
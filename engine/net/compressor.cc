@@ -0,0 +1,368 @@
+//------------------------------------------------------------------------------
+//  compressor.cc
+//  @copyright (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "config.h"
+#include "compressor.h"
+#include "compressorprior.h"
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+namespace Net
+{
+
+static constexpr uint32_t FrequencyTotal = 1u << PacketCompressor::FrequencyBits;
+/// rANS state stays in [StateLow, StateLow << 8) between bytes
+static constexpr uint32_t StateLow = 1u << 23;
+
+//------------------------------------------------------------------------------
+/**
+    Byte position within its 4 byte word and whether the previous byte is
+    zero, a small positive or negative number, or anything else.
+*/
+static inline uint32_t
+ContextOf(size_t position, uint8_t previous)
+{
+    uint32_t const previousClass = previous == 0 ? 0 : previous < 0x10 ? 1 : previous >= 0xF0 ? 2 : 3;
+    return (uint32_t)(position & 3) * 4 + previousClass;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+PacketCompressor::PacketCompressor()
+{
+    static Tables const* const prior = [] {
+        Tables* tables = new Tables;
+        Prepare(Prior(), *tables);
+        return tables;
+    }();
+    this->tables = prior;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+PacketCompressor::~PacketCompressor()
+{
+    if (this->rangeCoder != nullptr)
+        enet_range_coder_destroy(this->rangeCoder);
+}
+
+//------------------------------------------------------------------------------
+/**
+    An untrained prior is all zeros and codes every byte in 8 bits.
+*/
+const PacketCompressor::Model&
+PacketCompressor::Prior()
+{
+    static Model const prior = [] {
+        Model model;
+        for (uint32_t context = 0; context < ContextCount; context++)
+        {
+            for (uint32_t byte = 0; byte < 256; byte++)
+                model.frequencies[context][byte] = CompressorPrior[context][byte] != 0 ? CompressorPrior[context][byte] : (uint16_t)(FrequencyTotal / 256);
+        }
+        return model;
+    }();
+    return prior;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+PacketCompressor::SetModel(const Model& model)
+{
+    this->ownTables = std::make_unique<Tables>();
+    Prepare(model, *this->ownTables);
+    this->tables = this->ownTables.get();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+PacketCompressor::Prepare(const Model& model, Tables& tables)
+{
+    for (uint32_t context = 0; context < ContextCount; context++)
+    {
+        uint32_t start = 0;
+        for (uint32_t byte = 0; byte < 256; byte++)
+        {
+            uint16_t const frequency = model.frequencies[context][byte];
+            tables.frequencies[context][byte] = frequency;
+            tables.starts[context][byte] = (uint16_t)start;
+            std::memset(&tables.bytes[context][start], (int)byte, frequency);
+            start += frequency;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    The compressor belongs to the host from here on and is deleted with it.
+*/
+bool
+PacketCompressor::Attach(ENetHost* host, CompressionMethod method)
+{
+    PacketCompressor* compressor = new (std::nothrow) PacketCompressor();
+    if (compressor == nullptr)
+        return false;
+    compressor->method = method;
+
+    ENetCompressor callbacks;
+    callbacks.context = compressor;
+    callbacks.compress = &PacketCompressor::CompressCallback;
+    callbacks.decompress = &PacketCompressor::DecompressCallback;
+    callbacks.destroy = &PacketCompressor::DestroyCallback;
+    enet_host_compress(host, &callbacks);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+CompressionMethod
+PacketCompressor::MethodFromInt(int value)
+{
+    if (value <= 0 || value >= (int)CompressionMethod::Count)
+        return CompressionMethod::None;
+    return (CompressionMethod)value;
+}
+
+//------------------------------------------------------------------------------
+/**
+    A compressed datagram is the method, the uncompressed length as one or
+    two bytes of 7 bits each and the method's output.
+*/
+size_t
+PacketCompressor::Compress(CompressionMethod method, const ENetBuffer* in, size_t inCount, size_t inLimit, uint8_t* out, size_t outLimit)
+{
+    size_t const header = inLimit < 0x80 ? 2 : 3;
+    if (method == CompressionMethod::None || inLimit > sizeof(this->gathered) || outLimit <= header)
+        return 0;
+
+    out[0] = (uint8_t)method;
+    if (inLimit < 0x80)
+        out[1] = (uint8_t)inLimit;
+    else
+    {
+        out[1] = (uint8_t)(0x80 | (inLimit & 0x7F));
+        out[2] = (uint8_t)(inLimit >> 7);
+    }
+
+    size_t size = 0;
+    if (method == CompressionMethod::RangeCoder)
+    {
+        if (this->rangeCoder == nullptr)
+            this->rangeCoder = enet_range_coder_create();
+        if (this->rangeCoder != nullptr)
+            size = enet_range_coder_compress(this->rangeCoder, in, inCount, inLimit, out + header, outLimit - header);
+    }
+    else
+        size = this->CompressModel(in, inCount, inLimit, out + header, outLimit - header);
+    return size > 0 ? header + size : 0;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+size_t
+PacketCompressor::Decompress(const uint8_t* in, size_t inLimit, uint8_t* out, size_t outLimit)
+{
+    if (inLimit < 2)
+        return 0;
+    size_t length = in[1] & 0x7F;
+    size_t header = 2;
+    if (in[1] & 0x80)
+    {
+        if (inLimit < 3)
+            return 0;
+        length |= (size_t)in[2] << 7;
+        header = 3;
+    }
+    if (length > outLimit)
+        return 0;
+
+    switch ((CompressionMethod)in[0])
+    {
+    case CompressionMethod::RangeCoder:
+        if (this->rangeCoder == nullptr)
+            this->rangeCoder = enet_range_coder_create();
+        if (this->rangeCoder == nullptr)
+            return 0;
+        return enet_range_coder_decompress(this->rangeCoder, in + header, inLimit - header, out, length) == length ? length : 0;
+    case CompressionMethod::Model:
+        return this->DecompressModel(in + header, inLimit - header, out, length);
+    default:
+        return 0;
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    rANS decodes in the opposite order it encodes, so the bytes are encoded
+    from the last to the first and the output is written backwards from the
+    end of out, then moved to its start. The final state comes first.
+*/
+size_t
+PacketCompressor::CompressModel(const ENetBuffer* in, size_t inCount, size_t inLimit, uint8_t* out, size_t outLimit)
+{
+    size_t length = 0;
+    for (size_t i = 0; i < inCount && length < inLimit; i++)
+    {
+        size_t const bytes = in[i].dataLength < inLimit - length ? in[i].dataLength : inLimit - length;
+        std::memcpy(this->gathered + length, in[i].data, bytes);
+        length += bytes;
+    }
+
+    const Tables& tables = *this->tables;
+    uint8_t* const end = out + outLimit;
+    uint8_t* cursor = end;
+    uint32_t state = StateLow;
+    for (size_t position = length; position-- > 0;)
+    {
+        uint32_t const context = ContextOf(position, position > 0 ? this->gathered[position - 1] : 0);
+        uint8_t const byte = this->gathered[position];
+        uint32_t const frequency = tables.frequencies[context][byte];
+        uint32_t const limit = ((StateLow >> PacketCompressor::FrequencyBits) << 8) * frequency;
+        while (state >= limit)
+        {
+            if (cursor == out)
+                return 0;
+            *--cursor = (uint8_t)state;
+            state >>= 8;
+        }
+        state = ((state / frequency) << PacketCompressor::FrequencyBits) + (state % frequency) + tables.starts[context][byte];
+    }
+
+    if (cursor - out < 4)
+        return 0;
+    cursor -= 4;
+    cursor[0] = (uint8_t)state;
+    cursor[1] = (uint8_t)(state >> 8);
+    cursor[2] = (uint8_t)(state >> 16);
+    cursor[3] = (uint8_t)(state >> 24);
+
+    size_t const size = (size_t)(end - cursor);
+    std::memmove(out, cursor, size);
+    return size;
+}
+
+//------------------------------------------------------------------------------
+/**
+    The state ends where the encoder started, anything else, or running out
+    of input, means the datagram was damaged.
+*/
+size_t
+PacketCompressor::DecompressModel(const uint8_t* in, size_t inLimit, uint8_t* out, size_t length)
+{
+    if (inLimit < 4)
+        return 0;
+    uint32_t state = (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+    size_t next = 4;
+
+    const Tables& tables = *this->tables;
+    uint8_t previous = 0;
+    for (size_t position = 0; position < length; position++)
+    {
+        uint32_t const context = ContextOf(position, previous);
+        uint32_t const slot = state & (FrequencyTotal - 1);
+        uint8_t const byte = tables.bytes[context][slot];
+        state = tables.frequencies[context][byte] * (state >> PacketCompressor::FrequencyBits) + slot - tables.starts[context][byte];
+        while (state < StateLow)
+        {
+            if (next == inLimit)
+                return 0;
+            state = (state << 8) | in[next++];
+        }
+        out[position] = byte;
+        previous = byte;
+    }
+    return state == StateLow && next == inLimit ? length : 0;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+PacketCompressor::Count(const uint8_t* data, size_t size, uint32_t (&counts)[ContextCount][256])
+{
+    uint8_t previous = 0;
+    for (size_t position = 0; position < size; position++)
+    {
+        counts[ContextOf(position, previous)][data[position]]++;
+        previous = data[position];
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    Frequencies are scaled to the total and rounded, every byte gets at least
+    1 so bytes the training never saw can still be coded, and what that adds
+    is taken from the most frequent bytes.
+*/
+void
+PacketCompressor::Train(const uint32_t (&counts)[ContextCount][256], Model& model)
+{
+    for (uint32_t context = 0; context < ContextCount; context++)
+    {
+        uint64_t total = 0;
+        for (uint32_t byte = 0; byte < 256; byte++)
+            total += counts[context][byte];
+
+        int32_t sum = 0;
+        for (uint32_t byte = 0; byte < 256; byte++)
+        {
+            uint64_t const scaled = total > 0 ? (counts[context][byte] * (uint64_t)FrequencyTotal + total / 2) / total : FrequencyTotal / 256;
+            model.frequencies[context][byte] = (uint16_t)(scaled > 0 ? scaled : 1);
+            sum += model.frequencies[context][byte];
+        }
+
+        while (sum != (int32_t)FrequencyTotal)
+        {
+            uint32_t largest = 0;
+            for (uint32_t byte = 1; byte < 256; byte++)
+            {
+                if (model.frequencies[context][byte] > model.frequencies[context][largest])
+                    largest = byte;
+            }
+            int32_t const room = model.frequencies[context][largest] - 1;
+            int32_t const change = sum > (int32_t)FrequencyTotal ? -std::min(sum - (int32_t)FrequencyTotal, room) : (int32_t)FrequencyTotal - sum;
+            model.frequencies[context][largest] = (uint16_t)(model.frequencies[context][largest] + change);
+            sum += change;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+size_t ENET_CALLBACK
+PacketCompressor::CompressCallback(void* context, const ENetBuffer* inBuffers, size_t inBufferCount, size_t inLimit, enet_uint8* outData, size_t outLimit)
+{
+    PacketCompressor* compressor = (PacketCompressor*)context;
+    return compressor->Compress(compressor->method, inBuffers, inBufferCount, inLimit, outData, outLimit);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+size_t ENET_CALLBACK
+PacketCompressor::DecompressCallback(void* context, const enet_uint8* inData, size_t inLimit, enet_uint8* outData, size_t outLimit)
+{
+    return ((PacketCompressor*)context)->Decompress(inData, inLimit, outData, outLimit);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void ENET_CALLBACK
+PacketCompressor::DestroyCallback(void* context)
+{
+    delete (PacketCompressor*)context;
+}
+
+} // namespace Net
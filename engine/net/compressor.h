@@ -0,0 +1,116 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @file compressor.h
+
+    @class Net::PacketCompressor
+
+    ENetCompressor that compresses a host's datagrams with one of several
+    methods and decompresses all of them. The first byte of a compressed
+    datagram names its method, so hosts that compress differently still
+    understand each other, and a host that does not compress at all can
+    receive from one that does.
+
+    Model codes every byte with rANS, using byte frequencies trained on
+    recorded sessions of the game, see compressorprior.h. FlatBuffers align
+    their fields to four bytes and are full of zeros and small offsets, so
+    the frequencies are looked up by the byte's position within its word and
+    how far the previous byte is from zero. A datagram is too short to learn
+    much from, so the model does not adapt while coding, which keeps it to a
+    table lookup and a few multiplications per byte.
+
+    @copyright
+    (C) 2024 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include "enet/enet.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <memory>
+
+namespace Net
+{
+
+enum class CompressionMethod : uint8_t
+{
+    /// datagrams are sent as they are
+    None,
+    /// ENet's adaptive order-2 range coder
+    RangeCoder,
+    /// trained context model
+    Model,
+    Count
+};
+
+class PacketCompressor
+{
+public:
+    /// contexts of the model, four positions in a word times four classes of the previous byte
+    static constexpr uint32_t ContextCount = 16;
+    /// frequencies of a context add up to 1 << FrequencyBits
+    static constexpr uint32_t FrequencyBits = 12;
+
+    /// byte frequencies per context
+    struct Model
+    {
+        uint16_t frequencies[ContextCount][256];
+    };
+
+    /// constructor
+    PacketCompressor();
+    /// destructor
+    ~PacketCompressor();
+    PacketCompressor(const PacketCompressor&) = delete;
+    PacketCompressor& operator=(const PacketCompressor&) = delete;
+
+    /// compress the host's datagrams with method and decompress any the peers send, false if out of memory
+    static bool Attach(ENetHost* host, CompressionMethod method);
+    /// method from a CVar value, out of range ones are None
+    static CompressionMethod MethodFromInt(int value);
+
+    /// compress in with method to out, returns the bytes written or 0 if out is too small
+    size_t Compress(CompressionMethod method, const ENetBuffer* in, size_t inCount, size_t inLimit, uint8_t* out, size_t outLimit);
+    /// decompress a datagram compressed with any method, returns the bytes written or 0 if it is corrupt
+    size_t Decompress(const uint8_t* in, size_t inLimit, uint8_t* out, size_t outLimit);
+
+    /// the trained model in compressorprior.h
+    static const Model& Prior();
+    /// code with model instead of the trained one, hosts only understand each other with the same
+    void SetModel(const Model& model);
+    /// add the bytes of data to counts, for training a model
+    static void Count(const uint8_t* data, size_t size, uint32_t (&counts)[ContextCount][256]);
+    /// model from counts, every byte keeps a frequency of at least 1
+    static void Train(const uint32_t (&counts)[ContextCount][256], Model& model);
+
+    /// what Attach compresses with
+    CompressionMethod method = CompressionMethod::None;
+
+private:
+    /// a Model prepared for coding
+    struct Tables
+    {
+        uint16_t frequencies[ContextCount][256];
+        /// sum of the frequencies of the bytes below
+        uint16_t starts[ContextCount][256];
+        /// byte of every slot of the frequency range
+        uint8_t bytes[ContextCount][1 << FrequencyBits];
+    };
+
+    static size_t ENET_CALLBACK CompressCallback(void* context, const ENetBuffer* inBuffers, size_t inBufferCount, size_t inLimit, enet_uint8* outData, size_t outLimit);
+    static size_t ENET_CALLBACK DecompressCallback(void* context, const enet_uint8* inData, size_t inLimit, enet_uint8* outData, size_t outLimit);
+    static void ENET_CALLBACK DestroyCallback(void* context);
+
+    static void Prepare(const Model& model, Tables& tables);
+    size_t CompressModel(const ENetBuffer* in, size_t inCount, size_t inLimit, uint8_t* out, size_t outLimit);
+    size_t DecompressModel(const uint8_t* in, size_t inLimit, uint8_t* out, size_t length);
+
+    /// ENet's, created on first use
+    void* rangeCoder = nullptr;
+    /// the trained model's, shared by all compressors, or ownTables
+    const Tables* tables = nullptr;
+    std::unique_ptr<Tables> ownTables;
+    /// datagram being compressed, rANS codes it from the end
+    uint8_t gathered[ENET_PROTOCOL_MAXIMUM_MTU];
+};
+
+} // namespace Net
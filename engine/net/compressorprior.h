@@ -0,0 +1,311 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @file compressorprior.h
+
+    Byte frequencies of Net::PacketCompressor's model. Generated by the
+    server_bench with -sv_bench_compression <capture>
+    -sv_bench_compression_prior <file>, regenerate it when the protocol
+    changes. Trained on 32591 messages of a 20 second session of 24 bots.
+
+    @copyright
+    (C) 2024 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include <stdint.h>
+
+namespace Net
+{
+
+static const uint16_t CompressorPrior[16][256] = {
+    {
+        1318, 7, 4, 34, 5, 9, 26, 192, 570, 8, 26, 3, 273, 3, 32, 102,
+        89, 7, 6, 22, 221, 2, 2, 2, 3, 7, 31, 3, 2, 86, 20, 4,
+        29, 6, 3, 2, 226, 3, 2, 3, 30, 2, 3, 2, 3, 3, 2, 2,
+        2, 3, 2, 3, 3, 3, 4, 3, 2, 4, 3, 4, 2, 2, 2, 3,
+        4, 7, 3, 1, 2, 4, 2, 2, 2, 2, 3, 3, 2, 2, 2, 3,
+        2, 2, 2, 3, 4, 3, 2, 3, 2, 3, 2, 2, 2, 3, 3, 3,
+        2, 2, 2, 3, 3, 2, 2, 2, 3, 3, 2, 2, 2, 4, 2, 2,
+        2, 2, 3, 3, 2, 3, 2, 2, 3, 2, 2, 2, 3, 3, 3, 3,
+        4, 5, 4, 4, 2, 3, 3, 9, 8, 22, 35, 31, 11, 2, 2, 2,
+        3, 4, 2, 3, 2, 3, 3, 2, 2, 2, 3, 4, 2, 3, 2, 3,
+        3, 4, 2, 2, 2, 3, 2, 3, 2, 3, 3, 2, 3, 2, 3, 3,
+        3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 2, 3, 3, 3, 3, 2,
+        2, 5, 3, 4, 2, 2, 2, 3, 3, 2, 3, 2, 3, 3, 2, 2,
+        3, 4, 3, 2, 2, 3, 3, 3, 2, 2, 2, 3, 3, 2, 2, 3,
+        3, 3, 2, 2, 3, 3, 3, 2, 2, 3, 3, 4, 2, 2, 3, 3,
+        3, 2, 2, 3, 3, 3, 2, 2, 3, 3, 3, 2, 2, 3, 3, 3,
+    },
+    {
+        7, 6, 7, 11, 7, 10, 6, 12, 10, 6, 5, 10, 115, 6, 9, 76,
+        99, 8, 15, 8, 119, 15, 11, 7, 448, 9, 6, 8, 7, 8, 8, 13,
+        14, 20, 8, 7, 9, 13, 12, 9, 12, 13, 11, 14, 24, 16, 20, 18,
+        32, 27, 24, 25, 36, 34, 30, 28, 56, 30, 20, 17, 11, 10, 8, 7,
+        5, 10, 7, 6, 32, 6, 9, 6, 74, 7, 8, 5, 351, 7, 6, 6,
+        5, 7, 6, 5, 6, 8, 13, 8, 5, 6, 7, 15, 6, 6, 6, 7,
+        6, 10, 5, 7, 6, 8, 5, 5, 9, 6, 6, 7, 6, 10, 7, 9,
+        5, 6, 8, 6, 6, 7, 10, 6, 6, 16, 7, 7, 7, 18, 63, 68,
+        84, 65, 45, 30, 6, 5, 6, 8, 5, 8, 9, 6, 6, 8, 5, 6,
+        6, 8, 7, 7, 5, 11, 8, 6, 7, 6, 8, 8, 8, 6, 6, 7,
+        9, 9, 8, 8, 9, 11, 10, 9, 13, 13, 13, 13, 19, 17, 17, 18,
+        24, 24, 21, 21, 35, 31, 29, 22, 41, 32, 34, 14, 14, 13, 7, 4,
+        5, 8, 6, 5, 6, 5, 9, 5, 5, 7, 8, 6, 7, 6, 6, 6,
+        5, 7, 6, 7, 5, 6, 7, 6, 5, 8, 7, 6, 6, 5, 7, 6,
+        6, 6, 6, 5, 5, 6, 6, 5, 5, 10, 8, 8, 6, 6, 7, 5,
+        5, 5, 6, 6, 5, 6, 7, 6, 6, 6, 7, 7, 5, 5, 6, 5,
+    },
+    {
+        12, 4, 4, 3, 8, 10, 6, 4, 17, 7, 5, 10, 6, 6, 11, 4,
+        90, 5, 6, 10, 6, 8, 13, 6, 7, 12, 7, 7, 7, 7, 10, 8,
+        21, 12, 10, 14, 19, 25, 20, 16, 27, 23, 22, 23, 40, 29, 38, 31,
+        55, 55, 48, 42, 72, 74, 65, 70, 82, 43, 30, 12, 14, 12, 7, 4,
+        4, 12, 6, 5, 4, 4, 20, 4, 8, 18, 4, 3, 11, 7, 9, 4,
+        7, 7, 11, 2, 6, 5, 6, 8, 7, 5, 8, 7, 9, 10, 8, 3,
+        2, 7, 6, 6, 8, 8, 8, 5, 10, 5, 4, 5, 6, 12, 6, 2,
+        6, 6, 4, 5, 5, 5, 13, 5, 6, 7, 4, 17, 26, 114, 189, 118,
+        93, 127, 56, 10, 7, 6, 5, 6, 11, 4, 15, 4, 6, 6, 7, 3,
+        4, 4, 5, 5, 6, 11, 7, 5, 10, 7, 9, 6, 7, 9, 9, 10,
+        16, 10, 10, 7, 13, 15, 15, 14, 26, 25, 24, 27, 31, 32, 35, 30,
+        49, 55, 41, 40, 71, 58, 58, 45, 74, 51, 26, 15, 16, 14, 5, 2,
+        3, 4, 7, 4, 4, 6, 4, 4, 5, 17, 5, 3, 4, 21, 5, 3,
+        4, 5, 5, 26, 6, 6, 6, 3, 9, 7, 6, 3, 4, 10, 3, 2,
+        7, 5, 5, 5, 8, 9, 6, 5, 16, 6, 5, 5, 5, 7, 5, 3,
+        5, 8, 5, 2, 5, 3, 5, 3, 7, 6, 5, 6, 6, 22, 25, 4,
+    },
+    {
+        14, 45, 8, 10, 9, 14, 10, 10, 15, 10, 9, 15, 9, 10, 16, 9,
+        11, 10, 9, 12, 9, 10, 15, 10, 10, 14, 10, 10, 12, 13, 12, 12,
+        18, 14, 12, 13, 15, 22, 16, 16, 20, 19, 19, 18, 33, 27, 26, 26,
+        41, 43, 37, 33, 55, 51, 45, 45, 71, 45, 32, 17, 17, 14, 12, 9,
+        9, 13, 9, 8, 8, 9, 9, 8, 8, 9, 8, 9, 14, 10, 9, 9,
+        10, 10, 9, 10, 10, 9, 9, 13, 9, 11, 10, 9, 11, 10, 10, 10,
+        9, 9, 10, 8, 10, 10, 10, 9, 15, 10, 10, 9, 10, 15, 8, 8,
+        9, 9, 10, 9, 9, 9, 15, 9, 9, 10, 9, 9, 15, 59, 84, 128,
+        95, 98, 75, 28, 9, 9, 9, 10, 11, 11, 15, 9, 9, 10, 10, 10,
+        9, 9, 9, 9, 9, 15, 10, 9, 10, 10, 10, 10, 11, 10, 11, 10,
+        17, 12, 13, 12, 15, 16, 14, 14, 19, 20, 18, 21, 27, 27, 26, 23,
+        40, 38, 36, 31, 51, 46, 44, 37, 55, 46, 28, 17, 21, 12, 10, 7,
+        8, 9, 10, 8, 9, 9, 10, 9, 9, 9, 9, 8, 13, 10, 9, 8,
+        9, 8, 9, 9, 8, 9, 9, 9, 9, 9, 9, 8, 8, 9, 10, 7,
+        8, 9, 9, 8, 9, 9, 10, 8, 9, 9, 9, 8, 8, 9, 10, 8,
+        10, 8, 9, 8, 8, 8, 9, 9, 8, 9, 8, 8, 8, 8, 8, 8,
+    },
+    {
+        3486, 335, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+        1, 1, 1, 2, 1, 1, 1, 1, 2, 2, 1, 1, 1, 1, 1, 1,
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 3, 3,
+        3, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+        1, 1, 1, 1, 1, 1, 2, 1, 2, 1, 1, 1, 1, 1, 1, 1,
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 7, 1, 1, 1, 1, 1, 1,
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    },
+    {
+        2621, 27, 18, 17, 6, 24, 3, 3, 28, 3, 2, 14, 2, 3, 14, 3,
+        3, 2, 4, 14, 3, 7, 12, 3, 3, 17, 2, 3, 3, 4, 3, 3,
+        16, 5, 3, 4, 4, 24, 4, 3, 5, 5, 4, 5, 13, 7, 8, 8,
+        10, 21, 9, 8, 11, 12, 11, 10, 29, 10, 8, 6, 4, 4, 3, 3,
+        1, 24, 3, 2, 2, 2, 4, 3, 3, 3, 3, 2, 19, 3, 2, 4,
+        2, 3, 2, 2, 3, 3, 5, 16, 3, 2, 3, 6, 2, 3, 2, 3,
+        2, 14, 2, 3, 3, 3, 2, 3, 9, 3, 2, 2, 2, 6, 3, 3,
+        2, 3, 3, 3, 2, 3, 12, 3, 3, 6, 3, 3, 4, 15, 32, 26,
+        36, 41, 23, 15, 3, 2, 3, 3, 1, 2, 15, 2, 2, 3, 2, 3,
+        3, 4, 2, 3, 2, 15, 3, 2, 3, 3, 4, 3, 3, 2, 3, 3,
+        15, 4, 3, 4, 4, 5, 5, 4, 4, 4, 4, 9, 8, 8, 7, 7,
+        9, 10, 8, 8, 13, 10, 10, 8, 14, 11, 12, 6, 5, 5, 3, 2,
+        2, 2, 2, 2, 3, 2, 4, 2, 2, 3, 4, 3, 3, 2, 3, 2,
+        2, 3, 3, 3, 3, 2, 2, 2, 2, 3, 3, 3, 3, 2, 4, 3,
+        2, 2, 3, 2, 2, 3, 3, 3, 2, 4, 3, 4, 3, 3, 4, 3,
+        2, 3, 3, 2, 3, 4, 3, 3, 3, 4, 3, 3, 3, 3, 3, 2,
+    },
+    {
+        109, 79, 99, 62, 13, 18, 12, 7, 19, 11, 5, 14, 5, 8, 14, 7,
+        5, 6, 9, 12, 7, 9, 16, 7, 10, 14, 9, 7, 10, 8, 10, 10,
+        24, 10, 11, 14, 17, 24, 16, 14, 19, 17, 16, 18, 33, 21, 27, 25,
+        40, 43, 36, 28, 47, 48, 47, 45, 61, 37, 20, 10, 9, 10, 6, 5,
+        5, 9, 5, 7, 6, 6, 18, 5, 5, 11, 5, 4, 11, 9, 8, 4,
+        8, 10, 10, 4, 6, 7, 7, 12, 6, 4, 8, 7, 8, 9, 6, 3,
+        3, 8, 7, 5, 7, 7, 7, 6, 9, 5, 4, 3, 5, 12, 6, 3,
+        6, 6, 7, 8, 8, 5, 13, 5, 6, 7, 6, 26, 25, 143, 146, 117,
+        99, 158, 62, 14, 8, 7, 5, 6, 9, 6, 15, 5, 8, 7, 7, 7,
+        6, 5, 7, 6, 6, 12, 10, 6, 9, 10, 9, 6, 8, 9, 10, 13,
+        17, 11, 13, 8, 15, 16, 11, 13, 16, 22, 21, 23, 25, 24, 28, 24,
+        37, 48, 28, 27, 45, 39, 39, 32, 54, 44, 22, 12, 10, 13, 7, 3,
+        4, 4, 9, 5, 4, 6, 5, 5, 3, 15, 4, 5, 5, 42, 4, 3,
+        5, 5, 5, 24, 5, 8, 7, 6, 8, 8, 9, 6, 7, 9, 5, 2,
+        8, 6, 7, 8, 8, 8, 6, 7, 13, 8, 6, 9, 6, 8, 8, 6,
+        10, 8, 6, 4, 9, 5, 6, 4, 9, 11, 8, 10, 8, 26, 7, 6,
+    },
+    {
+        436, 104, 44, 43, 12, 18, 11, 13, 17, 12, 11, 19, 10, 11, 17, 9,
+        10, 12, 10, 16, 9, 11, 17, 11, 10, 16, 10, 11, 12, 12, 12, 12,
+        19, 12, 11, 12, 14, 20, 14, 19, 15, 15, 14, 14, 26, 19, 18, 19,
+        26, 31, 23, 21, 32, 30, 30, 30, 41, 29, 22, 13, 12, 11, 10, 9,
+        9, 15, 9, 9, 9, 9, 10, 9, 9, 9, 9, 9, 16, 10, 9, 9,
+        10, 10, 9, 10, 10, 9, 10, 15, 9, 10, 9, 9, 10, 9, 9, 9,
+        9, 9, 10, 10, 10, 10, 10, 9, 16, 10, 10, 9, 11, 13, 9, 8,
+        9, 9, 10, 9, 9, 11, 15, 9, 9, 10, 9, 9, 14, 48, 58, 78,
+        73, 86, 57, 26, 9, 10, 10, 11, 10, 10, 13, 9, 9, 9, 10, 10,
+        9, 9, 9, 11, 10, 14, 10, 10, 11, 10, 10, 9, 10, 11, 12, 10,
+        16, 12, 12, 10, 13, 14, 13, 12, 15, 15, 14, 18, 20, 19, 18, 17,
+        25, 25, 24, 21, 31, 27, 27, 24, 33, 29, 21, 13, 16, 11, 9, 8,
+        8, 9, 10, 8, 9, 9, 9, 9, 10, 9, 9, 9, 9, 8, 8, 9,
+        10, 8, 8, 9, 8, 9, 9, 9, 10, 9, 9, 9, 9, 9, 9, 8,
+        8, 10, 9, 9, 9, 9, 10, 9, 9, 9, 9, 10, 9, 9, 10, 9,
+        11, 9, 9, 11, 9, 9, 10, 10, 9, 10, 10, 9, 9, 9, 9, 9,
+    },
+    {
+        2531, 5, 1, 5, 89, 6, 27, 123, 212, 5, 26, 1, 159, 1, 115, 1,
+        125, 4, 1, 1, 127, 1, 1, 1, 1, 1, 1, 1, 154, 1, 1, 1,
+        2, 4, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 27, 1, 1, 1,
+        97, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+        1, 6, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 3, 1,
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 2,
+        2, 3, 1, 2, 1, 1, 1, 1, 1, 2, 1, 1, 1, 1, 1, 1,
+        1, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+        1, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+        1, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    },
+    {
+        1524, 4, 6, 8, 5, 26, 4, 4, 25, 5, 4, 23, 4, 4, 23, 3,
+        4, 5, 8, 23, 3, 13, 24, 5, 4, 22, 4, 5, 4, 5, 6, 9,
+        25, 13, 6, 6, 6, 26, 9, 7, 9, 11, 9, 10, 33, 13, 16, 14,
+        22, 36, 19, 18, 28, 28, 25, 20, 58, 25, 15, 13, 9, 7, 6, 5,
+        3, 21, 5, 5, 5, 4, 7, 4, 4, 5, 5, 4, 21, 5, 4, 5,
+        3, 5, 4, 3, 4, 5, 9, 21, 3, 4, 5, 11, 3, 4, 122, 6,
+        4, 6, 4, 4, 4, 6, 3, 3, 21, 4, 4, 4, 4, 21, 5, 6,
+        4, 5, 5, 4, 4, 6, 20, 4, 5, 13, 5, 5, 5, 14, 57, 63,
+        69, 65, 38, 27, 4, 4, 4, 5, 3, 5, 18, 4, 4, 5, 4, 5,
+        5, 5, 5, 6, 4, 19, 5, 6, 4, 5, 6, 4, 5, 4, 5, 5,
+        19, 7, 5, 6, 7, 8, 8, 8, 10, 10, 8, 23, 15, 13, 14, 14,
+        19, 20, 17, 16, 29, 25, 22, 17, 35, 26, 24, 11, 11, 8, 5, 3,
+        3, 6, 4, 3, 4, 4, 6, 3, 3, 4, 6, 4, 4, 4, 5, 4,
+        3, 5, 4, 6, 4, 4, 4, 4, 3, 6, 5, 5, 4, 3, 5, 4,
+        5, 4, 4, 3, 3, 4, 4, 4, 4, 8, 5, 5, 3, 5, 5, 4,
+        4, 3, 4, 4, 4, 5, 4, 4, 3, 5, 5, 5, 4, 3, 5, 4,
+    },
+    {
+        33, 3, 4, 3, 8, 9, 5, 3, 12, 6, 4, 7, 6, 5, 8, 4,
+        5, 4, 7, 9, 5, 7, 12, 5, 6, 11, 7, 7, 8, 6, 8, 7,
+        17, 12, 10, 12, 16, 22, 18, 15, 25, 20, 19, 20, 36, 26, 36, 32,
+        48, 53, 43, 42, 63, 67, 61, 67, 72, 41, 29, 11, 12, 10, 7, 3,
+        4, 8, 5, 5, 4, 3, 16, 3, 7, 11, 5, 3, 9, 6, 8, 4,
+        5, 6, 12, 2, 4, 4, 5, 8, 6, 5, 7, 6, 7, 372, 7, 4,
+        2, 6, 6, 5, 8, 8, 6, 6, 11, 5, 4, 4, 5, 10, 6, 2,
+        5, 5, 3, 4, 4, 6, 11, 3, 6, 7, 4, 17, 25, 116, 183, 114,
+        78, 114, 57, 8, 5, 8, 4, 5, 9, 4, 13, 4, 7, 6, 6, 5,
+        4, 4, 7, 5, 5, 10, 8, 4, 9, 8, 9, 8, 5, 9, 8, 10,
+        15, 9, 9, 8, 15, 14, 13, 12, 23, 21, 22, 26, 30, 30, 31, 27,
+        46, 50, 40, 38, 67, 54, 55, 42, 70, 46, 25, 15, 14, 12, 6, 2,
+        3, 3, 8, 4, 4, 5, 4, 2, 4, 13, 5, 3, 3, 19, 4, 3,
+        4, 4, 4, 23, 5, 7, 6, 3, 8, 6, 7, 2, 4, 9, 2, 2,
+        6, 4, 5, 4, 7, 6, 5, 3, 12, 6, 6, 4, 4, 6, 4, 4,
+        5, 7, 4, 3, 4, 4, 4, 2, 6, 7, 5, 5, 6, 21, 41, 3,
+    },
+    {
+        33, 44, 8, 10, 9, 14, 9, 10, 13, 10, 9, 15, 9, 10, 15, 8,
+        8, 10, 9, 12, 9, 9, 14, 10, 10, 14, 10, 10, 12, 12, 12, 12,
+        18, 13, 12, 14, 15, 22, 16, 14, 20, 20, 18, 18, 32, 27, 26, 26,
+        40, 42, 37, 31, 52, 47, 45, 45, 68, 45, 30, 16, 16, 13, 12, 9,
+        10, 14, 9, 8, 8, 9, 9, 8, 8, 9, 9, 8, 14, 10, 9, 9,
+        10, 9, 8, 9, 10, 9, 9, 12, 9, 11, 10, 9, 11, 26, 27, 10,
+        9, 9, 10, 8, 10, 9, 10, 9, 15, 10, 10, 9, 10, 14, 9, 9,
+        9, 9, 10, 9, 9, 9, 15, 9, 9, 10, 9, 9, 16, 59, 86, 120,
+        91, 99, 73, 29, 9, 9, 9, 10, 10, 11, 15, 9, 9, 10, 10, 10,
+        9, 9, 9, 9, 9, 14, 10, 9, 10, 10, 11, 10, 11, 10, 12, 10,
+        17, 12, 13, 12, 15, 16, 14, 14, 19, 19, 18, 22, 27, 27, 26, 24,
+        39, 38, 36, 31, 49, 44, 43, 38, 56, 45, 29, 18, 21, 13, 10, 8,
+        8, 9, 9, 8, 8, 9, 9, 9, 9, 9, 9, 8, 11, 9, 9, 8,
+        9, 8, 9, 9, 8, 9, 9, 8, 9, 9, 9, 8, 8, 9, 9, 8,
+        8, 9, 9, 8, 8, 9, 10, 8, 8, 9, 9, 8, 8, 9, 10, 8,
+        10, 9, 9, 8, 8, 8, 9, 10, 8, 9, 8, 8, 8, 8, 8, 8,
+    },
+    {
+        3425, 191, 1, 1, 1, 1, 1, 1, 1, 32, 28, 1, 1, 152, 5, 12,
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 3, 1, 1, 1, 1, 1, 1,
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+        1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    },
+    {
+        2300, 19, 5, 4, 4, 6, 3, 8, 7, 4, 3, 7, 3, 3, 7, 70,
+        4, 3, 5, 6, 3, 9, 7, 4, 5, 7, 3, 5, 4, 5, 5, 4,
+        7, 6, 4, 4, 5, 10, 6, 6, 7, 8, 6, 7, 14, 11, 12, 12,
+        14, 16, 13, 13, 18, 16, 17, 15, 30, 15, 11, 10, 6, 6, 5, 6,
+        2, 7, 4, 3, 4, 3, 5, 4, 3, 4, 5, 3, 7, 3, 3, 5,
+        3, 5, 4, 3, 4, 4, 7, 8, 3, 3, 4, 10, 3, 4, 4, 4,
+        4, 20, 4, 4, 4, 5, 4, 4, 7, 4, 3, 3, 3, 7, 4, 5,
+        3, 4, 4, 4, 4, 5, 6, 4, 4, 9, 4, 4, 5, 22, 47, 36,
+        55, 59, 31, 23, 4, 3, 4, 4, 2, 3, 6, 3, 4, 4, 3, 4,
+        3, 5, 4, 4, 3, 8, 4, 4, 4, 4, 5, 5, 6, 4, 5, 5,
+        9, 5, 4, 5, 6, 6, 6, 6, 7, 6, 7, 10, 11, 9, 10, 11,
+        13, 13, 12, 11, 20, 16, 16, 12, 21, 18, 18, 8, 7, 7, 5, 5,
+        2, 4, 3, 3, 4, 3, 6, 2, 3, 3, 5, 4, 4, 3, 3, 3,
+        3, 4, 3, 4, 3, 3, 3, 4, 4, 4, 4, 4, 4, 3, 5, 4,
+        4, 4, 4, 3, 3, 3, 5, 4, 3, 5, 4, 5, 4, 4, 5, 3,
+        3, 4, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 3, 3, 4, 4,
+    },
+    {
+        34, 4, 21, 4, 8, 13, 10, 5, 18, 9, 4, 15, 6, 7, 12, 4,
+        36, 5, 7, 14, 6, 9, 19, 4, 7, 14, 8, 7, 8, 7, 8, 9,
+        21, 11, 10, 14, 20, 29, 16, 14, 20, 19, 19, 20, 36, 27, 32, 28,
+        42, 47, 36, 30, 55, 55, 56, 49, 69, 38, 22, 11, 11, 13, 11, 6,
+        7, 12, 5, 7, 6, 6, 19, 5, 4, 14, 5, 4, 10, 8, 10, 6,
+        8, 10, 11, 4, 7, 6, 8, 9, 5, 5, 10, 9, 7, 9, 8, 4,
+        4, 8, 7, 5, 9, 10, 8, 5, 11, 5, 4, 4, 6, 16, 10, 2,
+        8, 6, 6, 10, 9, 6, 15, 6, 6, 7, 6, 29, 24, 168, 156, 120,
+        115, 169, 60, 13, 8, 9, 5, 7, 9, 7, 15, 5, 9, 7, 9, 6,
+        6, 5, 8, 8, 8, 15, 10, 6, 11, 11, 9, 6, 8, 11, 10, 12,
+        22, 11, 12, 8, 15, 16, 12, 13, 20, 22, 23, 26, 22, 26, 27, 26,
+        41, 45, 38, 30, 51, 43, 45, 33, 61, 47, 24, 12, 11, 14, 9, 4,
+        5, 7, 10, 5, 3, 7, 6, 5, 4, 25, 4, 5, 6, 32, 5, 4,
+        4, 4, 5, 26, 6, 7, 7, 5, 8, 10, 9, 7, 7, 9, 3, 2,
+        8, 5, 10, 7, 9, 10, 5, 7, 14, 7, 6, 7, 6, 9, 6, 4,
+        7, 8, 8, 5, 8, 6, 8, 7, 10, 9, 9, 11, 7, 32, 6, 4,
+    },
+    {
+        289, 41, 9, 10, 9, 19, 10, 13, 19, 12, 11, 20, 10, 10, 19, 31,
+        10, 12, 10, 17, 10, 10, 19, 11, 10, 17, 10, 11, 12, 12, 12, 12,
+        20, 13, 12, 12, 14, 24, 15, 14, 16, 16, 16, 16, 27, 21, 20, 20,
+        28, 34, 26, 23, 36, 33, 32, 33, 46, 32, 24, 15, 14, 12, 12, 11,
+        10, 17, 10, 10, 9, 9, 10, 10, 10, 10, 10, 10, 18, 11, 10, 10,
+        10, 11, 10, 11, 11, 10, 10, 16, 10, 12, 10, 10, 10, 10, 10, 9,
+        10, 10, 10, 11, 11, 11, 11, 10, 17, 10, 10, 10, 12, 15, 10, 10,
+        10, 9, 11, 10, 10, 11, 17, 10, 10, 10, 10, 10, 15, 51, 63, 84,
+        78, 95, 62, 27, 10, 10, 10, 12, 11, 11, 15, 10, 10, 10, 10, 11,
+        10, 10, 10, 11, 11, 16, 11, 11, 11, 11, 11, 10, 11, 12, 13, 11,
+        19, 12, 12, 12, 14, 14, 13, 13, 16, 16, 16, 20, 22, 20, 19, 18,
+        27, 27, 26, 23, 34, 30, 29, 26, 36, 31, 23, 14, 17, 12, 11, 9,
+        9, 11, 10, 9, 9, 10, 10, 10, 11, 10, 10, 10, 10, 9, 9, 9,
+        10, 9, 9, 10, 9, 10, 10, 9, 11, 10, 10, 10, 9, 9, 10, 9,
+        9, 10, 10, 9, 9, 10, 11, 9, 9, 10, 9, 10, 9, 9, 10, 9,
+        11, 9, 9, 10, 9, 9, 10, 11, 10, 10, 10, 10, 9, 9, 9, 9,
+    },
+};
+
+} // namespace Net
@@ -0,0 +1,362 @@
+//------------------------------------------------------------------------------
+//  conditioner.cc
+//  @copyright (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "config.h"
+#include "conditioner.h"
+#include "core/cvar.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <string>
+
+namespace Net
+{
+
+/// address prefix of delivered datagrams, host and port as stored in ENetAddress
+static constexpr size_t HeaderSize = sizeof(enet_uint32) + sizeof(enet_uint16);
+
+/// the intercept callback has no user data, so it looks its conditioner up here
+static std::mutex attachedMutex;
+static std::vector<std::pair<ENetHost*, Conditioner*>> attached;
+
+//------------------------------------------------------------------------------
+/**
+    Steady clock in us.
+*/
+static uint64_t
+Now()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+Conditioner::Settings::Active() const
+{
+    return this->latency > 0 || this->jitter > 0 || this->loss > 0.0f || this->duplicate > 0.0f || this->reorder > 0.0f || this->bandwidth > 0;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+Conditioner::Conditioner()
+{
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+Conditioner::~Conditioner()
+{
+    this->Detach();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+Conditioner::Attach(ENetHost* host, const Settings& settings)
+{
+    this->Detach();
+    if (!settings.Active())
+        return true;
+
+    this->socket = enet_socket_create(ENET_SOCKET_TYPE_DATAGRAM);
+    if (this->socket == ENET_SOCKET_NULL)
+        return false;
+    enet_address_set_host(&this->socketAddress, "127.0.0.1");
+    this->socketAddress.port = 0;
+    if (enet_socket_bind(this->socket, &this->socketAddress) != 0 || enet_socket_get_address(this->socket, &this->socketAddress) != 0)
+    {
+        enet_socket_destroy(this->socket);
+        this->socket = ENET_SOCKET_NULL;
+        return false;
+    }
+
+    this->host = host;
+    this->settings = settings;
+    this->hostAddress = {};
+    this->order = 0;
+    this->linkFree = 0;
+    this->random = settings.seed != 0 ? settings.seed : 1;
+    this->received = 0;
+    this->dropped = 0;
+    this->overflowed = 0;
+    this->duplicated = 0;
+    this->reordered = 0;
+    this->queued = 0;
+
+    std::lock_guard<std::mutex> lock(attachedMutex);
+    attached.emplace_back(host, this);
+    host->intercept = &Conditioner::Intercept;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+Conditioner::Detach()
+{
+    if (this->host == nullptr)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(attachedMutex);
+        attached.erase(std::find(attached.begin(), attached.end(), std::make_pair(this->host, this)));
+    }
+    this->host->intercept = nullptr;
+    this->host = nullptr;
+
+    enet_socket_destroy(this->socket);
+    this->socket = ENET_SOCKET_NULL;
+    this->queue.clear();
+    this->queued = 0;
+}
+
+//------------------------------------------------------------------------------
+/**
+    The host socket is bound to all interfaces on the server and to nothing
+    until the first send on a client, so its address is looked up once
+    something has been received and delivered over loopback.
+*/
+void
+Conditioner::Update()
+{
+    if (this->host == nullptr || this->queue.empty())
+        return;
+
+    if (this->hostAddress.port == 0)
+    {
+        enet_socket_get_address(this->host->socket, &this->hostAddress);
+        if (this->hostAddress.host == ENET_HOST_ANY)
+            enet_address_set_host(&this->hostAddress, "127.0.0.1");
+    }
+
+    uint64_t const now = Now();
+    while (!this->queue.empty() && this->queue.front().due <= now)
+    {
+        std::pop_heap(this->queue.begin(), this->queue.end(), Later);
+        Datagram& datagram = this->queue.back();
+
+        enet_uint8 header[HeaderSize];
+        std::memcpy(header, &datagram.from.host, sizeof(enet_uint32));
+        std::memcpy(header + sizeof(enet_uint32), &datagram.from.port, sizeof(enet_uint16));
+        ENetBuffer buffers[2];
+        buffers[0].data = header;
+        buffers[0].dataLength = HeaderSize;
+        buffers[1].data = datagram.data.data();
+        buffers[1].dataLength = datagram.data.size();
+        enet_socket_send(this->socket, &this->hostAddress, buffers, 2);
+
+        this->freeBuffers.push_back(std::move(datagram.data));
+        this->queue.pop_back();
+    }
+    this->queued.store((uint32_t)this->queue.size(), std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Waits in steps of a millisecond so datagrams that become due meanwhile
+    are delivered, ENet would otherwise sleep on the socket for all of
+    timeout.
+*/
+int
+Conditioner::Service(ENetHost* host, ENetEvent* event, enet_uint32 timeout)
+{
+    if (host != this->host)
+        return enet_host_service(host, event, timeout);
+
+    uint64_t const deadline = Now() + (uint64_t)timeout * 1000;
+    for (;;)
+    {
+        this->Update();
+        uint64_t const now = Now();
+        int const result = enet_host_service(host, event, now < deadline ? 1 : 0);
+        if (result != 0 || now >= deadline)
+            return result;
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+Conditioner::Stats
+Conditioner::GetStats() const
+{
+    Stats stats;
+    stats.received = this->received.load(std::memory_order_relaxed);
+    stats.dropped = this->dropped.load(std::memory_order_relaxed);
+    stats.overflowed = this->overflowed.load(std::memory_order_relaxed);
+    stats.duplicated = this->duplicated.load(std::memory_order_relaxed);
+    stats.reordered = this->reordered.load(std::memory_order_relaxed);
+    stats.queued = this->queued.load(std::memory_order_relaxed);
+    return stats;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+int
+Conditioner::Intercept(ENetHost* host, ENetEvent*)
+{
+    Conditioner* conditioner = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(attachedMutex);
+        auto it = std::find_if(attached.begin(), attached.end(), [host](const auto& entry) { return entry.first == host; });
+        if (it != attached.end())
+            conditioner = it->second;
+    }
+    return conditioner != nullptr ? conditioner->Receive() : 0;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Every datagram draws the same random numbers whatever the settings, so
+    the decisions for one condition do not shift when another is changed.
+    Traffic counters of the host count a datagram when it first arrives.
+*/
+int
+Conditioner::Receive()
+{
+    ENetAddress const from = this->host->receivedAddress;
+    size_t const length = this->host->receivedDataLength;
+    if (from.host == this->socketAddress.host && from.port == this->socketAddress.port)
+    {
+        if (length < HeaderSize)
+            return 1;
+        std::memcpy(&this->host->receivedAddress.host, this->host->receivedData, sizeof(enet_uint32));
+        std::memcpy(&this->host->receivedAddress.port, this->host->receivedData + sizeof(enet_uint32), sizeof(enet_uint16));
+        this->host->receivedData += HeaderSize;
+        this->host->receivedDataLength -= HeaderSize;
+        this->host->totalReceivedData -= (enet_uint32)length;
+        this->host->totalReceivedPackets--;
+        return 0;
+    }
+
+    this->received.fetch_add(1, std::memory_order_relaxed);
+    float const lossRoll = this->Random();
+    float const jitterRoll = this->Random();
+    float const reorderRoll = this->Random();
+    float const duplicateRoll = this->Random();
+    float const duplicateJitterRoll = this->Random();
+
+    if (lossRoll < this->settings.loss)
+    {
+        this->dropped.fetch_add(1, std::memory_order_relaxed);
+        return 1;
+    }
+
+    uint64_t const now = Now();
+    uint64_t due = now;
+    if (this->settings.bandwidth > 0)
+    {
+        uint64_t const start = std::max(this->linkFree, now);
+        if (start - now > (uint64_t)MaxQueueDelay * 1000)
+        {
+            this->overflowed.fetch_add(1, std::memory_order_relaxed);
+            return 1;
+        }
+        this->linkFree = start + (uint64_t)length * 1000000 / this->settings.bandwidth;
+        due = this->linkFree;
+    }
+    due += (uint64_t)this->settings.latency * 1000;
+
+    uint64_t const jitter = (uint64_t)this->settings.jitter * 1000;
+    uint64_t const extra = reorderRoll < this->settings.reorder ? (uint64_t)ReorderDelay * 1000 : 0;
+    if (extra > 0)
+        this->reordered.fetch_add(1, std::memory_order_relaxed);
+    this->Queue(due + (uint64_t)(jitterRoll * jitter) + extra);
+
+    if (duplicateRoll < this->settings.duplicate)
+    {
+        this->duplicated.fetch_add(1, std::memory_order_relaxed);
+        this->Queue(due + (uint64_t)(duplicateJitterRoll * jitter));
+    }
+    this->queued.store((uint32_t)this->queue.size(), std::memory_order_relaxed);
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+Conditioner::Queue(uint64_t due)
+{
+    Datagram datagram;
+    datagram.due = due;
+    datagram.order = this->order++;
+    datagram.from = this->host->receivedAddress;
+    if (!this->freeBuffers.empty())
+    {
+        datagram.data = std::move(this->freeBuffers.back());
+        this->freeBuffers.pop_back();
+    }
+    datagram.data.assign(this->host->receivedData, this->host->receivedData + this->host->receivedDataLength);
+    this->queue.push_back(std::move(datagram));
+    std::push_heap(this->queue.begin(), this->queue.end(), Later);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Heap order, the datagram due first on top.
+*/
+bool
+Conditioner::Later(const Datagram& a, const Datagram& b)
+{
+    return a.due != b.due ? a.due > b.due : a.order > b.order;
+}
+
+//------------------------------------------------------------------------------
+/**
+    xorshift32, seeded per conditioner.
+*/
+float
+Conditioner::Random()
+{
+    this->random ^= this->random << 13;
+    this->random ^= this->random >> 17;
+    this->random ^= this->random << 5;
+    return (this->random >> 8) * (1.0f / 16777216.0f);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Rates are in percent and the bandwidth in kB/s on the command line.
+*/
+void
+CreateConditionerCVars(const char* prefix)
+{
+    std::string const name = prefix;
+    Core::CVarCreate(Core::CVar_Int, (name + "latency").c_str(), "0", "Network conditioner: ms added to every received datagram");
+    Core::CVarCreate(Core::CVar_Int, (name + "jitter").c_str(), "0", "Network conditioner: up to this many random ms added on top of the latency");
+    Core::CVarCreate(Core::CVar_Float, (name + "loss").c_str(), "0", "Network conditioner: percent of received datagrams dropped");
+    Core::CVarCreate(Core::CVar_Float, (name + "duplicate").c_str(), "0", "Network conditioner: percent of received datagrams delivered twice");
+    Core::CVarCreate(Core::CVar_Float, (name + "reorder").c_str(), "0", "Network conditioner: percent of received datagrams delivered late, after the ones behind them");
+    Core::CVarCreate(Core::CVar_Int, (name + "bandwidth").c_str(), "0", "Network conditioner: kB/s of received data, 0 for no limit");
+    Core::CVarCreate(Core::CVar_Int, (name + "seed").c_str(), "1", "Network conditioner: seed of the random decisions, the same seed conditions the same traffic the same way");
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+Conditioner::Settings
+ReadConditionerCVars(const char* prefix)
+{
+    std::string const name = prefix;
+    Conditioner::Settings settings;
+    settings.latency = (uint32_t)std::max(0, Core::CVarReadInt(Core::CVarGet((name + "latency").c_str())));
+    settings.jitter = (uint32_t)std::max(0, Core::CVarReadInt(Core::CVarGet((name + "jitter").c_str())));
+    settings.loss = std::clamp(Core::CVarReadFloat(Core::CVarGet((name + "loss").c_str())) / 100.0f, 0.0f, 1.0f);
+    settings.duplicate = std::clamp(Core::CVarReadFloat(Core::CVarGet((name + "duplicate").c_str())) / 100.0f, 0.0f, 1.0f);
+    settings.reorder = std::clamp(Core::CVarReadFloat(Core::CVarGet((name + "reorder").c_str())) / 100.0f, 0.0f, 1.0f);
+    settings.bandwidth = (uint32_t)std::max(0, Core::CVarReadInt(Core::CVarGet((name + "bandwidth").c_str()))) * 1000;
+    settings.seed = (uint32_t)Core::CVarReadInt(Core::CVarGet((name + "seed").c_str()));
+    return settings;
+}
+
+} // namespace Net
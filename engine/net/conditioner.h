@@ -0,0 +1,149 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @file conditioner.h
+
+    @class Net::Conditioner
+
+    Simulates a bad network on the datagrams an ENetHost receives: latency,
+    jitter, loss, duplication, reordering and a bandwidth cap. Each side
+    conditions the direction it receives, the client the server's traffic
+    and the server the clients'.
+
+    Datagrams are taken out of ENet with its intercept callback and held in
+    a queue until due. Then they are sent to the host's own socket from a
+    loopback socket, prefixed with the address they originally came from,
+    and the intercept hands them to ENet as if they had just arrived from
+    there. All random decisions come from a seeded generator, so the same
+    traffic is conditioned the same way on every run.
+
+    Datagrams are only released by Update, which runs on the thread that
+    services the host. Its rate is the resolution of the added delays, so
+    blocking waits on the host have to go through Service.
+
+    @copyright
+    (C) 2024 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include "enet/enet.h"
+#include <atomic>
+#include <vector>
+
+namespace Net
+{
+
+class Conditioner
+{
+public:
+    struct Settings
+    {
+        /// ms every datagram is delayed
+        uint32_t latency = 0;
+        /// up to this many ms of extra random delay per datagram, delivers out of order when above the send interval
+        uint32_t jitter = 0;
+        /// fraction of datagrams dropped
+        float loss = 0.0f;
+        /// fraction of datagrams delivered twice
+        float duplicate = 0.0f;
+        /// fraction of datagrams held back by ReorderDelay, behind the ones after them
+        float reorder = 0.0f;
+        /// bytes per second the link carries, 0 for no limit
+        uint32_t bandwidth = 0;
+        /// seed of the random decisions
+        uint32_t seed = 1;
+
+        /// true if any condition is set
+        bool Active() const;
+    };
+
+    struct Stats
+    {
+        uint64_t received = 0;
+        uint64_t dropped = 0;
+        /// dropped because the bandwidth cap queued them for longer than MaxQueueDelay
+        uint64_t overflowed = 0;
+        uint64_t duplicated = 0;
+        uint64_t reordered = 0;
+        /// datagrams waiting to be delivered
+        uint32_t queued = 0;
+    };
+
+    /// ms a reordered datagram is held back on top of its delay
+    static constexpr uint32_t ReorderDelay = 25;
+    /// ms of backlog the bandwidth cap queues before it drops, like a router buffer
+    static constexpr uint32_t MaxQueueDelay = 1000;
+
+    /// constructor
+    Conditioner();
+    /// destructor, detaches
+    ~Conditioner();
+    Conditioner(const Conditioner&) = delete;
+    Conditioner& operator=(const Conditioner&) = delete;
+
+    /// condition what host receives, does nothing if settings are not active, false if the loopback socket failed
+    bool Attach(ENetHost* host, const Settings& settings);
+    /// deliver nothing more, datagrams still queued are lost
+    void Detach();
+    /// true between a successful Attach of active settings and Detach
+    bool Attached() const { return this->host != nullptr; }
+
+    /// deliver the datagrams that are due, on the thread servicing the host
+    void Update();
+    /// enet_host_service that keeps delivering while it waits, host is the one attached to if any
+    int Service(ENetHost* host, ENetEvent* event, enet_uint32 timeout);
+
+    /// counters since Attach, may be read from any thread
+    Stats GetStats() const;
+
+private:
+    struct Datagram
+    {
+        /// us
+        uint64_t due;
+        /// order of arrival, delivers datagrams due at the same time in order
+        uint64_t order;
+        ENetAddress from;
+        std::vector<enet_uint8> data;
+    };
+
+    /// ENet intercept, finds the conditioner of host
+    static int Intercept(ENetHost* host, ENetEvent* event);
+    /// hand a delivered datagram to ENet, or take a new one out of it
+    int Receive();
+    /// queue a copy of the datagram ENet just received
+    void Queue(uint64_t due);
+    /// heap order of the queue
+    static bool Later(const Datagram& a, const Datagram& b);
+    /// uniform in 0..1
+    float Random();
+
+    ENetHost* host = nullptr;
+    Settings settings;
+    /// delivers to the host, from a loopback address the intercept recognizes
+    ENetSocket socket = ENET_SOCKET_NULL;
+    ENetAddress socketAddress = {};
+    ENetAddress hostAddress = {};
+
+    /// min heap by due and order
+    std::vector<Datagram> queue;
+    /// data buffers of delivered datagrams, reused by Queue
+    std::vector<std::vector<enet_uint8>> freeBuffers;
+    uint64_t order = 0;
+    /// us when the capped link is done carrying the queued datagrams
+    uint64_t linkFree = 0;
+    uint32_t random = 1;
+
+    std::atomic<uint64_t> received = 0;
+    std::atomic<uint64_t> dropped = 0;
+    std::atomic<uint64_t> overflowed = 0;
+    std::atomic<uint64_t> duplicated = 0;
+    std::atomic<uint64_t> reordered = 0;
+    std::atomic<uint32_t> queued = 0;
+};
+
+/// create the CVars prefix + latency, jitter, loss, duplicate, reorder, bandwidth and seed
+void CreateConditionerCVars(const char* prefix);
+/// settings from the CVars made by CreateConditionerCVars
+Conditioner::Settings ReadConditionerCVars(const char* prefix);
+
+} // namespace Net
@@ -0,0 +1,87 @@
+//------------------------------------------------------------------------------
+//  eventbatch.cc
+//  @copyright (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "config.h"
+#include "eventbatch.h"
+#include <cstring>
+
+namespace Net
+{
+
+//------------------------------------------------------------------------------
+/**
+*/
+static inline size_t
+PaddedSize(size_t size)
+{
+    return (size + EventBatch::FrameAlignment - 1) & ~(EventBatch::FrameAlignment - 1);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+uint32_t
+EventBatch::Add(const uint8_t* data, size_t size)
+{
+    uint32_t const event = (uint32_t)this->offsets.size();
+    size_t const start = this->frames.size();
+    this->offsets.push_back((uint32_t)start);
+    this->frames.resize(start + FrameAlignment + PaddedSize(size), 0);
+
+    uint32_t const length = (uint32_t)size;
+    std::memcpy(&this->frames[start], &length, sizeof(length));
+    std::memcpy(&this->frames[start + FrameAlignment], data, size);
+    return event;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+EventBatch::Append(uint32_t event, std::vector<uint8_t>& batch) const
+{
+    size_t const start = this->offsets[event];
+    size_t const end = event + 1 < this->offsets.size() ? this->offsets[event + 1] : this->frames.size();
+    batch.insert(batch.end(), this->frames.begin() + start, this->frames.begin() + end);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+uint32_t
+EventBatch::Count() const
+{
+    return (uint32_t)this->offsets.size();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+EventBatch::Clear()
+{
+    this->frames.clear();
+    this->offsets.clear();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+EventBatch::Next(const uint8_t* batch, size_t size, size_t& offset, const uint8_t*& data, size_t& length)
+{
+    if (offset + FrameAlignment > size)
+        return false;
+    uint32_t frameLength;
+    std::memcpy(&frameLength, batch + offset, sizeof(frameLength));
+    if (frameLength > size - offset - FrameAlignment)
+        return false;
+
+    data = batch + offset + FrameAlignment;
+    length = frameLength;
+    offset += FrameAlignment + PaddedSize(frameLength);
+    return true;
+}
+
+} // namespace Net
@@ -0,0 +1,53 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @file eventbatch.h
+
+    @class Net::EventBatch
+
+    Collects the finished event messages of a tick, spawns and despawns, so
+    every peer can be sent the ones meant for it as one reliable message
+    instead of one each. An event is copied once however many peers get it,
+    each peer's batch is then put together from copies of the framed events.
+
+    A batch is the events back to back, each behind its size as a uint32 and
+    4 bytes of padding and padded to 8 bytes, so an event that starts 8 byte
+    aligned in the batch can be read in place like the buffer it was.
+
+    @copyright
+    (C) 2024 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+namespace Net
+{
+
+class EventBatch
+{
+public:
+    /// bytes in front of every event, and what it is padded to
+    static constexpr size_t FrameAlignment = 8;
+
+    /// copy a finished message, returns its index for Append
+    uint32_t Add(const uint8_t* data, size_t size);
+    /// append the framed event to a peer's batch
+    void Append(uint32_t event, std::vector<uint8_t>& batch) const;
+    /// events added since Clear
+    uint32_t Count() const;
+    /// forget all events, after the batches were sent
+    void Clear();
+
+    /// event at offset of a received batch, moves offset past it, false at the end or if the batch is cut short
+    static bool Next(const uint8_t* batch, size_t size, size_t& offset, const uint8_t*& data, size_t& length);
+
+private:
+    /// framed events back to back
+    std::vector<uint8_t> frames;
+    /// where each event's frame starts
+    std::vector<uint32_t> offsets;
+};
+
+} // namespace Net
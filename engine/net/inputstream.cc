@@ -0,0 +1,118 @@
+//------------------------------------------------------------------------------
+//  inputstream.cc
+//  @copyright (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "config.h"
+#include "inputstream.h"
+#include <algorithm>
+
+namespace Net
+{
+
+//------------------------------------------------------------------------------
+/**
+    A change is sent in the Redundancy datagrams that follow it, each of them
+    carrying it among the previous inputs.
+*/
+bool
+InputSender::Sample(uint16_t bitmap)
+{
+    this->sequence++;
+    bool const changed = this->sequence == 1 || bitmap != this->history[0];
+    for (uint32_t i = InputRedundancy - 1; i > 0; i--)
+        this->history[i] = this->history[i - 1];
+    this->history[0] = bitmap;
+
+    if (changed)
+        this->lastChange = this->sequence;
+
+    bool const due = this->sequence - this->lastChange < InputRedundancy || this->sequence - this->lastSent >= InputHeartbeatTicks;
+    if (due)
+        this->lastSent = this->sequence;
+    return due;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+InputSender::Reset()
+{
+    *this = InputSender();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+InputReceiver::Insert(uint32_t sequence, uint16_t bitmap)
+{
+    // Already applied, a duplicate from an earlier datagram, or too old for Next to apply
+    if (sequence <= this->ack || sequence + MaxQueued < this->latest)
+        return;
+    auto it = std::lower_bound(this->queue.begin(), this->queue.end(), sequence, [](const Input& input, uint32_t s) {
+        return input.sequence < s;
+    });
+    if (it == this->queue.end() || it->sequence != sequence)
+        this->queue.insert(it, { sequence, bitmap });
+}
+
+//------------------------------------------------------------------------------
+/**
+    The first datagram may start anywhere, the ones before it can be lost.
+    After that the client can not be further ahead than the ticks that
+    passed, so a larger jump is dropped rather than letting it skip the
+    stream ahead. latest is raised first, so inputs that already fell out
+    of the MaxQueued window are not queued.
+*/
+void
+InputReceiver::Receive(uint32_t sequence, uint16_t bitmap, const uint16_t* previous, uint32_t previousCount)
+{
+    n_assert(sequence != 0);
+    if (this->latest != 0 && sequence > this->latest && sequence - this->latest > this->ticksSinceLatest + MaxJump)
+        return;
+    if (sequence > this->latest)
+    {
+        this->latest = sequence;
+        this->ticksSinceLatest = 0;
+    }
+
+    this->Insert(sequence, bitmap);
+    previousCount = std::min(previousCount, InputRedundancy - 1);
+    for (uint32_t i = 0; i < previousCount && i + 1 < sequence; i++)
+        this->Insert(sequence - 1 - i, previous[i]);
+}
+
+//------------------------------------------------------------------------------
+/**
+    A stream that fell far behind, on the first datagram or after a burst,
+    skips to MaxQueued inputs behind the newest. The client reconciles the
+    inputs that were skipped or assumed unchanged when they were not.
+*/
+uint16_t
+InputReceiver::Next()
+{
+    if (this->latest == 0)
+        return this->bitmap;
+    this->ticksSinceLatest++;
+
+    if (this->latest > this->ack + MaxQueued)
+        this->ack = this->latest - MaxQueued;
+    while (!this->queue.empty() && this->queue.front().sequence <= this->ack)
+        this->queue.erase(this->queue.begin());
+
+    uint32_t const next = this->ack + 1;
+    if (!this->queue.empty() && this->queue.front().sequence == next)
+    {
+        this->bitmap = this->queue.front().bitmap;
+        this->queue.erase(this->queue.begin());
+        this->ack = next;
+    }
+    else if (next <= this->latest + MaxSpeculative)
+    {
+        this->ack = next;
+    }
+    return this->bitmap;
+}
+
+} // namespace Net
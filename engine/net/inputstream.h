@@ -0,0 +1,98 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @file inputstream.h
+
+    Client input stream over an unreliable channel.
+
+    The client samples one input bitmap per server tick and numbers them with
+    a sequence. A datagram carries the newest input and the Redundancy - 1
+    inputs before it, so a change survives the loss of all but one of the
+    Redundancy datagrams that follow it. While the bitmap does not change
+    nothing is sent apart from a heartbeat every HeartbeatTicks.
+
+    The server applies one input per tick in sequence order. An input that
+    has not arrived is assumed unchanged, which is what an unsent input means,
+    as long as it is at most MaxSpeculative ticks past the newest one heard of.
+
+    The receiver takes what the client sends as untrusted. It only keeps
+    inputs Next could still apply, and it drops datagrams whose sequence is
+    further ahead than the client could have sampled since the last one.
+
+    @copyright
+    (C) 2024 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include <vector>
+#include <algorithm>
+
+namespace Net
+{
+
+/// inputs per datagram, the newest and the ones before it
+constexpr uint32_t InputRedundancy = 4;
+/// ticks between datagrams while the input does not change
+constexpr uint32_t InputHeartbeatTicks = 6;
+
+class InputSender
+{
+public:
+    /// record the input of the next tick, returns true if a datagram is due
+    bool Sample(uint16_t bitmap);
+    /// sequence of the newest input, 0 before the first Sample
+    uint32_t Sequence() const { return this->sequence; }
+    /// bitmap of the newest input
+    uint16_t Bitmap() const { return this->history[0]; }
+    /// bitmaps of the inputs before the newest, newest first
+    const uint16_t* Previous() const { return this->history + 1; }
+    /// number of entries in Previous
+    uint32_t PreviousCount() const { return std::min(this->sequence, InputRedundancy) - 1; }
+    /// start over at sequence 1, for a new connection
+    void Reset();
+
+private:
+    uint32_t sequence = 0;
+    uint32_t lastChange = 0;
+    uint32_t lastSent = 0;
+    /// newest first
+    uint16_t history[InputRedundancy] = {};
+};
+
+class InputReceiver
+{
+public:
+    /// inputs the simulation may trail the newest received one by before skipping ahead
+    static constexpr uint32_t MaxQueued = 8;
+    /// inputs past the newest received one that are assumed unchanged
+    static constexpr uint32_t MaxSpeculative = InputHeartbeatTicks + 2;
+    /// how far a sequence may run ahead of the ticks since the newest one, for bursts and clock drift
+    static constexpr uint32_t MaxJump = MaxQueued + MaxSpeculative;
+
+    /// add a datagram, previous are the bitmaps of the inputs before sequence, newest first, only InputRedundancy - 1 of them are used
+    void Receive(uint32_t sequence, uint16_t bitmap, const uint16_t* previous, uint32_t previousCount);
+    /// input for the next simulation tick, advances Ack unless the stream has stalled
+    uint16_t Next();
+    /// sequence of the newest input returned by Next, 0 if none
+    uint32_t Ack() const { return this->ack; }
+    /// true once a datagram was received
+    bool Started() const { return this->latest != 0; }
+
+private:
+    struct Input
+    {
+        uint32_t sequence;
+        uint16_t bitmap;
+    };
+
+    void Insert(uint32_t sequence, uint16_t bitmap);
+
+    /// received inputs after ack, sorted by sequence
+    std::vector<Input> queue;
+    uint32_t ack = 0;
+    uint32_t latest = 0;
+    /// Next calls since latest last advanced, the client samples one input per tick
+    uint32_t ticksSinceLatest = 0;
+    uint16_t bitmap = 0;
+};
+
+} // namespace Net
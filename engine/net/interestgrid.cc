@@ -0,0 +1,88 @@
+//------------------------------------------------------------------------------
+//  interestgrid.cc
+//  @copyright (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "config.h"
+#include "interestgrid.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Net
+{
+
+//------------------------------------------------------------------------------
+/**
+    21 bits per axis, cell coordinates wrap at +-1M cells which is far
+    outside any playable area.
+*/
+uint64_t
+InterestGrid::CellKey(int x, int y, int z) const
+{
+    uint64_t const mask = (1ull << 21) - 1;
+    return (((uint64_t)x & mask) << 42) | (((uint64_t)y & mask) << 21) | ((uint64_t)z & mask);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+InterestGrid::Clear(float cellSize)
+{
+    n_assert(cellSize > 0.0f);
+    this->cellSize = cellSize;
+    this->entries.clear();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+InterestGrid::Insert(uint32_t id, const glm::vec3& position)
+{
+    glm::vec3 const cell = glm::floor(position / this->cellSize);
+    this->entries.push_back({ this->CellKey((int)cell.x, (int)cell.y, (int)cell.z), id, position });
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+InterestGrid::Build()
+{
+    std::sort(this->entries.begin(), this->entries.end(), [](const Entry& a, const Entry& b) {
+        return a.cell < b.cell;
+    });
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+InterestGrid::Query(const glm::vec3& center, float radius, std::vector<Entry>& out) const
+{
+    glm::ivec3 const lo = glm::ivec3(glm::floor((center - radius) / this->cellSize));
+    glm::ivec3 const hi = glm::ivec3(glm::floor((center + radius) / this->cellSize));
+    float const radiusSq = radius * radius;
+
+    for (int x = lo.x; x <= hi.x; x++)
+    {
+        for (int y = lo.y; y <= hi.y; y++)
+        {
+            for (int z = lo.z; z <= hi.z; z++)
+            {
+                uint64_t const key = this->CellKey(x, y, z);
+                auto it = std::lower_bound(this->entries.begin(), this->entries.end(), key, [](const Entry& e, uint64_t k) {
+                    return e.cell < k;
+                });
+                for (; it != this->entries.end() && it->cell == key; it++)
+                {
+                    glm::vec3 const d = it->position - center;
+                    if (glm::dot(d, d) <= radiusSq)
+                        out.push_back(*it);
+                }
+            }
+        }
+    }
+}
+
+} // namespace Net
@@ -0,0 +1,49 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @file interestgrid.h
+
+    @class Net::InterestGrid
+
+    Uniform grid over entity positions for interest management and the server's
+    collision broadphase. Rebuilt every tick: Clear, Insert all entities, Build,
+    then Query any number of times.
+    Entries are kept in one array sorted by cell, so rebuilding reuses the
+    previous allocation and a query is a binary search per overlapped cell.
+
+    @copyright
+    (C) 2024 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include <vector>
+
+namespace Net
+{
+
+class InterestGrid
+{
+public:
+    struct Entry
+    {
+        uint64_t cell;
+        uint32_t id;
+        glm::vec3 position;
+    };
+
+    /// remove all entries and set the cell size used by the following inserts
+    void Clear(float cellSize);
+    /// add an entity
+    void Insert(uint32_t id, const glm::vec3& position);
+    /// sort the entries, call after the last Insert and before Query
+    void Build();
+    /// append all entries within radius of center to out
+    void Query(const glm::vec3& center, float radius, std::vector<Entry>& out) const;
+
+private:
+    uint64_t CellKey(int x, int y, int z) const;
+
+    float cellSize = 1.0f;
+    std::vector<Entry> entries;
+};
+
+} // namespace Net
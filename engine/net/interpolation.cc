@@ -0,0 +1,159 @@
+//------------------------------------------------------------------------------
+//  interpolation.cc
+//  @copyright (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "config.h"
+#include "interpolation.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Net
+{
+
+//------------------------------------------------------------------------------
+/**
+    Snapshots arriving out of order are dropped before they get here, but far
+    players and teleports come through other packets and may repeat a time.
+*/
+void
+InterpolationBuffer::Add(uint64_t time, const glm::vec3& position, const glm::vec3& velocity, const glm::quat& orientation)
+{
+    if (this->count > 0 && time <= this->At(this->count - 1).time)
+        return;
+
+    if (this->count == Capacity)
+    {
+        this->first = (this->first + 1) % Capacity;
+        this->count--;
+    }
+    State& state = this->states[(this->first + this->count) % Capacity];
+    state.time = time;
+    state.position = position;
+    state.velocity = velocity;
+    state.orientation = orientation;
+    this->count++;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Render times before the oldest state hold it, which is also how a state
+    added to an empty buffer shows up right away.
+*/
+bool
+InterpolationBuffer::Sample(double time, float maxExtrapolation, glm::vec3& position, glm::quat& orientation) const
+{
+    if (this->count == 0)
+        return false;
+
+    const State& oldest = this->At(0);
+    if (time <= (double)oldest.time)
+    {
+        position = oldest.position;
+        orientation = oldest.orientation;
+        return true;
+    }
+
+    const State& newest = this->At(this->count - 1);
+    if (time >= (double)newest.time)
+    {
+        float const t = std::min((float)((time - (double)newest.time) / 1000.0), maxExtrapolation);
+        position = newest.position + newest.velocity * t;
+        orientation = newest.orientation;
+        return true;
+    }
+
+    // The render time trails the newest states by a few snapshots, so search from there
+    uint32_t i = this->count - 1;
+    while ((double)this->At(i - 1).time > time)
+        i--;
+    const State& from = this->At(i - 1);
+    const State& to = this->At(i);
+    float const alpha = (float)((time - (double)from.time) / (double)(to.time - from.time));
+    position = glm::mix(from.position, to.position, alpha);
+    orientation = glm::normalize(glm::slerp(from.orientation, to.orientation, alpha));
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+const InterpolationBuffer::State*
+InterpolationBuffer::Newest() const
+{
+    return (this->count > 0) ? &this->At(this->count - 1) : nullptr;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+InterpolationBuffer::Clear()
+{
+    this->first = 0;
+    this->count = 0;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Estimates the jitter like RTP does: the difference in transit time of
+    consecutive snapshots, smoothed. The transit includes the unknown clock
+    offset, which cancels out in the difference.
+*/
+void
+InterpolationClock::AddSnapshot(uint64_t serverTime, uint64_t localTime)
+{
+    int64_t const transit = (int64_t)localTime - (int64_t)serverTime;
+    if (this->hasTransit)
+    {
+        double const deviation = (double)std::abs(transit - this->lastTransit);
+        this->jitter += (deviation - this->jitter) / JitterSmoothing;
+    }
+    this->lastTransit = transit;
+    this->hasTransit = true;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Render time follows its target by running slightly faster or slower than
+    real time, which keeps motion smooth while the delay adapts.
+*/
+double
+InterpolationClock::Advance(float dt, uint64_t serverTime)
+{
+    double const target = (double)serverTime - this->Delay();
+    double const step = (double)dt * 1000.0;
+    if (this->renderTime == 0.0 || std::abs(target - this->renderTime) > JumpThreshold)
+    {
+        this->renderTime = target;
+        return this->renderTime;
+    }
+
+    double const error = target - (this->renderTime + step);
+    this->renderTime += step + std::clamp(error, -step * MaxRateAdjust, step * MaxRateAdjust);
+    return this->renderTime;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+double
+InterpolationClock::Delay() const
+{
+    if (!this->adaptive)
+        return this->minDelay;
+    return std::clamp(this->minDelay + JitterFactor * this->jitter, this->minDelay, std::max(this->minDelay, this->maxDelay));
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+InterpolationClock::Reset()
+{
+    this->renderTime = 0.0;
+    this->jitter = 0.0;
+    this->lastTransit = 0;
+    this->hasTransit = false;
+}
+
+} // namespace Net
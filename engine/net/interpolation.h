@@ -0,0 +1,101 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @file interpolation.h
+
+    Snapshot interpolation for remote entities.
+
+    @class Net::InterpolationBuffer keeps the last Capacity states received for
+    one entity. Sampling at a render time between two of them interpolates
+    the position and slerps the orientation. Past the newest state it
+    extrapolates with the newest velocity, for a bounded time only.
+
+    @class Net::InterpolationClock decides the render time. Remote entities are
+    shown Delay() ms behind the server time, which gives later snapshots time
+    to arrive and bracket the render time even when some come late or get
+    lost. The delay adapts to the measured snapshot jitter. Render time runs
+    at up to 10% above or below real time to follow delay changes, so it never
+    jumps or goes backwards.
+
+    @copyright
+    (C) 2024 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+
+namespace Net
+{
+
+class InterpolationBuffer
+{
+public:
+    static constexpr uint32_t Capacity = 32;
+
+    struct State
+    {
+        uint64_t time = 0;
+        glm::vec3 position = glm::vec3(0);
+        /// units per second
+        glm::vec3 velocity = glm::vec3(0);
+        glm::quat orientation = glm::identity<glm::quat>();
+    };
+
+    /// add the state at server time, states not newer than the newest one are dropped
+    void Add(uint64_t time, const glm::vec3& position, const glm::vec3& velocity, const glm::quat& orientation);
+    /// state at time in ms, extrapolating at most maxExtrapolation seconds, false if empty
+    bool Sample(double time, float maxExtrapolation, glm::vec3& position, glm::quat& orientation) const;
+    /// newest state, nullptr if empty
+    const State* Newest() const;
+    /// forget all states, the next one is shown right away
+    void Clear();
+    /// number of states held
+    uint32_t Size() const { return this->count; }
+
+private:
+    /// i-th oldest state
+    const State& At(uint32_t i) const { return this->states[(this->first + i) % Capacity]; }
+
+    State states[Capacity];
+    uint32_t first = 0;
+    uint32_t count = 0;
+};
+
+class InterpolationClock
+{
+public:
+    /// jitter estimates are smoothed over about this many snapshots
+    static constexpr double JitterSmoothing = 16.0;
+    /// the delay covers this many times the jitter on top of the minimum delay
+    static constexpr double JitterFactor = 2.0;
+    /// render time rate change, as a fraction of real time
+    static constexpr double MaxRateAdjust = 0.1;
+    /// ms of render time error above which it jumps instead of catching up
+    static constexpr double JumpThreshold = 250.0;
+
+    /// measure the jitter of a snapshot stamped serverTime that arrived at localTime
+    void AddSnapshot(uint64_t serverTime, uint64_t localTime);
+    /// advance by dt seconds towards serverTime - Delay(), returns the render time in ms
+    double Advance(float dt, uint64_t serverTime);
+    /// ms entities are shown behind the server time, before rate limiting
+    double Delay() const;
+    /// mean deviation of the snapshot transit times in ms
+    double Jitter() const { return this->jitter; }
+    /// render time of the last Advance
+    double RenderTime() const { return this->renderTime; }
+    /// start over, for a new connection
+    void Reset();
+
+    /// delay in ms without any jitter
+    double minDelay = 50.0;
+    /// upper bound of the adaptive delay in ms
+    double maxDelay = 250.0;
+    /// add the measured jitter to the delay
+    bool adaptive = true;
+
+private:
+    double renderTime = 0.0;
+    double jitter = 0.0;
+    int64_t lastTransit = 0;
+    bool hasTransit = false;
+};
+
+} // namespace Net
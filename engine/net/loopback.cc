@@ -0,0 +1,164 @@
+//------------------------------------------------------------------------------
+//  loopback.cc
+//  @copyright (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "config.h"
+#include "loopback.h"
+#include <cstring>
+#include <new>
+
+namespace Net
+{
+
+//------------------------------------------------------------------------------
+/**
+*/
+Loopback::Loopback()
+{
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+Loopback::~Loopback()
+{
+    // Hosts destroyed later would find a dangling loopback, let them fail their sends instead
+    for (auto& endpoint : this->endpoints)
+        endpoint.second->loopback = nullptr;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+ENetAddress
+Loopback::Address(uint16_t port)
+{
+    ENetAddress address;
+    address.host = ENET_HOST_TO_NET_32(0x7F000001);
+    address.port = port;
+    return address;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+uint64_t
+Loopback::Key(const ENetAddress& address)
+{
+    return ((uint64_t)address.host << 16) | address.port;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+Loopback::Attach(ENetHost* host, uint16_t port)
+{
+    if (port == 0)
+    {
+        while (this->endpoints.count(Key(Address(this->nextPort))) != 0)
+            this->nextPort = this->nextPort == 0xFFFF ? 49152 : this->nextPort + 1;
+        port = this->nextPort++;
+    }
+    ENetAddress const address = Address(port);
+    if (this->endpoints.count(Key(address)) != 0)
+        return false;
+
+    Endpoint* endpoint = new (std::nothrow) Endpoint();
+    if (endpoint == nullptr)
+        return false;
+    endpoint->loopback = this;
+    endpoint->address = address;
+    this->endpoints[Key(address)] = endpoint;
+
+    ENetTransport transport;
+    transport.context = endpoint;
+    transport.send = &Loopback::Send;
+    transport.receive = &Loopback::Receive;
+    transport.destroy = &Loopback::Destroy;
+    enet_host_transport(host, &transport);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+    The datagram is gathered straight into the receiver's inbox, a host
+    sending to itself works like any other.
+*/
+int ENET_CALLBACK
+Loopback::Send(void* context, const ENetAddress* address, const ENetBuffer* buffers, size_t bufferCount)
+{
+    Endpoint* endpoint = (Endpoint*)context;
+    Loopback* loopback = endpoint->loopback;
+    if (loopback == nullptr)
+        return -1;
+
+    size_t length = 0;
+    for (size_t i = 0; i < bufferCount; i++)
+        length += buffers[i].dataLength;
+
+    auto const found = loopback->endpoints.find(Key(*address));
+    if (found == loopback->endpoints.end())
+    {
+        // Like UDP, the sender does not learn about it
+        loopback->stats.undeliverable++;
+        return (int)length;
+    }
+
+    Endpoint* receiver = found->second;
+    Datagram datagram;
+    datagram.from = endpoint->address;
+    datagram.offset = receiver->bytes.size();
+    datagram.length = length;
+    receiver->bytes.resize(datagram.offset + length);
+    uint8_t* data = receiver->bytes.data() + datagram.offset;
+    for (size_t i = 0; i < bufferCount; i++)
+    {
+        std::memcpy(data, buffers[i].data, buffers[i].dataLength);
+        data += buffers[i].dataLength;
+    }
+    receiver->inbox.push_back(datagram);
+
+    loopback->stats.datagrams++;
+    loopback->stats.bytes += length;
+    return (int)length;
+}
+
+//------------------------------------------------------------------------------
+/**
+    The inbox is emptied rather than shifted once everything in it was
+    received, which happens every service, so it does not grow.
+*/
+int ENET_CALLBACK
+Loopback::Receive(void* context, ENetAddress* address, ENetBuffer* buffer)
+{
+    Endpoint* endpoint = (Endpoint*)context;
+    if (endpoint->next == endpoint->inbox.size())
+    {
+        endpoint->inbox.clear();
+        endpoint->bytes.clear();
+        endpoint->next = 0;
+        return 0;
+    }
+
+    const Datagram& datagram = endpoint->inbox[endpoint->next++];
+    // Truncated like a UDP receive into a short buffer, ENet's buffer holds its largest datagram
+    size_t const length = datagram.length < buffer->dataLength ? datagram.length : buffer->dataLength;
+    std::memcpy(buffer->data, endpoint->bytes.data() + datagram.offset, length);
+    *address = datagram.from;
+    return (int)length;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void ENET_CALLBACK
+Loopback::Destroy(void* context)
+{
+    Endpoint* endpoint = (Endpoint*)context;
+    if (endpoint->loopback != nullptr)
+        endpoint->loopback->endpoints.erase(Key(endpoint->address));
+    delete endpoint;
+}
+
+} // namespace Net
@@ -0,0 +1,93 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @file loopback.h
+
+    @class Net::Loopback
+
+    In-memory network for running a server and its clients in one process.
+    Attached hosts exchange datagrams through the loopback instead of their
+    sockets, each datagram is copied into the inbox of the host attached at
+    its destination address and received from there by the next service of
+    that host. Nothing is lost, delayed or reordered, and there are no
+    system calls, so stepping all hosts in turn measures the protocol and
+    the game without the kernel's networking.
+
+    ENet still runs unchanged on top, with its reliability, fragmentation,
+    compression and timeouts. Its clock is the real one unless it is held
+    with enet_time_set before each host is serviced, as GameServer::Step
+    does. The loopback is not thread safe, all its hosts have to be
+    serviced on one thread and with a timeout of 0, and the Conditioner
+    does not work on them, it delivers through real sockets. The loopback
+    has to outlive its hosts.
+
+    @copyright
+    (C) 2024 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include "enet/enet.h"
+#include <stdint.h>
+#include <vector>
+#include <unordered_map>
+
+namespace Net
+{
+
+class Loopback
+{
+public:
+    struct Stats
+    {
+        uint64_t datagrams = 0;
+        uint64_t bytes = 0;
+        /// sent to an address no host is attached at
+        uint64_t undeliverable = 0;
+    };
+
+    /// constructor
+    Loopback();
+    /// destructor, its hosts have to be destroyed already
+    ~Loopback();
+    Loopback(const Loopback&) = delete;
+    Loopback& operator=(const Loopback&) = delete;
+
+    /// the address of port on the loopback, what clients connect to
+    static ENetAddress Address(uint16_t port);
+    /// exchange the host's datagrams through the loopback at port, 0 picks a free one, false if port is taken or out of memory
+    bool Attach(ENetHost* host, uint16_t port = 0);
+
+    /// totals since construction
+    Stats stats;
+
+private:
+    struct Datagram
+    {
+        ENetAddress from;
+        /// in the endpoint's bytes
+        size_t offset;
+        size_t length;
+    };
+
+    /// an attached host's address and inbox, owned by the host's transport
+    struct Endpoint
+    {
+        Loopback* loopback;
+        ENetAddress address;
+        /// datagrams waiting to be received, from next on
+        std::vector<Datagram> inbox;
+        size_t next = 0;
+        std::vector<uint8_t> bytes;
+    };
+
+    static int ENET_CALLBACK Send(void* context, const ENetAddress* address, const ENetBuffer* buffers, size_t bufferCount);
+    static int ENET_CALLBACK Receive(void* context, ENetAddress* address, ENetBuffer* buffer);
+    static void ENET_CALLBACK Destroy(void* context);
+
+    static uint64_t Key(const ENetAddress& address);
+
+    std::unordered_map<uint64_t, Endpoint*> endpoints;
+    /// next port Attach tries when none is asked for
+    uint16_t nextPort = 49152;
+};
+
+} // namespace Net
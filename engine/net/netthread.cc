@@ -0,0 +1,300 @@
+//------------------------------------------------------------------------------
+//  netthread.cc
+//  @copyright (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "config.h"
+#include "netthread.h"
+#include <algorithm>
+#include <chrono>
+
+namespace Net
+{
+
+//------------------------------------------------------------------------------
+/**
+*/
+uint64_t
+QueueTime()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+NetEvent
+ToNetEvent(const ENetEvent& event)
+{
+    NetEvent result;
+    result.type = event.type;
+    result.peer = event.peer;
+    result.packet = event.packet;
+    result.channel = event.channelID;
+    result.data = event.data;
+    result.address = event.peer->address;
+    result.roundTripTime = event.peer->roundTripTime;
+    result.packetLoss = event.peer->packetLoss;
+    result.packetThrottle = event.peer->packetThrottle;
+    result.queuedAt = QueueTime();
+    return result;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Only the consumer of a queue records into its counters, the atomics are
+    there for the other thread reading them.
+*/
+void
+NetThread::Counters::Record(uint64_t latency, uint32_t depth)
+{
+    this->items.store(this->items.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    this->totalLatency.store(this->totalLatency.load(std::memory_order_relaxed) + latency, std::memory_order_relaxed);
+    if (latency > this->maxLatency.load(std::memory_order_relaxed))
+        this->maxLatency.store(latency, std::memory_order_relaxed);
+    if (depth > this->maxDepth.load(std::memory_order_relaxed))
+        this->maxDepth.store(depth, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+NetThread::QueueStats
+NetThread::Counters::Read(uint32_t depth) const
+{
+    QueueStats stats;
+    stats.items = this->items.load(std::memory_order_relaxed);
+    stats.depth = depth;
+    stats.maxDepth = this->maxDepth.load(std::memory_order_relaxed);
+    stats.totalLatency = this->totalLatency.load(std::memory_order_relaxed);
+    stats.maxLatency = this->maxLatency.load(std::memory_order_relaxed);
+    return stats;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+NetThread::NetThread() :
+    inbound(QueueCapacity),
+    outbound(QueueCapacity)
+{
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+NetThread::~NetThread()
+{
+    this->Stop();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+NetThread::Start(ENetHost* host, Conditioner* conditioner)
+{
+    n_assert(!this->Running());
+    this->host = host;
+    this->conditioner = conditioner;
+    this->running = true;
+    this->thread = std::thread(&NetThread::Run, this);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Packets still queued are handed to ENet on the calling thread, which owns
+    the host again. Inbound events stay queued for Poll.
+*/
+void
+NetThread::Stop()
+{
+    if (!this->Running())
+        return;
+    this->running = false;
+    this->thread.join();
+
+    Outgoing item;
+    while (this->outbound.Pop(item))
+        this->Dispatch(item);
+    this->releasing.clear();
+    this->host = nullptr;
+    this->conditioner = nullptr;
+}
+
+//------------------------------------------------------------------------------
+/**
+    The game is done with a peer once it has seen its disconnect, anything it
+    sends to that peer afterwards is for a new connection.
+*/
+bool
+NetThread::Poll(NetEvent& event)
+{
+    uint32_t const depth = this->inbound.Size();
+    if (!this->inbound.Pop(event))
+        return false;
+    this->inboundCounters.Record(QueueTime() - event.queuedAt, depth);
+
+    if (event.type == ENET_EVENT_TYPE_DISCONNECT && this->Running())
+        this->PushOutgoing({ event.peer, nullptr, QueueTime(), 0, Outgoing::PeerReleased });
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+NetThread::Send(ENetPeer* peer, uint8_t channel, ENetPacket* packet)
+{
+    this->Broadcast({ &peer, 1 }, channel, packet);
+}
+
+//------------------------------------------------------------------------------
+/**
+    The packet is not shared with the network thread yet, so its reference
+    count can be raised here. The extra reference keeps ENet from freeing it
+    after the first peer sent it, while the rest are still queued.
+*/
+void
+NetThread::Broadcast(std::span<ENetPeer* const> peers, uint8_t channel, ENetPacket* packet)
+{
+    if (!this->Running())
+    {
+        for (ENetPeer* peer : peers)
+            enet_peer_send(peer, channel, packet);
+        if (packet->referenceCount == 0)
+            enet_packet_destroy(packet);
+        return;
+    }
+
+    packet->referenceCount++;
+    uint64_t const now = QueueTime();
+    for (ENetPeer* peer : peers)
+        this->PushOutgoing({ peer, packet, now, channel, Outgoing::Packet });
+    this->PushOutgoing({ nullptr, packet, now, channel, Outgoing::Release });
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+NetThread::Flush()
+{
+    if (!this->Running())
+        return;
+    this->PushOutgoing({ nullptr, nullptr, QueueTime(), 0, Outgoing::Flush });
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+NetThread::QueueStats
+NetThread::InboundStats() const
+{
+    return this->inboundCounters.Read(this->inbound.Size());
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+NetThread::QueueStats
+NetThread::OutboundStats() const
+{
+    return this->outboundCounters.Read(this->outbound.Size());
+}
+
+//------------------------------------------------------------------------------
+/**
+    The queue holds a few thousand packets, it only fills up if the network
+    thread is starved. Waiting is better than losing a reliable packet then.
+*/
+void
+NetThread::PushOutgoing(const Outgoing& item)
+{
+    while (!this->outbound.Push(item))
+        std::this_thread::yield();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+NetThread::Dispatch(const Outgoing& item)
+{
+    switch (item.kind)
+    {
+        case Outgoing::Packet:
+            if (std::find(this->releasing.begin(), this->releasing.end(), item.peer) == this->releasing.end())
+                enet_peer_send(item.peer, item.channel, item.packet);
+            break;
+        case Outgoing::Release:
+            if (--item.packet->referenceCount == 0)
+                enet_packet_destroy(item.packet);
+            break;
+        case Outgoing::Flush:
+            enet_host_flush(this->host);
+            break;
+        case Outgoing::PeerReleased:
+        {
+            auto it = std::find(this->releasing.begin(), this->releasing.end(), item.peer);
+            if (it != this->releasing.end())
+                this->releasing.erase(it);
+            break;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    While the game does not keep up and the inbound queue is full, the socket
+    is left alone and ENet buffers incoming data.
+*/
+void
+NetThread::Run()
+{
+    NetEvent pending;
+    bool hasPending = false;
+
+    while (this->running.load(std::memory_order_acquire))
+    {
+        Outgoing item;
+        // Items pushed while draining are not in depth, count them as the last one
+        uint32_t depth = this->outbound.Size();
+        while (this->outbound.Pop(item))
+        {
+            this->outboundCounters.Record(QueueTime() - item.queuedAt, depth);
+            if (depth > 1)
+                depth--;
+            this->Dispatch(item);
+        }
+
+        if (hasPending)
+        {
+            if (!this->inbound.Push(pending))
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(ServiceTimeout));
+                continue;
+            }
+            hasPending = false;
+        }
+
+        if (this->conditioner != nullptr)
+            this->conditioner->Update();
+
+        ENetEvent event;
+        int result = enet_host_service(this->host, &event, ServiceTimeout);
+        while (result > 0)
+        {
+            pending = ToNetEvent(event);
+            if (event.type == ENET_EVENT_TYPE_DISCONNECT)
+                this->releasing.push_back(event.peer);
+            if (!this->inbound.Push(pending))
+            {
+                hasPending = true;
+                break;
+            }
+            result = enet_host_check_events(this->host, &event);
+        }
+    }
+}
+
+} // namespace Net
@@ -0,0 +1,160 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @file netthread.h
+
+    @class Net::NetThread
+
+    Runs an ENetHost on its own thread. While running, the thread is the only
+    one that touches the host and its peers. It services the socket about
+    once a millisecond, independent of the game's frame or tick rate. The
+    game thread only exchanges events and packets with it through two
+    SpscQueues, so it never blocks on the socket.
+
+    Inbound events carry a copy of the peer data the game needs. Received
+    packets belong to the game, which destroys them after handling. Outbound
+    packets are handed to enet_peer_send on the network thread.
+
+    A peer slot may be reused for a new connection as soon as ENet reports
+    a disconnect. Sends to that peer are therefore dropped until the game has
+    polled the disconnect event; later sends are meant for the new connection.
+
+    Both queues count items, depth and how long items waited in them.
+
+    @copyright
+    (C) 2024 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include "spscqueue.h"
+#include "conditioner.h"
+#include "enet/enet.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <span>
+
+namespace Net
+{
+
+struct NetEvent
+{
+    ENetEventType type = ENET_EVENT_TYPE_NONE;
+    ENetPeer* peer = nullptr;
+    /// received packet, the receiver destroys it
+    ENetPacket* packet = nullptr;
+    uint8_t channel = 0;
+    enet_uint32 data = 0;
+    /// peer's address, round trip time, packet loss and throttle when the event was queued
+    ENetAddress address = {};
+    enet_uint32 roundTripTime = 0;
+    /// scaled by ENET_PEER_PACKET_LOSS_SCALE
+    enet_uint32 packetLoss = 0;
+    /// scaled by ENET_PEER_PACKET_THROTTLE_SCALE
+    enet_uint32 packetThrottle = ENET_PEER_DEFAULT_PACKET_THROTTLE;
+    /// steady clock in us
+    uint64_t queuedAt = 0;
+};
+
+class NetThread
+{
+public:
+    static constexpr uint32_t QueueCapacity = 4096;
+    /// ms the thread waits on the socket per iteration, the latency of outbound packets
+    static constexpr enet_uint32 ServiceTimeout = 1;
+
+    struct QueueStats
+    {
+        /// items that went through the queue
+        uint64_t items = 0;
+        /// queued now and most queued at once
+        uint32_t depth = 0;
+        uint32_t maxDepth = 0;
+        /// us items waited between push and pop
+        uint64_t totalLatency = 0;
+        uint64_t maxLatency = 0;
+    };
+
+    /// constructor
+    NetThread();
+    /// destructor, stops the thread
+    ~NetThread();
+
+    /// hand host over to a new thread, which also updates conditioner if it is attached to host
+    void Start(ENetHost* host, Conditioner* conditioner = nullptr);
+    /// join the thread, the host belongs to the caller again
+    void Stop();
+    /// true between Start and Stop
+    bool Running() const { return this->thread.joinable(); }
+
+    /// next inbound event, false if there is none
+    bool Poll(NetEvent& event);
+    /// queue a new packet for peer, the network thread destroys it if the send fails
+    void Send(ENetPeer* peer, uint8_t channel, ENetPacket* packet);
+    /// queue a new packet for all peers, sent as one reference counted packet
+    void Broadcast(std::span<ENetPeer* const> peers, uint8_t channel, ENetPacket* packet);
+    /// send all queued packets right away instead of at the next service
+    void Flush();
+
+    /// events from the network thread, latency until polled
+    QueueStats InboundStats() const;
+    /// packets to the network thread, latency until handed to ENet
+    QueueStats OutboundStats() const;
+
+private:
+    struct Outgoing
+    {
+        enum Kind : uint8_t
+        {
+            Packet,
+            /// drop the reference Broadcast holds while queueing
+            Release,
+            Flush,
+            /// the game saw peer disconnect, sends to it are valid again
+            PeerReleased
+        };
+
+        ENetPeer* peer;
+        ENetPacket* packet;
+        uint64_t queuedAt;
+        uint8_t channel;
+        Kind kind;
+    };
+
+    struct Counters
+    {
+        std::atomic<uint64_t> items = 0;
+        std::atomic<uint32_t> maxDepth = 0;
+        std::atomic<uint64_t> totalLatency = 0;
+        std::atomic<uint64_t> maxLatency = 0;
+
+        void Record(uint64_t latency, uint32_t depth);
+        QueueStats Read(uint32_t depth) const;
+    };
+
+    /// thread body
+    void Run();
+    /// producer side of outbound, waits while the queue is full
+    void PushOutgoing(const Outgoing& item);
+    /// hand an outbound item to ENet
+    void Dispatch(const Outgoing& item);
+
+    ENetHost* host = nullptr;
+    Conditioner* conditioner = nullptr;
+    std::thread thread;
+    std::atomic<bool> running = false;
+
+    SpscQueue<NetEvent> inbound;
+    SpscQueue<Outgoing> outbound;
+    Counters inboundCounters;
+    Counters outboundCounters;
+
+    /// network thread: peers with a disconnect the game has not polled yet
+    std::vector<ENetPeer*> releasing;
+};
+
+/// steady clock in us, the time base of the queue latencies
+uint64_t QueueTime();
+/// copy of event and the peer data it needs, for hosts serviced without a NetThread
+NetEvent ToNetEvent(const ENetEvent& event);
+
+} // namespace Net
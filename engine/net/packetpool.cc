@@ -0,0 +1,286 @@
+//------------------------------------------------------------------------------
+//  packetpool.cc
+//  @copyright (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "config.h"
+#include "packetpool.h"
+#include "enet/enet.h"
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+
+namespace Net
+{
+
+/// block sizes of the classes, including the header
+static constexpr size_t ClassSizes[] = { 64, 128, 256, 512, 1024, 2048 };
+static constexpr uint32_t ClassCount = sizeof(ClassSizes) / sizeof(ClassSizes[0]);
+/// class index of blocks that came from malloc
+static constexpr uint32_t LargeClass = ClassCount;
+/// header in front of every block, keeps the memory handed out aligned like malloc's
+static constexpr size_t HeaderSize = 16;
+static constexpr size_t SlabSize = 64 * 1024;
+/// blocks moved between a thread's and the shared lists at once
+static constexpr uint32_t BatchSize = 32;
+
+static_assert(MaxPooledSize == ClassSizes[ClassCount - 1] - HeaderSize, "MaxPooledSize has to match the largest class");
+
+struct FreeBlock
+{
+    FreeBlock* next;
+};
+
+struct SharedLists
+{
+    std::mutex mutex;
+    FreeBlock* free[ClassCount] = {};
+};
+
+/// never destroyed, threads may still free blocks while the process exits
+static SharedLists& Shared()
+{
+    static SharedLists* shared = new SharedLists;
+    return *shared;
+}
+
+static std::atomic<uint64_t> allocations = 0;
+static std::atomic<uint64_t> allocatedBytes = 0;
+static std::atomic<uint64_t> largeAllocations = 0;
+static std::atomic<uint64_t> frees = 0;
+static std::atomic<uint64_t> reservedBytes = 0;
+
+/// trivially destructible, so blocks freed by thread exit code after Flusher ran still find it
+struct ThreadCache
+{
+    FreeBlock* free[ClassCount];
+    uint32_t count[ClassCount];
+    /// Flusher was created, blocks may be cached
+    bool registered;
+    /// Flusher ran, go to the shared lists directly
+    bool exited;
+};
+static thread_local ThreadCache cache;
+
+/// returns the blocks of a thread to the shared lists when it exits
+struct Flusher
+{
+    Flusher() { cache.registered = true; }
+    ~Flusher();
+};
+static thread_local Flusher flusher;
+
+//------------------------------------------------------------------------------
+/**
+*/
+static uint32_t
+ClassOf(size_t size)
+{
+    for (uint32_t i = 0; i < ClassCount; i++)
+    {
+        if (size + HeaderSize <= ClassSizes[i])
+            return i;
+    }
+    return LargeClass;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Takes up to count blocks from the shared list of a class, carving a new
+    slab when it is empty. Returns the chain and how many it holds.
+*/
+static FreeBlock*
+TakeShared(uint32_t sizeClass, uint32_t count, uint32_t& taken)
+{
+    SharedLists& shared = Shared();
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    if (shared.free[sizeClass] == nullptr)
+    {
+        uint8_t* slab = (uint8_t*)malloc(SlabSize);
+        if (slab == nullptr)
+        {
+            taken = 0;
+            return nullptr;
+        }
+        reservedBytes.fetch_add(SlabSize, std::memory_order_relaxed);
+        size_t const blockSize = ClassSizes[sizeClass];
+        for (size_t offset = 0; offset + blockSize <= SlabSize; offset += blockSize)
+        {
+            FreeBlock* block = (FreeBlock*)(slab + offset);
+            block->next = shared.free[sizeClass];
+            shared.free[sizeClass] = block;
+        }
+    }
+
+    FreeBlock* first = shared.free[sizeClass];
+    FreeBlock* last = first;
+    taken = 1;
+    while (taken < count && last->next != nullptr)
+    {
+        last = last->next;
+        taken++;
+    }
+    shared.free[sizeClass] = last->next;
+    last->next = nullptr;
+    return first;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static void
+GiveShared(uint32_t sizeClass, FreeBlock* first, FreeBlock* last)
+{
+    SharedLists& shared = Shared();
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    last->next = shared.free[sizeClass];
+    shared.free[sizeClass] = first;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+Flusher::~Flusher()
+{
+    for (uint32_t i = 0; i < ClassCount; i++)
+    {
+        FreeBlock* first = cache.free[i];
+        if (first == nullptr)
+            continue;
+        FreeBlock* last = first;
+        while (last->next != nullptr)
+            last = last->next;
+        GiveShared(i, first, last);
+        cache.free[i] = nullptr;
+        cache.count[i] = 0;
+    }
+    cache.exited = true;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Returns null like malloc when the system is out of memory, ENet calls its
+    no_memory callback then.
+*/
+void*
+PoolMalloc(size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+
+    uint32_t const sizeClass = ClassOf(size);
+    uint8_t* block = nullptr;
+    if (sizeClass == LargeClass)
+    {
+        largeAllocations.fetch_add(1, std::memory_order_relaxed);
+        block = (uint8_t*)malloc(size + HeaderSize);
+    }
+    else
+    {
+        if (!cache.registered && !cache.exited)
+            (void)flusher;
+
+        if (cache.exited)
+        {
+            uint32_t taken;
+            block = (uint8_t*)TakeShared(sizeClass, 1, taken);
+        }
+        else
+        {
+            if (cache.free[sizeClass] == nullptr)
+                cache.free[sizeClass] = TakeShared(sizeClass, BatchSize, cache.count[sizeClass]);
+            FreeBlock* head = cache.free[sizeClass];
+            if (head != nullptr)
+            {
+                cache.free[sizeClass] = head->next;
+                cache.count[sizeClass]--;
+            }
+            block = (uint8_t*)head;
+        }
+    }
+
+    if (block == nullptr)
+        return nullptr;
+    *(uint32_t*)block = sizeClass;
+    return block + HeaderSize;
+}
+
+//------------------------------------------------------------------------------
+/**
+    A thread that frees more than it allocates, like the one destroying
+    received packets, hands a batch back once it holds two.
+*/
+void
+PoolFree(void* memory)
+{
+    if (memory == nullptr)
+        return;
+    frees.fetch_add(1, std::memory_order_relaxed);
+
+    uint8_t* const block = (uint8_t*)memory - HeaderSize;
+    uint32_t const sizeClass = *(uint32_t*)block;
+    if (sizeClass == LargeClass)
+    {
+        free(block);
+        return;
+    }
+
+    FreeBlock* const freed = (FreeBlock*)block;
+    if (!cache.registered && !cache.exited)
+        (void)flusher;
+    if (cache.exited)
+    {
+        GiveShared(sizeClass, freed, freed);
+        return;
+    }
+
+    freed->next = cache.free[sizeClass];
+    cache.free[sizeClass] = freed;
+    if (++cache.count[sizeClass] < 2 * BatchSize)
+        return;
+
+    FreeBlock* last = freed;
+    for (uint32_t i = 1; i < BatchSize; i++)
+        last = last->next;
+    cache.free[sizeClass] = last->next;
+    cache.count[sizeClass] -= BatchSize;
+    GiveShared(sizeClass, freed, last);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+PoolStats
+GetPoolStats()
+{
+    PoolStats stats;
+    stats.allocations = allocations.load(std::memory_order_relaxed);
+    stats.bytes = allocatedBytes.load(std::memory_order_relaxed);
+    stats.largeAllocations = largeAllocations.load(std::memory_order_relaxed);
+    stats.blocksInUse = stats.allocations - frees.load(std::memory_order_relaxed);
+    stats.reservedBytes = reservedBytes.load(std::memory_order_relaxed);
+    return stats;
+}
+
+//------------------------------------------------------------------------------
+/**
+    ENet keeps the callbacks of the first initialization, blocks from one
+    allocator must not reach the other's free, so later calls only succeed.
+*/
+bool
+InitializeENet()
+{
+    static bool initialized = false;
+    if (initialized)
+        return true;
+
+    ENetCallbacks callbacks = {};
+    callbacks.malloc = PoolMalloc;
+    callbacks.free = PoolFree;
+    if (enet_initialize_with_callbacks(ENET_VERSION, &callbacks) != 0)
+        return false;
+    atexit(enet_deinitialize);
+    initialized = true;
+    return true;
+}
+
+} // namespace Net
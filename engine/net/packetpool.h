@@ -0,0 +1,55 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @file packetpool.h
+
+    Allocator that ENet is initialized with. ENet allocates a packet, a
+    command and often a fragment buffer for every message and frees them as
+    soon as they are acknowledged or handed to the game, thousands of small
+    blocks per second on a busy server. Requests up to MaxPooledSize bytes
+    are served from power of two size classes carved out of 64 kB slabs
+    instead, larger ones such as hosts and peer arrays go to malloc.
+
+    Every thread keeps a short free list per size class and only takes the
+    lock of the shared lists to move a batch of blocks in or out, so a block
+    may be freed on another thread than the one that allocated it, as the
+    network thread and the simulation do with packets. Slabs are never
+    returned to the system.
+
+    @copyright
+    (C) 2024 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include <stdint.h>
+#include <stddef.h>
+
+namespace Net
+{
+
+/// largest request served from the pool, in bytes
+static constexpr size_t MaxPooledSize = 2048 - 16;
+
+struct PoolStats
+{
+    /// PoolMalloc calls and bytes requested since process start
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+    /// of those, the ones too large for the pool
+    uint64_t largeAllocations = 0;
+    /// blocks handed out and not freed yet, large ones included
+    uint64_t blocksInUse = 0;
+    /// bytes of slabs allocated for the size classes
+    uint64_t reservedBytes = 0;
+};
+
+/// ENet allocation callbacks, see ENetCallbacks
+void* PoolMalloc(size_t size);
+void PoolFree(void* memory);
+
+/// totals since process start
+PoolStats GetPoolStats();
+
+/// initialize ENet with the pool as its allocator and deinitialize it at exit, false if ENet failed
+bool InitializeENet();
+
+} // namespace Net
@@ -0,0 +1,83 @@
+//------------------------------------------------------------------------------
+//  priority.cc
+//  @copyright (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "config.h"
+#include "priority.h"
+#include <algorithm>
+
+namespace Net
+{
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+PriorityAccumulator::Begin()
+{
+    this->round++;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+PriorityAccumulator::Add(uint32_t id, float priority, uint32_t cost)
+{
+    auto it = std::lower_bound(this->entries.begin(), this->entries.end(), id, [](const Entry& e, uint32_t value) {
+        return e.id < value;
+    });
+    if (it == this->entries.end() || it->id != id)
+        it = this->entries.insert(it, { id, 0, 0.0f, 0.0f, 0 });
+    it->cost = cost;
+    it->priority = priority;
+    it->round = this->round;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Entries that were not added since Begin belong to entities that are gone
+    or no longer candidates, and are dropped along with what they accumulated.
+    A candidate that does not fit is skipped, smaller ones behind it may still.
+*/
+uint32_t
+PriorityAccumulator::Select(uint32_t budget, std::vector<uint32_t>& out)
+{
+    uint64_t const round = this->round;
+    this->entries.erase(std::remove_if(this->entries.begin(), this->entries.end(), [round](const Entry& e) { return e.round != round; }), this->entries.end());
+
+    this->order.clear();
+    for (uint32_t i = 0; i < (uint32_t)this->entries.size(); i++)
+    {
+        this->entries[i].accumulated += this->entries[i].priority;
+        this->order.push_back(i);
+    }
+    // Ties go to the lower id, entries are sorted by id
+    std::stable_sort(this->order.begin(), this->order.end(), [this](uint32_t a, uint32_t b) {
+        return this->entries[a].accumulated > this->entries[b].accumulated;
+    });
+
+    uint32_t used = 0;
+    for (uint32_t i : this->order)
+    {
+        Entry& entry = this->entries[i];
+        if (used + entry.cost > budget)
+            continue;
+        used += entry.cost;
+        entry.accumulated = 0.0f;
+        out.push_back(entry.id);
+    }
+    return used;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+PriorityAccumulator::Clear()
+{
+    this->entries.clear();
+    this->order.clear();
+}
+
+} // namespace Net
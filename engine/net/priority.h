@@ -0,0 +1,57 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @file priority.h
+
+    @class Net::PriorityAccumulator
+
+    Decides which entity updates go into a peer's next packet when not all of
+    them fit its byte budget. Every tick each candidate adds its priority to
+    what it accumulated while it was not sent, then the candidates are taken
+    by accumulated priority for as long as they fit. A sent candidate starts
+    over from zero.
+
+    High priorities are sent nearly every tick, low ones wait until they have
+    accumulated enough, so nothing starves and the rate of each entity is
+    proportional to its priority once the budget is tight.
+
+    @copyright
+    (C) 2024 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include <vector>
+
+namespace Net
+{
+
+class PriorityAccumulator
+{
+public:
+    /// start collecting the candidates of a tick
+    void Begin();
+    /// id competes this tick with priority, sending it costs bytes
+    void Add(uint32_t id, float priority, uint32_t cost);
+    /// append the ids that fit into budget bytes to out, highest accumulated first, returns the bytes used
+    uint32_t Select(uint32_t budget, std::vector<uint32_t>& out);
+    /// forget all accumulated priorities
+    void Clear();
+
+private:
+    struct Entry
+    {
+        uint32_t id;
+        uint32_t cost;
+        float priority;
+        float accumulated;
+        /// Begin count of the last Add, older entries are gone
+        uint64_t round;
+    };
+
+    /// sorted by id
+    std::vector<Entry> entries;
+    /// scratch for Select, indices into entries
+    std::vector<uint32_t> order;
+    uint64_t round = 0;
+};
+
+} // namespace Net
@@ -0,0 +1,205 @@
+//------------------------------------------------------------------------------
+//  quantize.cc
+//  @copyright (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "config.h"
+#include "quantize.h"
+#include "gtc/packing.hpp"
+#include <cmath>
+
+namespace Net
+{
+
+/// range of the three smallest components of a unit quaternion
+static const float QuaternionComponentBound = 0.70710678f;
+
+//------------------------------------------------------------------------------
+/**
+    Computed in double, a float mantissa can not hold 24 bit steps over the
+    full range without rounding.
+*/
+uint32_t
+QuantizeFloat(float value, float min, float max, int bits)
+{
+    double const steps = (double)((1u << bits) - 1);
+    double const t = ((double)glm::clamp(value, min, max) - min) / ((double)max - min);
+    return (uint32_t)(t * steps + 0.5);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+float
+DequantizeFloat(uint32_t value, float min, float max, int bits)
+{
+    double const steps = (double)((1u << bits) - 1);
+    return (float)(min + ((double)max - min) * ((double)value / steps));
+}
+
+//------------------------------------------------------------------------------
+/**
+    q and -q are the same rotation, so the quaternion is flipped to make the
+    dropped component positive and its sign does not have to be sent.
+*/
+uint32_t
+CompressQuaternion(const glm::quat& q)
+{
+    glm::quat const n = glm::normalize(q);
+    float const c[4] = { n.x, n.y, n.z, n.w };
+
+    uint32_t largest = 0;
+    for (uint32_t i = 1; i < 4; i++)
+        if (std::fabs(c[i]) > std::fabs(c[largest]))
+            largest = i;
+    float const sign = (c[largest] < 0.0f) ? -1.0f : 1.0f;
+
+    uint32_t packed = largest;
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        if (i == largest)
+            continue;
+        packed = (packed << QuaternionComponentBits) | QuantizeFloat(c[i] * sign, -QuaternionComponentBound, QuaternionComponentBound, QuaternionComponentBits);
+    }
+    return packed;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+glm::quat
+DecompressQuaternion(uint32_t packed)
+{
+    uint32_t const mask = (1u << QuaternionComponentBits) - 1;
+    uint32_t const largest = packed >> (QuaternionComponentBits * 3);
+
+    float c[4];
+    float sum = 0.0f;
+    int shift = QuaternionComponentBits * 2;
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        if (i == largest)
+            continue;
+        c[i] = DequantizeFloat((packed >> shift) & mask, -QuaternionComponentBound, QuaternionComponentBound, QuaternionComponentBits);
+        sum += c[i] * c[i];
+        shift -= QuaternionComponentBits;
+    }
+    c[largest] = std::sqrt(std::fmax(0.0f, 1.0f - sum));
+    return glm::normalize(glm::quat(c[3], c[0], c[1], c[2]));
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+WritePosition(ByteWriter& writer, const glm::vec3& position)
+{
+    for (int i = 0; i < 3; i++)
+        writer.WriteU24(QuantizeFloat(position[i], -PositionBound, PositionBound, PositionBits));
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+glm::vec3
+ReadPosition(ByteReader& reader)
+{
+    glm::vec3 position;
+    for (int i = 0; i < 3; i++)
+        position[i] = DequantizeFloat(reader.ReadU24(), -PositionBound, PositionBound, PositionBits);
+    return position;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+glm::vec3
+SnapPosition(const glm::vec3& position)
+{
+    glm::vec3 snapped;
+    for (int i = 0; i < 3; i++)
+        snapped[i] = DequantizeFloat(QuantizeFloat(position[i], -PositionBound, PositionBound, PositionBits), -PositionBound, PositionBound, PositionBits);
+    return snapped;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+WriteHalfVec3(ByteWriter& writer, const glm::vec3& v)
+{
+    for (int i = 0; i < 3; i++)
+        writer.WriteU16(glm::packHalf1x16(v[i]));
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+glm::vec3
+ReadHalfVec3(ByteReader& reader)
+{
+    glm::vec3 v;
+    for (int i = 0; i < 3; i++)
+        v[i] = glm::unpackHalf1x16(reader.ReadU16());
+    return v;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+glm::vec3
+SnapHalfVec3(const glm::vec3& v)
+{
+    glm::vec3 snapped;
+    for (int i = 0; i < 3; i++)
+        snapped[i] = glm::unpackHalf1x16(glm::packHalf1x16(v[i]));
+    return snapped;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+WriteQuaternion(ByteWriter& writer, const glm::quat& q)
+{
+    writer.WriteU32(CompressQuaternion(q));
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+glm::quat
+ReadQuaternion(ByteReader& reader)
+{
+    return DecompressQuaternion(reader.ReadU32());
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+glm::quat
+SnapQuaternion(const glm::quat& q)
+{
+    return DecompressQuaternion(CompressQuaternion(q));
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+WriteTimeOffset(ByteWriter& writer, uint64_t time, uint64_t baseTime)
+{
+    int64_t const offset = glm::clamp<int64_t>((int64_t)(time - baseTime), INT16_MIN, INT16_MAX);
+    writer.WriteU16((uint16_t)(int16_t)offset);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+uint64_t
+ReadTimeOffset(ByteReader& reader, uint64_t baseTime)
+{
+    int16_t const offset = (int16_t)reader.ReadU16();
+    return baseTime + (int64_t)offset;
+}
+
+} // namespace Net
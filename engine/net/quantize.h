@@ -0,0 +1,58 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @file quantize.h
+
+    Lossy compact encodings for replicated state.
+
+    - positions: 24 bit fixed point per axis within +-PositionBound, ~0.25mm steps
+    - velocity, acceleration: half precision floats
+    - orientation: smallest three, the largest component is dropped and
+      rebuilt from the unit length, the other three get 10 bits each
+    - timestamps: 16 bit millisecond offsets from the time of the packet
+
+    Every Write has a matching Snap that returns the value exactly as the
+    matching Read will reconstruct it. The server snaps the state it keeps as
+    delta baselines so its comparisons match what clients see.
+
+    @copyright
+    (C) 2024 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include "bytestream.h"
+
+namespace Net
+{
+
+/// positions are clamped to +-PositionBound on every axis
+constexpr float PositionBound = 2048.0f;
+constexpr int PositionBits = 24;
+constexpr int QuaternionComponentBits = 10;
+
+/// map value in [min, max] to an unsigned integer of bits width, values outside are clamped
+uint32_t QuantizeFloat(float value, float min, float max, int bits);
+/// inverse of QuantizeFloat
+float DequantizeFloat(uint32_t value, float min, float max, int bits);
+
+/// smallest three quaternion compression into 2 + 3 * 10 bits
+uint32_t CompressQuaternion(const glm::quat& q);
+/// inverse of CompressQuaternion, returns a unit quaternion
+glm::quat DecompressQuaternion(uint32_t packed);
+
+void WritePosition(ByteWriter& writer, const glm::vec3& position);
+glm::vec3 ReadPosition(ByteReader& reader);
+glm::vec3 SnapPosition(const glm::vec3& position);
+
+void WriteHalfVec3(ByteWriter& writer, const glm::vec3& v);
+glm::vec3 ReadHalfVec3(ByteReader& reader);
+glm::vec3 SnapHalfVec3(const glm::vec3& v);
+
+void WriteQuaternion(ByteWriter& writer, const glm::quat& q);
+glm::quat ReadQuaternion(ByteReader& reader);
+glm::quat SnapQuaternion(const glm::quat& q);
+
+/// time as a signed millisecond offset from baseTime, clamped to +-32s
+void WriteTimeOffset(ByteWriter& writer, uint64_t time, uint64_t baseTime);
+uint64_t ReadTimeOffset(ByteReader& reader, uint64_t baseTime);
+
+} // namespace Net
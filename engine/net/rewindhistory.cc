@@ -0,0 +1,119 @@
+//------------------------------------------------------------------------------
+//  rewindhistory.cc
+//  @copyright (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "config.h"
+#include "rewindhistory.h"
+#include <algorithm>
+
+namespace Net
+{
+
+//------------------------------------------------------------------------------
+/**
+*/
+const glm::vec3*
+RewindHistory::Frame::Find(uint32_t id) const
+{
+    auto it = std::lower_bound(this->ids.begin(), this->ids.end(), id);
+    if (it == this->ids.end() || *it != id)
+        return nullptr;
+    return &this->positions[it - this->ids.begin()];
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+RewindHistory::Begin(uint64_t tick, uint64_t time)
+{
+    n_assert(this->recording == nullptr);
+    Frame& frame = this->frames[tick % Size];
+    frame.tick = tick;
+    frame.time = time;
+    frame.ids.clear();
+    frame.positions.clear();
+    this->recording = &frame;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+RewindHistory::Add(uint32_t id, const glm::vec3& position)
+{
+    n_assert(this->recording != nullptr);
+    this->recording->ids.push_back(id);
+    this->recording->positions.push_back(position);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Sorts an index permutation and gathers both arrays through it, the
+    scratch arrays are swapped in so no allocation is made once warmed up.
+*/
+void
+RewindHistory::End()
+{
+    n_assert(this->recording != nullptr);
+    Frame& frame = *this->recording;
+    this->recording = nullptr;
+
+    this->order.resize(frame.ids.size());
+    for (uint32_t i = 0; i < (uint32_t)this->order.size(); i++)
+        this->order[i] = i;
+    std::sort(this->order.begin(), this->order.end(), [&frame](uint32_t a, uint32_t b) {
+        return frame.ids[a] < frame.ids[b];
+    });
+
+    this->sortedIds.clear();
+    this->sortedPositions.clear();
+    for (uint32_t i : this->order)
+    {
+        this->sortedIds.push_back(frame.ids[i]);
+        this->sortedPositions.push_back(frame.positions[i]);
+    }
+    std::swap(frame.ids, this->sortedIds);
+    std::swap(frame.positions, this->sortedPositions);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Times older than the history are clamped to the oldest frame, which bounds
+    how far a lookup can rewind.
+*/
+const RewindHistory::Frame*
+RewindHistory::Find(uint64_t time) const
+{
+    const Frame* nearest = nullptr;
+    uint64_t nearestDistance = UINT64_MAX;
+    for (const Frame& frame : this->frames)
+    {
+        if (frame.tick == 0 || &frame == this->recording)
+            continue;
+        uint64_t const distance = (frame.time > time) ? frame.time - time : time - frame.time;
+        if (distance < nearestDistance)
+        {
+            nearest = &frame;
+            nearestDistance = distance;
+        }
+    }
+    return nearest;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+RewindHistory::Clear()
+{
+    for (Frame& frame : this->frames)
+    {
+        frame.tick = 0;
+        frame.ids.clear();
+        frame.positions.clear();
+    }
+    this->recording = nullptr;
+}
+
+} // namespace Net
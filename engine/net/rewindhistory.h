@@ -0,0 +1,66 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @file rewindhistory.h
+
+    @class Net::RewindHistory
+
+    Past entity positions for lag compensation. The server records every
+    entity once per tick and can look up where an entity was at an earlier
+    time, to judge a hit against the world the shooter was looking at.
+
+    Each frame stores its entities as parallel id and position arrays sorted by
+    id, so a lookup is a binary search over packed uint32s and the frames
+    reuse their allocations when the ring wraps. Memory is bounded by Size
+    frames of the largest entity count seen.
+
+    @copyright
+    (C) 2024 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include <vector>
+
+namespace Net
+{
+
+class RewindHistory
+{
+public:
+    static constexpr uint64_t Size = 32;
+
+    struct Frame
+    {
+        uint64_t tick = 0;
+        uint64_t time = 0;
+        /// sorted
+        std::vector<uint32_t> ids;
+        /// position of ids[i]
+        std::vector<glm::vec3> positions;
+
+        /// position of id in this frame, nullptr if it was not recorded
+        const glm::vec3* Find(uint32_t id) const;
+    };
+
+    /// start recording tick, overwriting the frame recorded Size ticks ago
+    void Begin(uint64_t tick, uint64_t time);
+    /// record an entity, in any order
+    void Add(uint32_t id, const glm::vec3& position);
+    /// sort the recorded entities, call after the last Add
+    void End();
+
+    /// frame recorded nearest to time, nullptr if nothing was recorded
+    const Frame* Find(uint64_t time) const;
+    /// forget all frames
+    void Clear();
+
+private:
+    Frame frames[Size];
+    Frame* recording = nullptr;
+
+    /// scratch space for End
+    std::vector<uint32_t> order;
+    std::vector<uint32_t> sortedIds;
+    std::vector<glm::vec3> sortedPositions;
+};
+
+} // namespace Net
@@ -0,0 +1,62 @@
+//------------------------------------------------------------------------------
+//  shipmovement.cc
+//  @copyright (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "config.h"
+#include "shipmovement.h"
+#include <algorithm>
+
+using namespace glm;
+
+namespace Net
+{
+
+//------------------------------------------------------------------------------
+/**
+*/
+vec3
+StepShip(ShipMovement& ship, uint16_t bitmap, float dt)
+{
+    if (bitmap & (1 << 0))  // 'W' is bit 0
+    {
+        if (bitmap & (1 << 8))  // 'Shift' is bit 8
+            ship.currentSpeed = mix(ship.currentSpeed, ShipMovement::boostSpeed, std::min(1.0f, dt * 30.0f));
+        else
+            ship.currentSpeed = mix(ship.currentSpeed, ShipMovement::normalSpeed, std::min(1.0f, dt * 90.0f));
+    }
+    else
+    {
+        ship.currentSpeed = 0;
+    }
+
+    vec3 desiredVelocity = vec3(0, 0, ship.currentSpeed);
+    desiredVelocity = ship.transform * vec4(desiredVelocity, 0.0f);
+
+    ship.linearVelocity = mix(ship.linearVelocity, desiredVelocity, dt * ShipMovement::accelerationFactor);
+
+    vec3 acceleration = (desiredVelocity - ship.linearVelocity) * ShipMovement::accelerationFactor;
+
+    // Rotation calculations using bitmap
+    float rotX = (bitmap & (1 << 5)) ? 1.0f : (bitmap & (1 << 6)) ? -1.0f : 0.0f;  // Left and Right
+    float rotY = (bitmap & (1 << 3)) ? -1.0f : (bitmap & (1 << 4)) ? 1.0f : 0.0f;   // Up and Down
+    float rotZ = (bitmap & (1 << 1)) ? -1.0f : (bitmap & (1 << 2)) ? 1.0f : 0.0f;   // A and D
+
+    ship.position += ship.linearVelocity * dt * ShipMovement::velocityScale;
+
+    const float rotationSpeed = 1.8f * dt;
+    const float smoothing = dt * ShipMovement::rotationSmoothFactor;
+    ship.rotXSmooth = mix(ship.rotXSmooth, rotX * rotationSpeed, smoothing);
+    ship.rotYSmooth = mix(ship.rotYSmooth, rotY * rotationSpeed, smoothing);
+    ship.rotZSmooth = mix(ship.rotZSmooth, rotZ * rotationSpeed, smoothing);
+    quat localOrientation = quat(vec3(-ship.rotYSmooth, ship.rotXSmooth, ship.rotZSmooth));
+    ship.orientation = ship.orientation * localOrientation;
+    ship.rotationZ -= ship.rotXSmooth;
+    ship.rotationZ = clamp(ship.rotationZ, -45.0f, 45.0f);
+    mat4 T = translate(ship.position) * (mat4)ship.orientation;
+    ship.transform = T * (mat4)quat(vec3(0, 0, ship.rotationZ));
+    ship.rotationZ = mix(ship.rotationZ, 0.0f, smoothing);
+
+    return acceleration;
+}
+
+} // namespace Net
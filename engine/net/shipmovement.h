@@ -0,0 +1,48 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @file shipmovement.h
+
+    @struct Net::ShipMovement
+
+    Ship movement shared by the server simulation and client side prediction.
+    Both sides must step ships with exactly this code, otherwise every
+    prediction drifts and has to be corrected.
+
+    Input bitmap bits: 0 W, 1 A, 2 D, 3 Up, 4 Down, 5 Left, 6 Right, 7 Space
+    (fire), 8 Shift (boost).
+
+    @copyright
+    (C) 2024 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+
+namespace Net
+{
+
+struct ShipMovement
+{
+    static constexpr float normalSpeed = 1.0f;
+    static constexpr float boostSpeed = normalSpeed * 2.0f;
+    static constexpr float accelerationFactor = 1.0f;
+    static constexpr float rotationSmoothFactor = 10.0f;
+    /// position advances by linearVelocity * velocityScale per second
+    static constexpr float velocityScale = 10.0f;
+
+    glm::vec3 position = glm::vec3(0);
+    glm::quat orientation = glm::identity<glm::quat>();
+    glm::mat4 transform = glm::mat4(1);
+    glm::vec3 linearVelocity = glm::vec3(0);
+
+    float currentSpeed = 0.0f;
+
+    float rotationZ = 0;
+    float rotXSmooth = 0;
+    float rotYSmooth = 0;
+    float rotZSmooth = 0;
+};
+
+/// advance ship by one step of dt with the input bitmap, returns the acceleration
+glm::vec3 StepShip(ShipMovement& ship, uint16_t bitmap, float dt);
+
+} // namespace Net
@@ -0,0 +1,351 @@
+//------------------------------------------------------------------------------
+//  snapshot.cc
+//  @copyright (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "config.h"
+#include "snapshot.h"
+#include "bytestream.h"
+#include "quantize.h"
+#include <algorithm>
+
+namespace Net
+{
+
+//------------------------------------------------------------------------------
+/**
+*/
+const PlayerState*
+Snapshot::Find(uint32_t uuid) const
+{
+    auto it = std::lower_bound(this->players.begin(), this->players.end(), uuid, [](const PlayerState& p, uint32_t id) {
+        return p.uuid < id;
+    });
+    if (it != this->players.end() && it->uuid == uuid)
+        return &(*it);
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+Snapshot&
+SnapshotHistory::Store(uint64_t tick)
+{
+    Snapshot& entry = this->entries[tick % Size];
+    entry.tick = tick;
+    entry.players.clear();
+    return entry;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+const Snapshot*
+SnapshotHistory::Find(uint64_t tick) const
+{
+    const Snapshot& entry = this->entries[tick % Size];
+    if (tick != 0 && entry.tick == tick)
+        return &entry;
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+SnapshotHistory::Clear()
+{
+    for (Snapshot& entry : this->entries)
+    {
+        entry.tick = 0;
+        entry.players.clear();
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    Fields are compared bitwise, the simulation is deterministic so an
+    unchanged field has exactly the same bits.
+*/
+static uint8_t
+ChangedFields(const PlayerState& a, const PlayerState& b)
+{
+    uint8_t mask = 0;
+    if (memcmp(&a.position, &b.position, sizeof(a.position)) != 0) mask |= PlayerField_Position;
+    if (memcmp(&a.velocity, &b.velocity, sizeof(a.velocity)) != 0) mask |= PlayerField_Velocity;
+    if (memcmp(&a.acceleration, &b.acceleration, sizeof(a.acceleration)) != 0) mask |= PlayerField_Acceleration;
+    if (memcmp(&a.direction, &b.direction, sizeof(a.direction)) != 0) mask |= PlayerField_Direction;
+    return mask;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static void
+WriteFields(ByteWriter& writer, const PlayerState& player, uint8_t mask, Encoding encoding)
+{
+    if (encoding == Encoding::Quantized)
+    {
+        if (mask & PlayerField_Position) WritePosition(writer, player.position);
+        if (mask & PlayerField_Velocity) WriteHalfVec3(writer, player.velocity);
+        if (mask & PlayerField_Acceleration) WriteHalfVec3(writer, player.acceleration);
+        if (mask & PlayerField_Direction) WriteQuaternion(writer, player.direction);
+        return;
+    }
+
+    // layout matches the raw memory of the fields, all floats
+    if (mask & PlayerField_Position) writer.WriteBytes(&player.position, sizeof(player.position));
+    if (mask & PlayerField_Velocity) writer.WriteBytes(&player.velocity, sizeof(player.velocity));
+    if (mask & PlayerField_Acceleration) writer.WriteBytes(&player.acceleration, sizeof(player.acceleration));
+    if (mask & PlayerField_Direction) writer.WriteBytes(&player.direction, sizeof(player.direction));
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static void
+ReadFields(ByteReader& reader, PlayerState& player, uint8_t mask, Encoding encoding)
+{
+    if (encoding == Encoding::Quantized)
+    {
+        if (mask & PlayerField_Position) player.position = ReadPosition(reader);
+        if (mask & PlayerField_Velocity) player.velocity = ReadHalfVec3(reader);
+        if (mask & PlayerField_Acceleration) player.acceleration = ReadHalfVec3(reader);
+        if (mask & PlayerField_Direction) player.direction = ReadQuaternion(reader);
+        return;
+    }
+
+    if (mask & PlayerField_Position) reader.ReadBytes(&player.position, sizeof(player.position));
+    if (mask & PlayerField_Velocity) reader.ReadBytes(&player.velocity, sizeof(player.velocity));
+    if (mask & PlayerField_Acceleration) reader.ReadBytes(&player.acceleration, sizeof(player.acceleration));
+    if (mask & PlayerField_Direction) reader.ReadBytes(&player.direction, sizeof(player.direction));
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+QuantizePlayerState(PlayerState& player)
+{
+    player.position = SnapPosition(player.position);
+    player.velocity = SnapHalfVec3(player.velocity);
+    player.acceleration = SnapHalfVec3(player.acceleration);
+    player.direction = SnapQuaternion(player.direction);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+WriteSnapshotDelta(const Snapshot* baseline, const Snapshot& current, Encoding encoding, std::vector<uint8_t>& out)
+{
+    ByteWriter writer(out);
+    static const Snapshot empty;
+    if (baseline == nullptr)
+        baseline = &empty;
+
+    // players in the baseline that are gone now
+    uint64_t removed = 0;
+    for (const PlayerState& old : baseline->players)
+        if (current.Find(old.uuid) == nullptr)
+            removed++;
+
+    writer.WriteVarUint(removed);
+    for (const PlayerState& old : baseline->players)
+        if (current.Find(old.uuid) == nullptr)
+            writer.WriteVarUint(old.uuid);
+
+    // count first so the decoder knows how many entries follow
+    uint64_t changed = 0;
+    for (const PlayerState& player : current.players)
+    {
+        const PlayerState* old = baseline->Find(player.uuid);
+        if (old == nullptr || ChangedFields(*old, player) != 0)
+            changed++;
+    }
+
+    writer.WriteVarUint(changed);
+    for (const PlayerState& player : current.players)
+    {
+        const PlayerState* old = baseline->Find(player.uuid);
+        uint8_t const mask = (old == nullptr) ? (uint8_t)PlayerField_All : ChangedFields(*old, player);
+        if (mask == 0)
+            continue;
+
+        writer.WriteVarUint(player.uuid);
+        writer.WriteU8(mask);
+        WriteFields(writer, player, mask, encoding);
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+    out may not alias baseline.
+*/
+bool
+ReadSnapshotDelta(const Snapshot* baseline, const uint8_t* data, size_t size, Encoding encoding, Snapshot& out)
+{
+    n_assert(baseline != &out);
+    ByteReader reader(data, size);
+
+    out.players.clear();
+    if (baseline != nullptr)
+        out.players = baseline->players;
+
+    uint64_t const removed = reader.ReadVarUint();
+    for (uint64_t i = 0; i < removed && reader.Ok(); i++)
+    {
+        uint32_t const uuid = (uint32_t)reader.ReadVarUint();
+        auto it = std::find_if(out.players.begin(), out.players.end(), [uuid](const PlayerState& p) { return p.uuid == uuid; });
+        if (it != out.players.end())
+            out.players.erase(it);
+    }
+
+    uint64_t const changed = reader.ReadVarUint();
+    for (uint64_t i = 0; i < changed && reader.Ok(); i++)
+    {
+        uint32_t const uuid = (uint32_t)reader.ReadVarUint();
+        uint8_t const mask = reader.ReadU8();
+
+        auto it = std::lower_bound(out.players.begin(), out.players.end(), uuid, [](const PlayerState& p, uint32_t id) {
+            return p.uuid < id;
+        });
+        if (it == out.players.end() || it->uuid != uuid)
+        {
+            PlayerState player;
+            player.uuid = uuid;
+            it = out.players.insert(it, player);
+        }
+
+        ReadFields(reader, *it, mask, encoding);
+    }
+
+    return reader.Ok() && reader.AtEnd();
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+void
+WritePlayerStates(const std::vector<PlayerState>& players, Encoding encoding, std::vector<uint8_t>& out)
+{
+    ByteWriter writer(out);
+    writer.WriteVarUint(players.size());
+    for (const PlayerState& player : players)
+    {
+        writer.WriteVarUint(player.uuid);
+        WriteFields(writer, player, PlayerField_All, encoding);
+    }
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+static size_t
+VarUintSize(uint64_t value)
+{
+    size_t size = 1;
+    for (uint64_t rest = value >> 7; rest != 0; rest >>= 7)
+        size++;
+    return size;
+}
+
+//------------------------------------------------------------------------------
+/**
+    Quantized fields are a 24 bit position, two half vectors and a smallest
+    three quaternion.
+*/
+static size_t
+FieldsSize(uint8_t mask, Encoding encoding)
+{
+    bool const quantized = encoding == Encoding::Quantized;
+    size_t size = 0;
+    if (mask & PlayerField_Position) size += quantized ? 9 : sizeof(PlayerState::position);
+    if (mask & PlayerField_Velocity) size += quantized ? 6 : sizeof(PlayerState::velocity);
+    if (mask & PlayerField_Acceleration) size += quantized ? 6 : sizeof(PlayerState::acceleration);
+    if (mask & PlayerField_Direction) size += quantized ? 4 : sizeof(PlayerState::direction);
+    return size;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+size_t
+PlayerStateSize(uint32_t uuid, Encoding encoding)
+{
+    return VarUintSize(uuid) + FieldsSize(PlayerField_All, encoding);
+}
+
+//------------------------------------------------------------------------------
+/**
+    Matches what WriteSnapshotDelta writes, the uuid, the field mask and the
+    changed fields.
+*/
+size_t
+PlayerDeltaSize(const PlayerState* baseline, const PlayerState& player, Encoding encoding)
+{
+    uint8_t const mask = (baseline == nullptr) ? (uint8_t)PlayerField_All : ChangedFields(*baseline, player);
+    if (mask == 0)
+        return 0;
+    return VarUintSize(player.uuid) + 1 + FieldsSize(mask, encoding);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+size_t
+RemovedPlayerSize(uint32_t uuid)
+{
+    return VarUintSize(uuid);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+ReadPlayerStates(const uint8_t* data, size_t size, Encoding encoding, std::vector<PlayerState>& out)
+{
+    ByteReader reader(data, size);
+    uint64_t const count = reader.ReadVarUint();
+    for (uint64_t i = 0; i < count && reader.Ok(); i++)
+    {
+        PlayerState player;
+        player.uuid = (uint32_t)reader.ReadVarUint();
+        ReadFields(reader, player, PlayerField_All, encoding);
+        out.push_back(player);
+    }
+    return reader.Ok() && reader.AtEnd();
+}
+
+//------------------------------------------------------------------------------
+/**
+    The end time is written relative to the start time, lasers live for
+    seconds so both offsets fit.
+*/
+void
+WriteLaserState(const LaserState& laser, uint64_t baseTime, std::vector<uint8_t>& out)
+{
+    ByteWriter writer(out);
+    writer.WriteVarUint(laser.uuid);
+    WriteTimeOffset(writer, laser.startTime, baseTime);
+    WriteTimeOffset(writer, laser.endTime, laser.startTime);
+    WritePosition(writer, laser.origin);
+    WriteQuaternion(writer, laser.direction);
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+bool
+ReadLaserState(const uint8_t* data, size_t size, uint64_t baseTime, LaserState& out)
+{
+    ByteReader reader(data, size);
+    out.uuid = (uint32_t)reader.ReadVarUint();
+    out.startTime = ReadTimeOffset(reader, baseTime);
+    out.endTime = ReadTimeOffset(reader, out.startTime);
+    out.origin = ReadPosition(reader);
+    out.direction = ReadQuaternion(reader);
+    return reader.Ok() && reader.AtEnd();
+}
+
+} // namespace Net
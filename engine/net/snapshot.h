@@ -0,0 +1,124 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @file snapshot.h
+
+    World snapshots and their delta encoding.
+
+    A snapshot is the replicated state of all players at one server tick. The
+    server keeps a short history of what it sent to each client, and encodes
+    every new snapshot as a delta against the newest one the client has
+    acknowledged. Players whose state did not change are omitted, changed
+    players only carry the fields that differ, marked by a bitmask.
+
+    Encoded layout, all integers are LEB128 varints:
+        removedCount, removedCount * uuid
+        changedCount, changedCount * (uuid, u8 fieldMask, fields in mask order)
+
+    Uuids are written in ascending order. With Encoding::Quantized the fields
+    use the compact formats from quantize.h, 25 instead of 52 bytes for a full
+    player.
+
+    @copyright
+    (C) 2024 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include <vector>
+
+namespace Net
+{
+
+/// Replicated state of a single player
+struct PlayerState
+{
+    uint32_t uuid = 0;
+    glm::vec3 position = glm::vec3(0);
+    glm::vec3 velocity = glm::vec3(0);
+    glm::vec3 acceleration = glm::vec3(0);
+    glm::quat direction = glm::identity<glm::quat>();
+};
+
+/// Bits of the per player field mask
+enum PlayerField : uint8_t
+{
+    PlayerField_Position = 1 << 0,
+    PlayerField_Velocity = 1 << 1,
+    PlayerField_Acceleration = 1 << 2,
+    PlayerField_Direction = 1 << 3,
+    PlayerField_All = 0x0F
+};
+
+/// Replicated state of a laser, sent once when it spawns
+struct LaserState
+{
+    uint32_t uuid = 0;
+    uint64_t startTime = 0;
+    uint64_t endTime = 0;
+    glm::vec3 origin = glm::vec3(0);
+    glm::quat direction = glm::identity<glm::quat>();
+};
+
+/// Wire format of the state fields
+enum class Encoding : uint8_t
+{
+    Raw,        ///< 32 bit floats
+    Quantized   ///< formats from quantize.h
+};
+
+/// Replicated world state at one tick
+struct Snapshot
+{
+    uint64_t tick = 0;
+    /// sorted by uuid
+    std::vector<PlayerState> players;
+
+    /// binary search for a player, nullptr if not in the snapshot
+    const PlayerState* Find(uint32_t uuid) const;
+};
+
+//------------------------------------------------------------------------------
+/**
+    Fixed size ring of recent snapshots, indexed by tick.
+    Entries keep their allocations when overwritten.
+*/
+class SnapshotHistory
+{
+public:
+    static constexpr uint64_t Size = 32;
+
+    /// get a cleared entry for tick, overwriting whatever was stored Size ticks ago
+    Snapshot& Store(uint64_t tick);
+    /// find snapshot of tick, nullptr if it was never stored or has been overwritten
+    const Snapshot* Find(uint64_t tick) const;
+    /// forget all entries
+    void Clear();
+
+private:
+    Snapshot entries[Size];
+};
+
+/// Round player to the values a client reconstructs from the quantized encoding
+void QuantizePlayerState(PlayerState& player);
+
+/// Append current encoded against baseline to out. Pass nullptr as baseline for a full snapshot.
+void WriteSnapshotDelta(const Snapshot* baseline, const Snapshot& current, Encoding encoding, std::vector<uint8_t>& out);
+/// Reconstruct a snapshot from baseline and encoded data. Returns false if the data is malformed.
+bool ReadSnapshotDelta(const Snapshot* baseline, const uint8_t* data, size_t size, Encoding encoding, Snapshot& out);
+
+/// Append full states of players without a baseline, for updates outside the delta stream
+void WritePlayerStates(const std::vector<PlayerState>& players, Encoding encoding, std::vector<uint8_t>& out);
+/// Bytes WritePlayerStates takes for one player, without the count in front
+size_t PlayerStateSize(uint32_t uuid, Encoding encoding);
+/// Bytes WriteSnapshotDelta takes for player against its baseline entry, nullptr if the baseline lacks it, 0 if unchanged
+size_t PlayerDeltaSize(const PlayerState* baseline, const PlayerState& player, Encoding encoding);
+/// Bytes WriteSnapshotDelta takes for a player in the baseline that is not in the snapshot
+size_t RemovedPlayerSize(uint32_t uuid);
+/// Decode players written by WritePlayerStates, appending to out. Returns false if the data is malformed.
+bool ReadPlayerStates(const uint8_t* data, size_t size, Encoding encoding, std::vector<PlayerState>& out);
+
+/// Append laser quantized, with its timestamps as 16 bit offsets from baseTime
+void WriteLaserState(const LaserState& laser, uint64_t baseTime, std::vector<uint8_t>& out);
+/// Decode a laser written by WriteLaserState. Returns false if the data is malformed.
+bool ReadLaserState(const uint8_t* data, size_t size, uint64_t baseTime, LaserState& out);
+
+} // namespace Net
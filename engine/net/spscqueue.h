@@ -0,0 +1,114 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+    @file spscqueue.h
+
+    @class Net::SpscQueue
+
+    Bounded lock-free queue for exactly one producer and one consumer thread.
+    The producer only writes tail and the consumer only writes head, each
+    on its own cache line, and both keep a private copy of the other index
+    so they only touch the shared one when the queue looks full or empty.
+
+    Capacity is rounded up to a power of two.
+
+    @copyright
+    (C) 2024 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include <atomic>
+#include <vector>
+#include <algorithm>
+#include <bit>
+
+namespace Net
+{
+
+template <typename T>
+class SpscQueue
+{
+public:
+    /// constructor
+    explicit SpscQueue(uint32_t capacity);
+
+    /// producer: append item, false if the queue is full
+    bool Push(const T& item);
+    /// consumer: remove the oldest item, false if the queue is empty
+    bool Pop(T& item);
+    /// number of queued items, exact only when called by producer or consumer while the other is idle
+    uint32_t Size() const;
+    /// maximum number of queued items
+    uint32_t Capacity() const { return this->mask + 1; }
+
+private:
+    std::vector<T> items;
+    uint32_t mask;
+
+    /// next item to pop, written by the consumer
+    alignas(64) std::atomic<uint32_t> head = 0;
+    uint32_t cachedTail = 0;
+    /// next free slot, written by the producer
+    alignas(64) std::atomic<uint32_t> tail = 0;
+    uint32_t cachedHead = 0;
+};
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <typename T>
+inline
+SpscQueue<T>::SpscQueue(uint32_t capacity) :
+    items(std::bit_ceil(std::max(capacity, 2u))),
+    mask(std::bit_ceil(std::max(capacity, 2u)) - 1)
+{
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <typename T>
+inline bool
+SpscQueue<T>::Push(const T& item)
+{
+    uint32_t const tail = this->tail.load(std::memory_order_relaxed);
+    if (tail - this->cachedHead > this->mask)
+    {
+        this->cachedHead = this->head.load(std::memory_order_acquire);
+        if (tail - this->cachedHead > this->mask)
+            return false;
+    }
+    this->items[tail & this->mask] = item;
+    this->tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <typename T>
+inline bool
+SpscQueue<T>::Pop(T& item)
+{
+    uint32_t const head = this->head.load(std::memory_order_relaxed);
+    if (head == this->cachedTail)
+    {
+        this->cachedTail = this->tail.load(std::memory_order_acquire);
+        if (head == this->cachedTail)
+            return false;
+    }
+    item = this->items[head & this->mask];
+    this->head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/**
+*/
+template <typename T>
+inline uint32_t
+SpscQueue<T>::Size() const
+{
+    return this->tail.load(std::memory_order_acquire) - this->head.load(std::memory_order_acquire);
+}
+
+} // namespace Net
@@ -95,7 +95,7 @@ ColliderMeshId LoadColliderMesh(std::string path);
 
 void SetTransform(ColliderId collider, glm::mat4 const& transform);
 
-// temp
+// temp, implemented in bvh.cc which is only part of the render library
 void SetupBVH();
 void VisualizeBVH();
 
@@ -96,6 +96,9 @@ enet_host_create (const ENetAddress * address, size_t peerCount, size_t channelL
     host -> totalSentPackets = 0;
     host -> totalReceivedData = 0;
     host -> totalReceivedPackets = 0;
+    host -> totalSendCalls = 0;
+    host -> totalReceiveCalls = 0;
+    host -> socketBatch = NULL;
 
     host -> connectedPeers = 0;
     host -> bandwidthLimitedPeers = 0;
@@ -108,6 +111,11 @@ enet_host_create (const ENetAddress * address, size_t peerCount, size_t channelL
     host -> compressor.decompress = NULL;
     host -> compressor.destroy = NULL;
 
+    host -> transport.context = NULL;
+    host -> transport.send = NULL;
+    host -> transport.receive = NULL;
+    host -> transport.destroy = NULL;
+
     host -> intercept = NULL;
 
     enet_list_clear (& host -> dispatchQueue);
@@ -156,6 +164,12 @@ enet_host_destroy (ENetHost * host)
     if (host -> compressor.context != NULL && host -> compressor.destroy)
       (* host -> compressor.destroy) (host -> compressor.context);
 
+    if (host -> transport.context != NULL && host -> transport.destroy)
+      (* host -> transport.destroy) (host -> transport.context);
+
+    if (host -> socketBatch != NULL)
+      enet_free (host -> socketBatch);
+
     enet_free (host -> peers);
     enet_free (host);
 }
@@ -301,6 +315,67 @@ enet_host_compress (ENetHost * host, const ENetCompressor * compressor)
       host -> compressor.context = NULL;
 }
 
+/** Sets the transport the host exchanges datagrams with instead of its socket.
+    The socket stays open but unused, so enet_host_service() should be called with a timeout of 0,
+    a longer one waits on the socket and only returns when it runs out. Socket batching does not apply.
+    @param host host to set the transport of
+    @param transport callbacks of the transport; if NULL, then the host uses its socket again
+*/
+void
+enet_host_transport (ENetHost * host, const ENetTransport * transport)
+{
+    if (host -> transport.context != NULL && host -> transport.destroy)
+      (* host -> transport.destroy) (host -> transport.context);
+
+    if (transport)
+      host -> transport = * transport;
+    else
+      host -> transport.context = NULL;
+}
+
+/** Sets whether the host exchanges datagrams with its socket in batches.
+    All datagrams one enet_host_service() or enet_host_flush() sends go out together at its end,
+    in calls of up to ENET_HOST_SOCKET_BATCH_SIZE datagrams, and receiving takes up to as many per call.
+    With sendmmsg and recvmmsg that is one system call per batch, elsewhere the batches are sent and
+    received one datagram at a time.
+    @param host host to enable or disable batching for
+    @param enable nonzero to batch, 0 for a call per datagram; received datagrams not handled yet are dropped
+    @returns 0 on success, < 0 if the batch buffers could not be allocated
+*/
+int
+enet_host_socket_batching (ENetHost * host, int enable)
+{
+    size_t i;
+
+    if (! enable)
+    {
+       if (host -> socketBatch != NULL)
+         enet_free (host -> socketBatch);
+       host -> socketBatch = NULL;
+       return 0;
+    }
+
+    if (host -> socketBatch != NULL)
+      return 0;
+
+    host -> socketBatch = (ENetSocketBatch *) enet_malloc (sizeof (ENetSocketBatch));
+    if (host -> socketBatch == NULL)
+      return -1;
+
+    host -> socketBatch -> sendCount = 0;
+    host -> socketBatch -> receiveCount = 0;
+    host -> socketBatch -> receiveNext = 0;
+    for (i = 0; i < ENET_HOST_SOCKET_BATCH_SIZE; ++ i)
+    {
+       host -> socketBatch -> sendBuffers [i].data = host -> socketBatch -> sendData [i];
+       host -> socketBatch -> sendBuffers [i].dataLength = 0;
+       host -> socketBatch -> receiveBuffers [i].data = host -> socketBatch -> receiveData [i];
+       host -> socketBatch -> receiveBuffers [i].dataLength = 0;
+    }
+
+    return 0;
+}
+
 /** Limits the maximum allowed channels of future incoming connections.
     @param host host to limit
     @param channelLimit the maximum number of channels allowed; if 0, then this is equivalent to ENET_PROTOCOL_MAXIMUM_CHANNEL_COUNT
@@ -215,6 +215,7 @@ enum
    ENET_HOST_DEFAULT_MTU                  = 1400,
    ENET_HOST_DEFAULT_MAXIMUM_PACKET_SIZE  = 32 * 1024 * 1024,
    ENET_HOST_DEFAULT_MAXIMUM_WAITING_DATA = 32 * 1024 * 1024,
+   ENET_HOST_SOCKET_BATCH_SIZE            = 32,
 
    ENET_PEER_DEFAULT_ROUND_TRIP_TIME      = 500,
    ENET_PEER_DEFAULT_PACKET_THROTTLE      = 32,
@@ -338,12 +339,43 @@ typedef struct _ENetCompressor
    void (ENET_CALLBACK * destroy) (void * context);
 } ENetCompressor;
 
+/** Replaces the socket of a host, for exchanging datagrams some other way than UDP.
+ */
+typedef struct _ENetTransport
+{
+   /** Context data for the transport. Must be non-NULL. */
+   void * context;
+   /** Sends the datagram held in buffers[0:bufferCount-1] to address. Should return the number of bytes sent, 0 if it would block, or < 0 on failure. */
+   int (ENET_CALLBACK * send) (void * context, const ENetAddress * address, const ENetBuffer * buffers, size_t bufferCount);
+   /** Receives a datagram into buffer, setting address to where it came from. Should return its length, 0 if none is waiting, or < 0 on failure. */
+   int (ENET_CALLBACK * receive) (void * context, ENetAddress * address, ENetBuffer * buffer);
+   /** Destroys the context when the transport is replaced or the host is destroyed. May be NULL. */
+   void (ENET_CALLBACK * destroy) (void * context);
+} ENetTransport;
+
 /** Callback that computes the checksum of the data held in buffers[0:bufferCount-1] */
 typedef enet_uint32 (ENET_CALLBACK * ENetChecksumCallback) (const ENetBuffer * buffers, size_t bufferCount);
 
 /** Callback for intercepting received raw UDP packets. Should return 1 to intercept, 0 to ignore, or -1 to propagate an error. */
 typedef int (ENET_CALLBACK * ENetInterceptCallback) (struct _ENetHost * host, struct _ENetEvent * event);
  
+/** Datagrams a host exchanges with its socket in batches.
+
+    @sa enet_host_socket_batching()
+  */
+typedef struct _ENetSocketBatch
+{
+   size_t               sendCount;                   /**< datagrams waiting for the end of enet_protocol_send_outgoing_commands */
+   ENetAddress          sendAddresses [ENET_HOST_SOCKET_BATCH_SIZE];
+   ENetBuffer           sendBuffers [ENET_HOST_SOCKET_BATCH_SIZE];
+   enet_uint8           sendData [ENET_HOST_SOCKET_BATCH_SIZE][ENET_PROTOCOL_MAXIMUM_MTU];
+   size_t               receiveCount;                /**< datagrams received by the last batched receive */
+   size_t               receiveNext;                 /**< next of them to handle, ones left over when an event is returned are handled first by the next service */
+   ENetAddress          receiveAddresses [ENET_HOST_SOCKET_BATCH_SIZE];
+   ENetBuffer           receiveBuffers [ENET_HOST_SOCKET_BATCH_SIZE];
+   enet_uint8           receiveData [ENET_HOST_SOCKET_BATCH_SIZE][ENET_PROTOCOL_MAXIMUM_MTU];
+} ENetSocketBatch;
+
 /** An ENet host for communicating with peers.
   *
   * No fields should be modified unless otherwise stated.
@@ -359,6 +391,8 @@ typedef int (ENET_CALLBACK * ENetInterceptCallback) (struct _ENetHost * host, st
     @sa enet_host_channel_limit()
     @sa enet_host_bandwidth_limit()
     @sa enet_host_bandwidth_throttle()
+    @sa enet_host_socket_batching()
+    @sa enet_host_transport()
   */
 typedef struct _ENetHost
 {
@@ -398,6 +432,10 @@ typedef struct _ENetHost
    size_t               duplicatePeers;              /**< optional number of allowed peers from duplicate IPs, defaults to ENET_PROTOCOL_MAXIMUM_PEER_ID */
    size_t               maximumPacketSize;           /**< the maximum allowable packet size that may be sent or received on a peer */
    size_t               maximumWaitingData;          /**< the maximum aggregate amount of buffer space a peer may use waiting for packets to be delivered */
+   ENetSocketBatch *    socketBatch;                 /**< batched socket calls, NULL unless enabled with enet_host_socket_batching() */
+   enet_uint32          totalSendCalls;              /**< total socket calls made to send, user should reset to 0 as needed to prevent overflow */
+   enet_uint32          totalReceiveCalls;           /**< total socket calls made to receive, including the ones that found nothing */
+   ENetTransport        transport;                   /**< replaces socket sends and receives while its context is non-NULL, set with enet_host_transport() */
 } ENetHost;
 
 /**
@@ -502,6 +540,8 @@ ENET_API ENetSocket enet_socket_accept (ENetSocket, ENetAddress *);
 ENET_API int        enet_socket_connect (ENetSocket, const ENetAddress *);
 ENET_API int        enet_socket_send (ENetSocket, const ENetAddress *, const ENetBuffer *, size_t);
 ENET_API int        enet_socket_receive (ENetSocket, ENetAddress *, ENetBuffer *, size_t);
+ENET_API int        enet_socket_send_batch (ENetSocket, const ENetAddress *, const ENetBuffer *, size_t);
+ENET_API int        enet_socket_receive_batch (ENetSocket, ENetAddress *, ENetBuffer *, size_t);
 ENET_API int        enet_socket_wait (ENetSocket, enet_uint32 *, enet_uint32);
 ENET_API int        enet_socket_set_option (ENetSocket, ENetSocketOption, int);
 ENET_API int        enet_socket_get_option (ENetSocket, ENetSocketOption, int *);
@@ -570,9 +610,11 @@ ENET_API int        enet_host_service (ENetHost *, ENetEvent *, enet_uint32);
 ENET_API void       enet_host_flush (ENetHost *);
 ENET_API void       enet_host_broadcast (ENetHost *, enet_uint8, ENetPacket *);
 ENET_API void       enet_host_compress (ENetHost *, const ENetCompressor *);
+ENET_API void       enet_host_transport (ENetHost *, const ENetTransport *);
 ENET_API int        enet_host_compress_with_range_coder (ENetHost * host);
 ENET_API void       enet_host_channel_limit (ENetHost *, size_t);
 ENET_API void       enet_host_bandwidth_limit (ENetHost *, enet_uint32, enet_uint32);
+ENET_API int        enet_host_socket_batching (ENetHost *, int);
 extern   void       enet_host_bandwidth_throttle (ENetHost *);
 extern  enet_uint32 enet_host_random_seed (void);
 extern  enet_uint32 enet_host_random (ENetHost *);
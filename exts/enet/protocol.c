@@ -1214,22 +1214,87 @@ commandError:
 }
  
 static int
-enet_protocol_receive_incoming_commands (ENetHost * host, ENetEvent * event)
+enet_protocol_receive_datagram (ENetHost * host, enet_uint8 * * data)
 {
-    int packets;
+    ENetSocketBatch * batch = host -> socketBatch;
+    int receivedLength;
 
-    for (packets = 0; packets < 256; ++ packets)
+    if (host -> transport.context != NULL)
     {
-       int receivedLength;
        ENetBuffer buffer;
 
        buffer.data = host -> packetData [0];
        buffer.dataLength = sizeof (host -> packetData [0]);
 
-       receivedLength = enet_socket_receive (host -> socket,
-                                             & host -> receivedAddress,
-                                             & buffer,
-                                             1);
+       ++ host -> totalReceiveCalls;
+
+       * data = host -> packetData [0];
+
+       return host -> transport.receive (host -> transport.context, & host -> receivedAddress, & buffer);
+    }
+
+    if (batch == NULL)
+    {
+       ENetBuffer buffer;
+
+       buffer.data = host -> packetData [0];
+       buffer.dataLength = sizeof (host -> packetData [0]);
+
+       ++ host -> totalReceiveCalls;
+
+       * data = host -> packetData [0];
+
+       return enet_socket_receive (host -> socket,
+                                   & host -> receivedAddress,
+                                   & buffer,
+                                   1);
+    }
+
+    if (batch -> receiveNext >= batch -> receiveCount)
+    {
+       size_t i;
+
+       for (i = 0; i < ENET_HOST_SOCKET_BATCH_SIZE; ++ i)
+         batch -> receiveBuffers [i].dataLength = sizeof (batch -> receiveData [i]);
+
+       ++ host -> totalReceiveCalls;
+
+       receivedLength = enet_socket_receive_batch (host -> socket,
+                                                   batch -> receiveAddresses,
+                                                   batch -> receiveBuffers,
+                                                   ENET_HOST_SOCKET_BATCH_SIZE);
+       if (receivedLength <= 0)
+       {
+          batch -> receiveCount = 0;
+          batch -> receiveNext = 0;
+
+          return receivedLength;
+       }
+
+       batch -> receiveCount = receivedLength;
+       batch -> receiveNext = 0;
+    }
+
+    host -> receivedAddress = batch -> receiveAddresses [batch -> receiveNext];
+    /* The batch receive may have reordered the buffers over receiveData */
+    * data = (enet_uint8 *) batch -> receiveBuffers [batch -> receiveNext].data;
+    receivedLength = (int) batch -> receiveBuffers [batch -> receiveNext].dataLength;
+    ++ batch -> receiveNext;
+
+    return receivedLength;
+}
+
+static int
+enet_protocol_receive_incoming_commands (ENetHost * host, ENetEvent * event)
+{
+    int packets;
+
+    for (packets = 0; packets < 256; ++ packets)
+    {
+       int receivedLength;
+       enet_uint8 * receivedData;
+
+       receivedLength = enet_protocol_receive_datagram (host, & receivedData);
 
        if (receivedLength < 0)
          return -1;
@@ -1237,7 +1302,7 @@ enet_protocol_receive_incoming_commands (ENetHost * host, ENetEvent * event)
        if (receivedLength == 0)
          return 0;
 
-       host -> receivedData = host -> packetData [0];
+       host -> receivedData = receivedData;
        host -> receivedDataLength = receivedLength;
       
        host -> totalReceivedData += receivedLength;
@@ -1565,7 +1630,83 @@ enet_protocol_check_outgoing_commands (ENetHost * host, ENetPeer * peer)
 }
 
 static int
-enet_protocol_send_outgoing_commands (ENetHost * host, ENetEvent * event, int checkForTimeouts)
+enet_protocol_flush_datagrams (ENetHost * host)
+{
+    ENetSocketBatch * batch = host -> socketBatch;
+    size_t sent = 0;
+
+    while (sent < batch -> sendCount)
+    {
+       int sentCount;
+
+       ++ host -> totalSendCalls;
+
+       sentCount = enet_socket_send_batch (host -> socket,
+                                           & batch -> sendAddresses [sent],
+                                           & batch -> sendBuffers [sent],
+                                           batch -> sendCount - sent);
+       if (sentCount < 0)
+       {
+          batch -> sendCount = 0;
+
+          return -1;
+       }
+
+       if (sentCount == 0)
+         break;
+
+       sent += sentCount;
+    }
+
+    batch -> sendCount = 0;
+
+    return 0;
+}
+
+static int
+enet_protocol_send_datagram (ENetHost * host, const ENetAddress * address, const ENetBuffer * buffers, size_t bufferCount)
+{
+    ENetSocketBatch * batch = host -> socketBatch;
+    enet_uint8 * data;
+    size_t i, length = 0;
+
+    if (host -> transport.context != NULL)
+    {
+       ++ host -> totalSendCalls;
+
+       return host -> transport.send (host -> transport.context, address, buffers, bufferCount);
+    }
+
+    if (batch == NULL)
+    {
+       ++ host -> totalSendCalls;
+
+       return enet_socket_send (host -> socket, address, buffers, bufferCount);
+    }
+
+    if (batch -> sendCount >= ENET_HOST_SOCKET_BATCH_SIZE &&
+        enet_protocol_flush_datagrams (host) < 0)
+      return -1;
+
+    data = batch -> sendData [batch -> sendCount];
+    for (i = 0; i < bufferCount; ++ i)
+    {
+       if (length + buffers [i].dataLength > sizeof (batch -> sendData [0]))
+         return -1;
+
+       memcpy (data + length, buffers [i].data, buffers [i].dataLength);
+       length += buffers [i].dataLength;
+    }
+
+    batch -> sendAddresses [batch -> sendCount] = * address;
+    batch -> sendBuffers [batch -> sendCount].dataLength = length;
+    ++ batch -> sendCount;
+
+    return (int) length;
+}
+
+static int
+enet_protocol_send_peer_commands (ENetHost * host, ENetEvent * event, int checkForTimeouts)
 {
     enet_uint8 headerData [sizeof (ENetProtocolHeader) + sizeof (enet_uint32)];
     ENetProtocolHeader * header = (ENetProtocolHeader *) headerData;
@@ -1686,7 +1827,7 @@ enet_protocol_send_outgoing_commands (ENetHost * host, ENetEvent * event, int ch
 
         currentPeer -> lastSendTime = host -> serviceTime;
 
-        sentLength = enet_socket_send (host -> socket, & currentPeer -> address, host -> buffers, host -> bufferCount);
+        sentLength = enet_protocol_send_datagram (host, & currentPeer -> address, host -> buffers, host -> bufferCount);
 
         enet_protocol_remove_sent_unreliable_commands (currentPeer);
 
@@ -1700,6 +1841,19 @@ enet_protocol_send_outgoing_commands (ENetHost * host, ENetEvent * event, int ch
     return 0;
 }
 
+static int
+enet_protocol_send_outgoing_commands (ENetHost * host, ENetEvent * event, int checkForTimeouts)
+{
+    int result = enet_protocol_send_peer_commands (host, event, checkForTimeouts);
+
+    if (host -> socketBatch != NULL &&
+        host -> socketBatch -> sendCount > 0 &&
+        enet_protocol_flush_datagrams (host) < 0)
+      return -1;
+
+    return result;
+}
+
 /** Sends any queued packets on the host specified to its designated peers.
 
     @param host   host to flush
@@ -4,6 +4,10 @@
 */
 #ifndef _WIN32
 
+#if (defined(HAS_SENDMMSG) || defined(HAS_RECVMMSG)) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE 1
+#endif
+
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <sys/ioctl.h>
@@ -512,6 +516,147 @@ enet_socket_receive (ENetSocket socket,
     return recvLength;
 }
 
+int
+enet_socket_send_batch (ENetSocket socket,
+                        const ENetAddress * addresses,
+                        const ENetBuffer * buffers,
+                        size_t count)
+{
+#ifdef HAS_SENDMMSG
+    struct mmsghdr msgHdrs [ENET_HOST_SOCKET_BATCH_SIZE];
+    struct sockaddr_in sins [ENET_HOST_SOCKET_BATCH_SIZE];
+    size_t i;
+    int sentCount;
+
+    if (count > ENET_HOST_SOCKET_BATCH_SIZE)
+      count = ENET_HOST_SOCKET_BATCH_SIZE;
+
+    memset (msgHdrs, 0, sizeof (struct mmsghdr) * count);
+
+    for (i = 0; i < count; ++ i)
+    {
+        memset (& sins [i], 0, sizeof (struct sockaddr_in));
+
+        sins [i].sin_family = AF_INET;
+        sins [i].sin_port = ENET_HOST_TO_NET_16 (addresses [i].port);
+        sins [i].sin_addr.s_addr = addresses [i].host;
+
+        msgHdrs [i].msg_hdr.msg_name = & sins [i];
+        msgHdrs [i].msg_hdr.msg_namelen = sizeof (struct sockaddr_in);
+        msgHdrs [i].msg_hdr.msg_iov = (struct iovec *) & buffers [i];
+        msgHdrs [i].msg_hdr.msg_iovlen = 1;
+    }
+
+    sentCount = sendmmsg (socket, msgHdrs, count, MSG_NOSIGNAL);
+
+    if (sentCount == -1)
+    {
+       if (errno == EWOULDBLOCK)
+         return 0;
+
+       return -1;
+    }
+
+    return sentCount;
+#else
+    size_t i;
+
+    for (i = 0; i < count; ++ i)
+    {
+        int sentLength = enet_socket_send (socket, & addresses [i], & buffers [i], 1);
+
+        if (sentLength < 0)
+          return -1;
+
+        if (sentLength == 0)
+          break;
+    }
+
+    return (int) i;
+#endif
+}
+
+int
+enet_socket_receive_batch (ENetSocket socket,
+                           ENetAddress * addresses,
+                           ENetBuffer * buffers,
+                           size_t count)
+{
+#ifdef HAS_RECVMMSG
+    struct mmsghdr msgHdrs [ENET_HOST_SOCKET_BATCH_SIZE];
+    struct sockaddr_in sins [ENET_HOST_SOCKET_BATCH_SIZE];
+    size_t i, received;
+    int recvCount;
+
+    if (count > ENET_HOST_SOCKET_BATCH_SIZE)
+      count = ENET_HOST_SOCKET_BATCH_SIZE;
+
+    do
+    {
+        memset (msgHdrs, 0, sizeof (struct mmsghdr) * count);
+
+        for (i = 0; i < count; ++ i)
+        {
+            msgHdrs [i].msg_hdr.msg_name = & sins [i];
+            msgHdrs [i].msg_hdr.msg_namelen = sizeof (struct sockaddr_in);
+            msgHdrs [i].msg_hdr.msg_iov = (struct iovec *) & buffers [i];
+            msgHdrs [i].msg_hdr.msg_iovlen = 1;
+        }
+
+        recvCount = recvmmsg (socket, msgHdrs, count, MSG_NOSIGNAL | MSG_DONTWAIT, NULL);
+
+        if (recvCount == -1)
+        {
+           if (errno == EWOULDBLOCK)
+             return 0;
+
+           return -1;
+        }
+
+        /* A truncated datagram is dropped like one lost on the way, the ones
+           after it move up, buffers and all, so the batch stays valid. */
+        received = 0;
+        for (i = 0; i < (size_t) recvCount; ++ i)
+        {
+            if (msgHdrs [i].msg_hdr.msg_flags & MSG_TRUNC)
+              continue;
+
+            if (received != i)
+            {
+                ENetBuffer buffer = buffers [received];
+                buffers [received] = buffers [i];
+                buffers [i] = buffer;
+            }
+
+            buffers [received].dataLength = msgHdrs [i].msg_len;
+            addresses [received].host = (enet_uint32) sins [i].sin_addr.s_addr;
+            addresses [received].port = ENET_NET_TO_HOST_16 (sins [i].sin_port);
+            ++ received;
+        }
+    }
+    while (received == 0 && recvCount > 0);
+
+    return (int) received;
+#else
+    size_t i;
+
+    for (i = 0; i < count; ++ i)
+    {
+        int recvLength = enet_socket_receive (socket, & addresses [i], & buffers [i], 1);
+
+        if (recvLength < 0)
+          return i > 0 ? (int) i : -1;
+
+        if (recvLength == 0)
+          break;
+
+        buffers [i].dataLength = recvLength;
+    }
+
+    return (int) i;
+#endif
+}
+
 int
 enet_socketset_select (ENetSocket maxSocket, ENetSocketSet * readSet, ENetSocketSet * writeSet, enet_uint32 timeout)
 {
@@ -0,0 +1,271 @@
+//------------------------------------------------------------------------------
+// bot.cc
+// (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "config.h"
+#include "bot.h"
+#include "core/random.h"
+#include "net/netthread.h"
+#include "net/channels.h"
+
+namespace Game
+{
+
+    //------------------------------------------------------------------------------
+
+    void BotStats::Clear()
+    {
+        this->roundTrips.clear();
+        this->snapshots = 0;
+        this->snapshotsLost = 0;
+        this->serverTicks = 0;
+        this->serverTime = 0;
+        this->bytesSent = 0;
+        this->bytesReceived = 0;
+        this->disconnects = 0;
+    }
+
+    //------------------------------------------------------------------------------
+
+    Bot::Bot() { }
+
+    //------------------------------------------------------------------------------
+
+    Bot::~Bot()
+    {
+        this->conditioner.Detach();
+        if (this->host != nullptr)
+            enet_host_destroy(this->host);
+    }
+
+    //------------------------------------------------------------------------------
+
+    bool Bot::Connect(const ENetAddress& address, uint32_t index, BotInput input, const Net::Conditioner::Settings& conditions, Net::CompressionMethod compression, Net::Loopback* loopback)
+    {
+        this->host = enet_host_create(nullptr, 1, Net::ChannelCount, 0, 0);
+        if (this->host == nullptr || !Net::PacketCompressor::Attach(this->host, compression))
+            return false;
+
+        if (loopback != nullptr)
+        {
+            if (!loopback->Attach(this->host))
+                return false;
+        }
+        else
+        {
+            Net::Conditioner::Settings settings = conditions;
+            settings.seed += index;
+            if (!this->conditioner.Attach(this->host, settings))
+                return false;
+        }
+
+        this->peer = enet_host_connect(this->host, &address, Net::ChannelCount, 0);
+        if (this->peer == nullptr)
+            return false;
+
+        this->index = index;
+        this->input = input;
+        this->state = Connecting;
+        return true;
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+        ENet's traffic counters are moved into stats, so they only ever count
+        one report interval.
+    */
+    void Bot::Service(BotStats& stats)
+    {
+        if (this->host == nullptr)
+            return;
+
+        ENetEvent event;
+        while (this->conditioner.Service(this->host, &event, 0) > 0)
+        {
+            switch (event.type)
+            {
+                case ENET_EVENT_TYPE_CONNECT:
+                    this->state = Connected;
+                    break;
+                case ENET_EVENT_TYPE_RECEIVE:
+                    ProcessReceivedPacket(event.packet->data, event.packet->dataLength, stats);
+                    enet_packet_destroy(event.packet);
+                    break;
+                case ENET_EVENT_TYPE_DISCONNECT:
+                    if (this->state != Disconnected)
+                        stats.disconnects++;
+                    this->state = Disconnected;
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        stats.bytesSent += this->host->totalSentData;
+        stats.bytesReceived += this->host->totalReceivedData;
+        this->host->totalSentData = 0;
+        this->host->totalReceivedData = 0;
+    }
+
+    //------------------------------------------------------------------------------
+
+    void Bot::Deliver()
+    {
+        this->conditioner.Update();
+    }
+
+    //------------------------------------------------------------------------------
+
+    void Bot::Tick()
+    {
+        if (this->state != Connected || this->tickRate == 0)
+            return;
+
+        this->ticks++;
+        uint16_t const bitmap = NextBitmap();
+        // Unchanged inputs are only sent as a heartbeat, like the real client does
+        if (this->inputSender.Sample(bitmap))
+            SendInputC2S(bitmap);
+
+        if (this->clock.RequestDue(Net::LocalTime()))
+            SendClockSyncC2S();
+
+        enet_host_flush(this->host);
+    }
+
+    //------------------------------------------------------------------------------
+
+    void Bot::Disconnect()
+    {
+        if (this->state == Connected || this->state == Connecting)
+            enet_peer_disconnect(this->peer, 0);
+    }
+
+    //------------------------------------------------------------------------------
+
+    void Bot::ProcessReceivedPacket(const void* data, size_t dataLength, BotStats& stats)
+    {
+        if (dataLength < sizeof(uint16_t))
+            return;
+
+        auto packetWrapper = Protocol::GetPacketWrapper(data);
+        switch (packetWrapper->packet_type())
+        {
+            case Protocol::PacketType_ClientConnectS2C:
+            {
+                const auto connectPacket = packetWrapper->packet_as_ClientConnectS2C();
+                this->tickRate = connectPacket->tick_rate();
+                this->clock.Seed(connectPacket->time(), Net::LocalTime());
+                break;
+            }
+            case Protocol::PacketType_SnapshotS2C:
+            {
+                const auto snapshotPacket = packetWrapper->packet_as_SnapshotS2C();
+                uint64_t const tick = snapshotPacket->tick();
+                // Late snapshots were already counted as lost
+                if (tick <= this->snapshotTick)
+                    break;
+
+                stats.snapshots++;
+                if (this->snapshotTick != 0)
+                {
+                    stats.snapshotsLost += tick - this->snapshotTick - 1;
+                    stats.serverTicks += tick - this->snapshotTick;
+                    stats.serverTime += snapshotPacket->time() - this->snapshotTime;
+                }
+                this->snapshotTick = tick;
+                this->snapshotTime = snapshotPacket->time();
+                break;
+            }
+            case Protocol::PacketType_ClockSyncS2C:
+            {
+                // The request was stamped in us, the clock sync works in ms
+                const auto syncPacket = packetWrapper->packet_as_ClockSyncS2C();
+                uint64_t const sent = syncPacket->client_time();
+                uint64_t const received = Net::QueueTime();
+                stats.roundTrips.push_back((uint32_t)(received - sent));
+                this->clock.AddSample(sent / 1000, syncPacket->server_time(), received / 1000);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+        Bits as in SpaceGameApp::SendInputToServer: 0 forward, 1-2 roll, 3-4
+        pitch, 5-6 yaw, 7 fire, 8 boost.
+    */
+    uint16_t Bot::NextBitmap()
+    {
+        switch (this->input)
+        {
+            case BotInput::Random:
+                if (this->ticks >= this->holdUntil)
+                {
+                    uint16_t bitmap = 0;
+                    if (Core::RandomFloat() < 0.8f)
+                        bitmap |= (1 << 0);
+                    if (Core::RandomFloat() < 0.2f)
+                        bitmap |= (1 << 8);
+                    if (Core::RandomFloat() < 0.25f)
+                        bitmap |= (1 << 7);
+                    // one rotation at a time, or none
+                    uint32_t const rotation = Core::FastRandom() % 7;
+                    if (rotation < 6)
+                        bitmap |= (1 << (rotation + 1));
+                    this->heldBitmap = bitmap;
+                    this->holdUntil = this->ticks + 15 + Core::FastRandom() % 105;
+                }
+                return this->heldBitmap;
+            case BotInput::Scripted:
+            {
+                uint32_t const t = this->ticks + this->index * 7;
+                uint16_t bitmap = (1 << 0);
+                bitmap |= ((t / 40) % 2) ? (1 << 5) : (1 << 3);
+                if ((t / 90) % 2)
+                    bitmap |= (1 << 8);
+                if ((t / 30) % 3 == 0)
+                    bitmap |= (1 << 1);
+                if ((t / 60) % 4 == 0)
+                    bitmap |= (1 << 7);
+                return bitmap;
+            }
+            default:
+                return 0;
+        }
+    }
+
+    //------------------------------------------------------------------------------
+
+    void Bot::SendInputC2S(uint16_t bitmap)
+    {
+        builder.Clear();
+        auto previous = builder.CreateVector(this->inputSender.Previous(), this->inputSender.PreviousCount());
+        // Bots do not interpolate, they act on the newest snapshot
+        auto inputPacket = Protocol::CreateInputC2S(builder, this->clock.ServerTime(Net::LocalTime()), bitmap, this->snapshotTick, this->inputSender.Sequence(), previous, this->snapshotTime);
+        auto packetWrapper = Protocol::CreatePacketWrapper(builder, Protocol::PacketType_InputC2S, inputPacket.Union());
+
+        builder.Finish(packetWrapper);
+        ENetPacket* packet = enet_packet_create(builder.GetBufferPointer(), builder.GetSize(), ENET_PACKET_FLAG_UNRELIABLE_FRAGMENT);
+        enet_peer_send(this->peer, (uint8_t)Net::Channel::State, packet);
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+        Stamped with the local time in us instead of ms, the server echoes it
+        unchanged and loopback round trips are well below a millisecond.
+    */
+    void Bot::SendClockSyncC2S()
+    {
+        builder.Clear();
+        auto syncPacket = Protocol::CreateClockSyncC2S(builder, Net::QueueTime());
+        auto packetWrapper = Protocol::CreatePacketWrapper(builder, Protocol::PacketType_ClockSyncC2S, syncPacket.Union());
+
+        builder.Finish(packetWrapper);
+        ENetPacket* packet = enet_packet_create(builder.GetBufferPointer(), builder.GetSize(), 0);
+        enet_peer_send(this->peer, (uint8_t)Net::Channel::State, packet);
+    }
+
+} // namespace Game
@@ -0,0 +1,123 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+	Simulated client
+
+	One ENet connection to the server that plays without a window. It sends an
+	InputC2S per server tick from a generated input pattern, acknowledges the
+	snapshots it receives and measures round trips with clock sync requests.
+	Snapshots are counted by tick, not decoded.
+
+	(C) 2024 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include "net/inputstream.h"
+#include "net/clocksync.h"
+#include "net/conditioner.h"
+#include "net/compressor.h"
+#include "net/loopback.h"
+#include "enet/enet.h"
+#include <proto.h>
+#include <vector>
+
+namespace Game
+{
+/// how a bot picks its input bitmap
+enum class BotInput
+{
+	/// hold a random bitmap for a random number of ticks
+	Random,
+	/// fly the same loop as every other bot, offset in time
+	Scripted,
+	/// only heartbeats
+	Idle
+};
+
+/// measurements of all bots since the last report
+struct BotStats
+{
+	/// clock sync round trips in us
+	std::vector<uint32_t> roundTrips;
+	/// snapshots received and skipped over, the server sends one per tick
+	uint64_t snapshots = 0;
+	uint64_t snapshotsLost = 0;
+	/// server ticks and ms of server time between consecutive snapshots
+	uint64_t serverTicks = 0;
+	uint64_t serverTime = 0;
+	/// UDP payload bytes
+	uint64_t bytesSent = 0;
+	uint64_t bytesReceived = 0;
+	/// connections that failed or were dropped
+	uint32_t disconnects = 0;
+
+	/// start a new measurement interval
+	void Clear();
+};
+
+class Bot
+{
+public:
+	enum State
+	{
+		Idle,
+		Connecting,
+		Connected,
+		Disconnected
+	};
+
+	/// constructor
+	Bot();
+	/// destructor, destroys the host
+	~Bot();
+	Bot(const Bot&) = delete;
+	Bot& operator=(const Bot&) = delete;
+
+	/// create a host and start connecting, index offsets the input pattern and the conditioner's seed, with a loopback the host is attached to it and conditions are ignored
+	bool Connect(const ENetAddress& address, uint32_t index, BotInput input, const Net::Conditioner::Settings& conditions, Net::CompressionMethod compression, Net::Loopback* loopback = nullptr);
+	/// handle all pending events of the host
+	void Service(BotStats& stats);
+	/// hand the datagrams the conditioner held back long enough to the host's socket
+	void Deliver();
+	/// sample and send the input of the next server tick
+	void Tick();
+	/// start a graceful disconnect
+	void Disconnect();
+
+	/// connection state
+	State GetState() const { return this->state; }
+	/// the host's socket, to wait on
+	ENetSocket Socket() const { return this->host->socket; }
+	/// server ticks per second, 0 until the server said so
+	uint32_t TickRate() const { return this->tickRate; }
+
+private:
+	void ProcessReceivedPacket(const void* data, size_t dataLength, BotStats& stats);
+	uint16_t NextBitmap();
+	void SendInputC2S(uint16_t bitmap);
+	void SendClockSyncC2S();
+
+	ENetHost* host = nullptr;
+	ENetPeer* peer = nullptr;
+	State state = Idle;
+	uint32_t index = 0;
+	BotInput input = BotInput::Random;
+
+	uint32_t tickRate = 0;
+	/// ticks sampled, drives the input pattern
+	uint32_t ticks = 0;
+	/// random pattern: bitmap held until holdUntil
+	uint16_t heldBitmap = 0;
+	uint32_t holdUntil = 0;
+
+	/// simulated network conditions on what the bot receives
+	Net::Conditioner conditioner;
+	Net::InputSender inputSender;
+	Net::ClockSync clock;
+	/// newest snapshot received, acknowledged with the inputs
+	uint64_t snapshotTick = 0;
+	uint64_t snapshotTime = 0;
+
+	flatbuffers::FlatBufferBuilder builder;
+};
+
+} // namespace Game
@@ -0,0 +1,288 @@
+//------------------------------------------------------------------------------
+// botapp.cc
+// (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "config.h"
+#include "botapp.h"
+#include "core/cvar.h"
+#include "net/packetpool.h"
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <algorithm>
+#include <thread>
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <unistd.h>
+#endif
+
+namespace Game
+{
+
+    using Clock = std::chrono::steady_clock;
+
+    static std::atomic<bool> running = false;
+
+    //------------------------------------------------------------------------------
+
+    static void HandleSignal(int)
+    {
+        running = false;
+    }
+
+    //------------------------------------------------------------------------------
+
+    BotApp::BotApp()
+    {
+        this->host = Core::CVarCreate(Core::CVar_String, "bot_host", "127.0.0.1", "Address of the server the bots connect to");
+        this->port = Core::CVarCreate(Core::CVar_Int, "bot_port", "7777", "Port of the server the bots connect to");
+        this->count = Core::CVarCreate(Core::CVar_Int, "bot_count", "100", "Number of simulated clients, the server needs sv_max_players at least as high");
+        this->ramp = Core::CVarCreate(Core::CVar_Float, "bot_ramp", "10", "Bots connected per second until bot_count are connected, 0 connects all at once");
+        this->duration = Core::CVarCreate(Core::CVar_Float, "bot_duration", "0", "Seconds to run before disconnecting and exiting, 0 runs until interrupted");
+        this->input = Core::CVarCreate(Core::CVar_Int, "bot_input", "0", "Input pattern, 0 random, 1 the same scripted loop for every bot, 2 idle");
+        this->compression = Core::CVarCreate(Core::CVar_Int, "bot_compress", "2", "Compress datagrams like sv_compress, 0 off, 1 ENet's range coder, 2 the model trained on game traffic");
+        this->reportInterval = Core::CVarCreate(Core::CVar_Float, "bot_report_interval", "1", "Seconds between printed measurements");
+        // Conditions what every bot receives, the seed is offset by the bot's index
+        Net::CreateConditionerCVars("bot_netsim_");
+    }
+
+    //------------------------------------------------------------------------------
+
+    BotApp::~BotApp() { }
+
+    //------------------------------------------------------------------------------
+
+    bool BotApp::Open()
+    {
+        App::Open();
+        if (!Net::InitializeENet()) {
+            fprintf(stderr, "An error Occured while initializing ENet!\n");
+            return false;
+        }
+
+#ifdef __linux__
+        this->poller = epoll_create1(0);
+#endif
+
+        std::signal(SIGINT, HandleSignal);
+        std::signal(SIGTERM, HandleSignal);
+        running = true;
+        return true;
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+        All bots are stepped together at the server's tick rate. In between the
+        process sleeps on their sockets and only services the bots that
+        received something, so a reply is timed when it arrives and not at the
+        next tick.
+    */
+    void BotApp::Run()
+    {
+        ENetAddress address;
+        if (enet_address_set_host(&address, Core::CVarReadString(this->host)) != 0) {
+            fprintf(stderr, "Could not resolve %s.\n", Core::CVarReadString(this->host));
+            return;
+        }
+        address.port = (enet_uint16)Core::CVarReadInt(this->port);
+
+        uint32_t const botCount = (uint32_t)std::max(0, Core::CVarReadInt(this->count));
+        float const rampRate = Core::CVarReadFloat(this->ramp);
+        float const runSeconds = Core::CVarReadFloat(this->duration);
+        double const intervalSeconds = std::max(0.1f, Core::CVarReadFloat(this->reportInterval));
+        BotInput const pattern = (BotInput)std::clamp(Core::CVarReadInt(this->input), 0, 2);
+        Net::Conditioner::Settings const conditions = Net::ReadConditionerCVars("bot_netsim_");
+        this->conditioned = conditions.Active();
+        Net::CompressionMethod const compression = Net::PacketCompressor::MethodFromInt(Core::CVarReadInt(this->compression));
+        this->bots = std::vector<Bot>(botCount);
+
+        Clock::time_point const start = Clock::now();
+        Clock::time_point nextTick = start;
+        Clock::time_point nextSpawn = start;
+        Clock::time_point nextReport = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(intervalSeconds));
+        Clock::duration const spawnDelay = rampRate > 0.0f ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / rampRate)) : Clock::duration::zero();
+        Clock::duration tickDelay = std::chrono::microseconds(1000000 / 60);
+        uint32_t spawned = 0;
+
+        printf("%8s %6s %8s %8s %8s %8s %8s %10s %10s %8s\n",
+            "time s", "bots", "tick/s", "rtt p50", "p95", "p99", "max ms", "in kB/s", "out kB/s", "loss %");
+
+        while (running)
+        {
+            Clock::time_point now = Clock::now();
+            if (runSeconds > 0.0f && now - start >= std::chrono::duration<double>(runSeconds))
+                break;
+
+            while (spawned < botCount && now >= nextSpawn)
+            {
+                if (!this->bots[spawned].Connect(address, spawned, pattern, conditions, compression)) {
+                    fprintf(stderr, "Could not create the host of bot %u.\n", spawned);
+                    running = false;
+                    break;
+                }
+                this->Watch(spawned);
+                spawned++;
+                nextSpawn += spawnDelay;
+            }
+
+            if (now >= nextTick)
+            {
+                for (uint32_t i = 0; i < spawned; i++)
+                {
+                    this->bots[i].Service(this->stats);
+                    this->bots[i].Tick();
+                }
+
+                // Follow the server's rate once it is known, and rather skip ticks than send bursts
+                if (spawned > 0 && this->bots[0].TickRate() > 0)
+                    tickDelay = std::chrono::microseconds(1000000 / this->bots[0].TickRate());
+                nextTick += tickDelay;
+                if (now - nextTick > tickDelay * 4)
+                    nextTick = now + tickDelay;
+            }
+
+            if (now >= nextReport)
+            {
+                this->Report(std::chrono::duration<double>(now - start).count(), intervalSeconds);
+                nextReport += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(intervalSeconds));
+            }
+
+            Clock::time_point wake = std::min(nextTick, nextReport);
+            if (spawned < botCount)
+                wake = std::min(wake, nextSpawn);
+            now = Clock::now();
+            if (wake > now)
+                this->Wait((int)std::chrono::duration_cast<std::chrono::milliseconds>(wake - now).count());
+        }
+
+        this->DisconnectAll();
+    }
+
+    //------------------------------------------------------------------------------
+
+    void BotApp::Watch(uint32_t index)
+    {
+#ifdef __linux__
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.u32 = index;
+        epoll_ctl(this->poller, EPOLL_CTL_ADD, this->bots[index].Socket(), &event);
+#endif
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+        Without epoll every bot is polled once a millisecond, which costs a
+        system call per bot and adds up to a millisecond to the round trips.
+        Conditioned bots are also woken every millisecond to release the
+        datagrams that became due.
+    */
+    void BotApp::Wait(int timeoutMs)
+    {
+        if (this->conditioned)
+        {
+            for (Bot& bot : this->bots)
+                bot.Deliver();
+            timeoutMs = std::min(timeoutMs, 1);
+        }
+#ifdef __linux__
+        epoll_event events[256];
+        int const ready = epoll_wait(this->poller, events, 256, timeoutMs);
+        for (int i = 0; i < ready; i++)
+            this->bots[events[i].data.u32].Service(this->stats);
+#else
+        std::this_thread::sleep_for(std::chrono::milliseconds(std::min(timeoutMs, 1)));
+        for (Bot& bot : this->bots)
+            bot.Service(this->stats);
+#endif
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+        The tick rate is the server ticks per second of server time between the
+        snapshots all bots received, it drops below sv_tickrate once the server
+        has to skip ticks.
+    */
+    void BotApp::Report(double seconds, double intervalSeconds)
+    {
+        uint32_t connected = 0;
+        for (const Bot& bot : this->bots)
+        {
+            if (bot.GetState() == Bot::Connected)
+                connected++;
+        }
+
+        std::vector<uint32_t>& roundTrips = this->stats.roundTrips;
+        auto percentile = [&roundTrips](double p) -> double
+        {
+            if (roundTrips.empty())
+                return 0.0;
+            size_t const i = std::min(roundTrips.size() - 1, (size_t)(p * roundTrips.size()));
+            std::nth_element(roundTrips.begin(), roundTrips.begin() + i, roundTrips.end());
+            return roundTrips[i] / 1000.0;
+        };
+        double const p50 = percentile(0.5);
+        double const p95 = percentile(0.95);
+        double const p99 = percentile(0.99);
+        double const max = roundTrips.empty() ? 0.0 : *std::max_element(roundTrips.begin(), roundTrips.end()) / 1000.0;
+
+        double const tickRate = this->stats.serverTime > 0 ? this->stats.serverTicks * 1000.0 / this->stats.serverTime : 0.0;
+        uint64_t const expected = this->stats.snapshots + this->stats.snapshotsLost;
+        double const loss = expected > 0 ? 100.0 * this->stats.snapshotsLost / expected : 0.0;
+
+        printf("%8.1f %6u %8.1f %8.2f %8.2f %8.2f %8.2f %10.1f %10.1f %8.2f\n",
+            seconds, connected, tickRate, p50, p95, p99, max,
+            this->stats.bytesReceived / intervalSeconds / 1000.0,
+            this->stats.bytesSent / intervalSeconds / 1000.0,
+            loss);
+        if (this->stats.disconnects > 0)
+            printf("%u bots disconnected or failed to connect.\n", this->stats.disconnects);
+        this->stats.Clear();
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+        Bots that simply vanish would hold their server slot until ENet times
+        them out.
+    */
+    void BotApp::DisconnectAll()
+    {
+        for (Bot& bot : this->bots)
+            bot.Disconnect();
+
+        Clock::time_point const deadline = Clock::now() + std::chrono::seconds(1);
+        while (Clock::now() < deadline)
+        {
+            bool pending = false;
+            for (Bot& bot : this->bots)
+            {
+                bot.Service(this->stats);
+                pending |= (bot.GetState() == Bot::Connected || bot.GetState() == Bot::Connecting);
+            }
+            if (!pending)
+                break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    //------------------------------------------------------------------------------
+
+    void BotApp::Close()
+    {
+        this->bots.clear();
+#ifdef __linux__
+        if (this->poller != -1)
+            close(this->poller);
+        this->poller = -1;
+#endif
+        App::Close();
+    }
+
+    //------------------------------------------------------------------------------
+
+    void BotApp::Exit()
+    {
+        running = false;
+    }
+
+} // namespace Game
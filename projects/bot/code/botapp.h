@@ -0,0 +1,67 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+	Load generator application
+
+	Connects a growing number of simulated clients to a server from one
+	process and prints the server's tick rate, round trips, traffic and
+	snapshot loss as the player count ramps up. Needs no window, GL context or
+	network beyond loopback.
+
+	(C) 2024 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include "core/app.h"
+#include "bot.h"
+#include <vector>
+
+namespace Core
+{
+struct CVar;
+}
+
+namespace Game
+{
+class BotApp : public Core::App
+{
+public:
+	/// constructor
+	BotApp();
+	/// destructor
+	~BotApp();
+
+	/// open app
+	bool Open();
+	/// run app until bot_duration is over or the process is interrupted
+	void Run();
+	/// close app
+	void Close();
+	/// exit app
+	void Exit();
+private:
+	/// start watching the socket of bot index
+	void Watch(uint32_t index);
+	/// service the bots with pending data until timeoutMs passed or data arrived
+	void Wait(int timeoutMs);
+	/// print one line of stats and start a new interval
+	void Report(double seconds, double intervalSeconds);
+	/// disconnect all bots and wait for the server to confirm
+	void DisconnectAll();
+
+	std::vector<Bot> bots;
+	BotStats stats;
+	/// epoll instance watching all bot sockets, -1 where there is none
+	int poller = -1;
+	/// the bots hold datagrams back, so the wait may not outlast a millisecond
+	bool conditioned = false;
+
+	Core::CVar* host = nullptr;
+	Core::CVar* port = nullptr;
+	Core::CVar* count = nullptr;
+	Core::CVar* ramp = nullptr;
+	Core::CVar* duration = nullptr;
+	Core::CVar* input = nullptr;
+	Core::CVar* reportInterval = nullptr;
+	Core::CVar* compression = nullptr;
+};
+} // namespace Game
@@ -0,0 +1,21 @@
+//------------------------------------------------------------------------------
+// botmain.cc
+// (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "config.h"
+#include "botapp.h"
+#include "core/cvar.h"
+
+int
+main(int argc, const char** argv)
+{
+	Game::BotApp app;
+	Core::CVarParseCommandLine(argc, argv);
+	if (app.Open())
+	{
+		app.Run();
+		app.Close();
+	}
+	app.Exit();
+	
+}
@@ -0,0 +1,70 @@
+//------------------------------------------------------------------------------
+// allocstats.cc
+// (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "config.h"
+#include "allocstats.h"
+#include "net/packetpool.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace Game
+{
+    static std::atomic<uint64_t> heapAllocations = 0;
+    static std::atomic<uint64_t> heapBytes = 0;
+
+    //------------------------------------------------------------------------------
+
+    AllocStats GetAllocStats()
+    {
+        AllocStats stats;
+        stats.allocations = heapAllocations.load(std::memory_order_relaxed);
+        stats.bytes = heapBytes.load(std::memory_order_relaxed);
+        Net::PoolStats const pool = Net::GetPoolStats();
+        stats.enetAllocations = pool.allocations;
+        stats.enetBytes = pool.bytes;
+        return stats;
+    }
+
+} // namespace Game
+
+//------------------------------------------------------------------------------
+/**
+    Replacements of the global allocation functions. The nothrow and array
+    forms of the standard library forward to these.
+*/
+void* operator new(size_t size)
+{
+    Game::heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    Game::heapBytes.fetch_add(size, std::memory_order_relaxed);
+    void* memory = malloc(size != 0 ? size : 1);
+    if (memory == nullptr)
+        throw std::bad_alloc();
+    return memory;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* memory) noexcept
+{
+    free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+    free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+    free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept
+{
+    free(memory);
+}
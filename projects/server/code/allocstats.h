@@ -0,0 +1,36 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+	Heap allocation counters
+
+	allocstats.cc replaces the global operator new and delete of the server
+	executables to count every C++ heap allocation. ENet allocates from the
+	Net::PoolMalloc pool, whose counts are reported separately.
+
+	(C) 2024 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include <stdint.h>
+#include <stddef.h>
+
+namespace Game
+{
+struct AllocStats
+{
+	/// operator new calls and bytes
+	uint64_t allocations = 0;
+	uint64_t bytes = 0;
+	/// ENet allocations and bytes
+	uint64_t enetAllocations = 0;
+	uint64_t enetBytes = 0;
+
+	AllocStats operator-(const AllocStats& rhs) const
+	{
+		return { allocations - rhs.allocations, bytes - rhs.bytes, enetAllocations - rhs.enetAllocations, enetBytes - rhs.enetBytes };
+	}
+};
+
+/// totals since process start
+AllocStats GetAllocStats();
+
+} // namespace Game
@@ -0,0 +1,689 @@
+//------------------------------------------------------------------------------
+// benchapp.cc
+// (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "config.h"
+#include "benchapp.h"
+#include "core/cvar.h"
+#include "core/random.h"
+#include "net/capture.h"
+#include "net/loopback.h"
+#include "net/quantize.h"
+#include "net/snapshot.h"
+#include "bot.h"
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+#include "enet/enet.h"
+
+namespace Game
+{
+
+    static std::atomic<bool> running = false;
+
+    //------------------------------------------------------------------------------
+
+    static void HandleSignal(int)
+    {
+        running = false;
+    }
+
+    //------------------------------------------------------------------------------
+
+    BenchApp::BenchApp()
+    {
+        this->benchCollisions = Core::CVarCreate(Core::CVar_Int, "sv_bench_collisions", "0", "Time this many collision steps per ship count");
+        this->benchSockets = Core::CVarCreate(Core::CVar_Int, "sv_bench_sockets", "0", "Time this many ticks of snapshot traffic to loopback clients per client count, with and without socket batching");
+        this->maxPlayers = Core::CVarCreate(Core::CVar_Int, "sv_max_players", "32", "Most clients the server of sv_bench_collisions and sv_bench_sockets accepts");
+        this->benchCompression = Core::CVarCreate(Core::CVar_String, "sv_bench_compression", "", "Compress every message of a file recorded with sv_capture and of its replay with each sv_compress method and print ratio and speed");
+        this->compressionPrior = Core::CVarCreate(Core::CVar_String, "sv_bench_compression_prior", "", "Train the compression model's prior on the sv_bench_compression session and write it to this file, to replace engine/net/compressorprior.h");
+        this->benchLoopback = Core::CVarCreate(Core::CVar_Int, "sv_bench_loopback", "0", "Run the server and this many bot clients in one process over an in-memory network in lockstep and print the cost per tick");
+        this->benchLoopbackTicks = Core::CVarCreate(Core::CVar_Int, "sv_bench_loopback_ticks", "600", "Ticks sv_bench_loopback measures, after all bots are in the game");
+        this->testQuantize = Core::CVarCreate(Core::CVar_Int, "sv_test_quantize", "0", "Round trip boundary values and this many random ones through the quantized wire formats, check the error bounds and exit with 1 if one is exceeded");
+    }
+
+    //------------------------------------------------------------------------------
+
+    BenchApp::~BenchApp() { }
+
+    //------------------------------------------------------------------------------
+
+    bool BenchApp::Open()
+    {
+        App::Open();
+        std::signal(SIGINT, HandleSignal);
+        std::signal(SIGTERM, HandleSignal);
+        running = true;
+        return true;
+    }
+
+    //------------------------------------------------------------------------------
+
+    void BenchApp::Run()
+    {
+        if (Core::CVarReadInt(this->testQuantize) > 0)
+        {
+            if (!this->RunQuantizeTest(Core::CVarReadInt(this->testQuantize)))
+                this->exitCode = 1;
+            return;
+        }
+
+        const char* const benchPath = Core::CVarReadString(this->benchCompression);
+        if (benchPath[0] != '\0')
+        {
+            this->RunCompressionBenchmark(benchPath);
+            return;
+        }
+
+        if (Core::CVarReadInt(this->benchLoopback) > 0)
+        {
+            this->RunLoopbackBenchmark(std::min<int>(Core::CVarReadInt(this->benchLoopback), ENET_PROTOCOL_MAXIMUM_PEER_ID), std::max(1, Core::CVarReadInt(this->benchLoopbackTicks)));
+            return;
+        }
+
+        bool const collisions = Core::CVarReadInt(this->benchCollisions) > 0;
+        bool const sockets = Core::CVarReadInt(this->benchSockets) > 0;
+        if (!collisions && !sockets)
+        {
+            printf("Nothing to run, pass one of -sv_test_quantize <samples>, -sv_bench_compression <capture>, -sv_bench_loopback <clients>, -sv_bench_collisions <ticks> or -sv_bench_sockets <ticks>.\n");
+            this->exitCode = 1;
+            return;
+        }
+
+        if (!this->server.Open(7777, std::clamp<int>(Core::CVarReadInt(this->maxPlayers), 1, ENET_PROTOCOL_MAXIMUM_PEER_ID)))
+        {
+            this->exitCode = 1;
+            return;
+        }
+
+        if (collisions)
+            this->RunCollisionBenchmark(Core::CVarReadInt(this->benchCollisions));
+        else
+            this->RunSocketBenchmark(Core::CVarReadInt(this->benchSockets));
+        this->server.Close();
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+        Ships are scattered in the play area with the laser count a full server
+        sees, every ship firing at the 200 ms rate with 10 s laser lifetime keeps
+        100 lasers alive.
+    */
+    void BenchApp::RunCollisionBenchmark(int ticks)
+    {
+        Core::CVar* broadphase = Core::CVarGet("sv_broadphase");
+        int const previous = Core::CVarReadInt(broadphase);
+        uint32_t const lasersPerShip = 100;
+        float const area = 60.0f;
+
+        printf("%8s %10s %14s %14s\n", "ships", "lasers", "all pairs ms", "broadphase ms");
+        for (uint32_t ships = 8; ships <= 512 && running; ships *= 2)
+        {
+            double tickMs[2] = {};
+            for (int mode = 0; mode < 2; mode++)
+            {
+                this->server.spaceShips.Clear();
+                this->server.lasers.Clear();
+                for (uint32_t i = 0; i < ships; i++)
+                {
+                    SpaceShip ship;
+                    ship.uuid = i;
+                    ship.position = glm::vec3(Core::RandomFloatNTP(), Core::RandomFloatNTP(), Core::RandomFloatNTP()) * area;
+                    this->server.spaceShips.Insert(ship.uuid, ship);
+                }
+                for (uint32_t i = 0; i < ships * lasersPerShip; i++)
+                {
+                    glm::vec3 const position = glm::vec3(Core::RandomFloatNTP(), Core::RandomFloatNTP(), Core::RandomFloatNTP()) * area;
+                    glm::quat const direction = glm::normalize(glm::quat(Core::RandomFloatNTP(), Core::RandomFloatNTP(), Core::RandomFloatNTP(), Core::RandomFloatNTP()));
+                    this->server.lasers.Insert(ships + i, Laser(ships + i, 0, 0, position, direction));
+                }
+
+                Core::CVarWriteInt(broadphase, mode);
+                auto const start = std::chrono::steady_clock::now();
+                for (int t = 0; t < ticks; t++)
+                    this->server.CheckCollisions(0);
+                tickMs[mode] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / ticks;
+            }
+            printf("%8u %10u %14.3f %14.3f\n", ships, ships * lasersPerShip, tickMs[0], tickMs[1]);
+        }
+
+        Core::CVarWriteInt(broadphase, previous);
+        this->server.spaceShips.Clear();
+        this->server.lasers.Clear();
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+        Each tick the server sends every client a snapshot sized packet and
+        receives an input sized one from each, like the game does. Only the
+        server's calls are timed, the clients run in between. System calls
+        are counted by ENet, a batched tick should make one per batch of
+        ENET_HOST_SOCKET_BATCH_SIZE datagrams each way.
+    */
+    void BenchApp::RunSocketBenchmark(int ticks)
+    {
+        size_t const snapshotSize = 600;
+        size_t const inputSize = 32;
+        std::vector<uint8_t> const snapshot(snapshotSize, 0xAB);
+        std::vector<uint8_t> const input(inputSize, 0xCD);
+
+        printf("%8s %8s %14s %14s %10s\n", "clients", "batched", "sends/tick", "receives/tick", "us/tick");
+        for (size_t clients = 16; clients <= 256 && running; clients *= 4)
+        {
+            for (int batched = 0; batched < 2 && running; batched++)
+            {
+                ENetAddress address;
+                address.host = ENET_HOST_ANY;
+                address.port = 0;
+                ENetHost* server = enet_host_create(&address, clients, 1, 0, 0);
+                if (server == nullptr || enet_socket_get_address(server->socket, &address) != 0)
+                {
+                    fprintf(stderr, "Could not create the benchmark host.\n");
+                    if (server != nullptr)
+                        enet_host_destroy(server);
+                    return;
+                }
+                enet_address_set_host(&address, "127.0.0.1");
+                if (batched != 0)
+                    enet_host_socket_batching(server, 1);
+
+                std::vector<ENetHost*> hosts;
+                for (size_t i = 0; i < clients; i++)
+                {
+                    ENetHost* client = enet_host_create(nullptr, 1, 1, 0, 0);
+                    if (client == nullptr)
+                        break;
+                    enet_host_connect(client, &address, 1, 0);
+                    hosts.push_back(client);
+                }
+
+                // Connect everyone before timing, a second is plenty on loopback
+                ENetEvent event;
+                size_t connected = 0;
+                auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+                while (connected < hosts.size() && std::chrono::steady_clock::now() < deadline)
+                {
+                    for (ENetHost* client : hosts)
+                    {
+                        while (enet_host_service(client, &event, 0) > 0)
+                        {
+                            if (event.type == ENET_EVENT_TYPE_RECEIVE)
+                                enet_packet_destroy(event.packet);
+                        }
+                    }
+                    while (enet_host_service(server, &event, 1) > 0)
+                    {
+                        if (event.type == ENET_EVENT_TYPE_CONNECT)
+                            connected++;
+                        else if (event.type == ENET_EVENT_TYPE_RECEIVE)
+                            enet_packet_destroy(event.packet);
+                    }
+                }
+
+                server->totalSendCalls = 0;
+                server->totalReceiveCalls = 0;
+                std::chrono::steady_clock::duration elapsed = {};
+                for (int t = 0; t < ticks && running; t++)
+                {
+                    auto start = std::chrono::steady_clock::now();
+                    for (size_t i = 0; i < server->peerCount; i++)
+                    {
+                        ENetPeer* peer = &server->peers[i];
+                        if (peer->state == ENET_PEER_STATE_CONNECTED)
+                            enet_peer_send(peer, 0, enet_packet_create(snapshot.data(), snapshot.size(), 0));
+                    }
+                    enet_host_flush(server);
+                    elapsed += std::chrono::steady_clock::now() - start;
+
+                    for (ENetHost* client : hosts)
+                    {
+                        while (enet_host_service(client, &event, 0) > 0)
+                        {
+                            if (event.type == ENET_EVENT_TYPE_RECEIVE)
+                                enet_packet_destroy(event.packet);
+                        }
+                        if (client->peers[0].state == ENET_PEER_STATE_CONNECTED)
+                            enet_peer_send(&client->peers[0], 0, enet_packet_create(input.data(), input.size(), 0));
+                        enet_host_flush(client);
+                    }
+
+                    start = std::chrono::steady_clock::now();
+                    while (enet_host_service(server, &event, 0) > 0)
+                    {
+                        if (event.type == ENET_EVENT_TYPE_RECEIVE)
+                            enet_packet_destroy(event.packet);
+                    }
+                    elapsed += std::chrono::steady_clock::now() - start;
+                }
+
+                printf("%8zu %8s %14.1f %14.1f %10.1f%s\n", clients, batched != 0 ? "yes" : "no",
+                    (double)server->totalSendCalls / ticks,
+                    (double)server->totalReceiveCalls / ticks,
+                    std::chrono::duration<double, std::micro>(elapsed).count() / ticks,
+                    connected < clients ? " (not all clients connected)" : "");
+
+                for (ENetHost* client : hosts)
+                    enet_host_destroy(client);
+                enet_host_destroy(server);
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+        Every tick the server steps first, handling the input of the tick
+        before and sending its messages, then every bot receives them and
+        sends its next input. Nothing waits for time to pass, so each part
+        costs only what it computes, serializes and copies, ENet included.
+        ENet's clock is held at the tick's time for every host, so the
+        traffic does not depend on the speed of the machine. The bots share
+        one thread with the server here, their time is listed apart so it
+        can be left out.
+    */
+    void BenchApp::RunLoopbackBenchmark(int clients, int ticks)
+    {
+        Net::Loopback loopback;
+        uint16_t const port = 7777;
+        if (!this->server.Open(port, clients, &loopback))
+            return;
+
+        {
+            Net::CompressionMethod const compression = Net::PacketCompressor::MethodFromInt(Core::CVarReadInt(Core::CVarGet("sv_compress")));
+            std::vector<Bot> bots(clients);
+            BotStats stats;
+            this->server.HoldENetTime();
+            for (int i = 0; i < clients; i++)
+            {
+                if (!bots[i].Connect(Net::Loopback::Address(port), i, BotInput::Random, Net::Conditioner::Settings(), compression, &loopback)) {
+                    fprintf(stderr, "Could not create the host of bot %d.\n", i);
+                    running = false;
+                    break;
+                }
+            }
+
+            auto const joined = [&]() {
+                return std::all_of(bots.begin(), bots.end(), [](const Bot& bot) { return bot.GetState() == Bot::Connected && bot.TickRate() > 0; });
+            };
+            auto const stepClients = [&]() {
+                for (Bot& bot : bots)
+                {
+                    this->server.HoldENetTime();
+                    bot.Service(stats);
+                    bot.Tick();
+                }
+            };
+
+            // Connecting takes a few round trips, one per step
+            int joinTicks = 0;
+            while (running && !joined() && joinTicks < 600)
+            {
+                this->server.Step();
+                stepClients();
+                joinTicks++;
+            }
+            if (!joined()) {
+                fprintf(stderr, "Not all bots joined the game within %d ticks.\n", joinTicks);
+                running = false;
+            }
+
+            stats.Clear();
+            Net::Loopback::Stats const before = loopback.stats;
+            std::chrono::steady_clock::duration serverTime = {};
+            std::chrono::steady_clock::duration clientTime = {};
+            int measured = 0;
+            for (; running && measured < ticks; measured++)
+            {
+                auto const start = std::chrono::steady_clock::now();
+                this->server.Step();
+                auto const stepped = std::chrono::steady_clock::now();
+                stepClients();
+                serverTime += stepped - start;
+                clientTime += std::chrono::steady_clock::now() - stepped;
+            }
+
+            if (measured > 0)
+            {
+                printf("%d clients joined in %d ticks, %d ticks in lockstep at %d ticks per second.\n", clients, joinTicks, measured, this->server.scheduler.GetTickRate());
+                printf("%16s %12s\n", "per tick", "");
+                printf("%16s %12.1f us\n", "server", std::chrono::duration<double, std::micro>(serverTime).count() / measured);
+                printf("%16s %12.1f us\n", "clients", std::chrono::duration<double, std::micro>(clientTime).count() / measured);
+                printf("%16s %12.1f\n", "datagrams", (double)(loopback.stats.datagrams - before.datagrams) / measured);
+                printf("%16s %12.0f\n", "bytes", (double)(loopback.stats.bytes - before.bytes) / measured);
+                printf("%16s %12.2f\n", "snapshots", (double)stats.snapshots / measured / clients);
+                printf("%16s %12.2f\n", "snapshots lost", (double)stats.snapshotsLost / measured / clients);
+                printf("Snapshots lost %llu, disconnects %u, undeliverable datagrams %llu.\n",
+                    (unsigned long long)stats.snapshotsLost, stats.disconnects, (unsigned long long)loopback.stats.undeliverable);
+            }
+        }
+
+        this->server.Close();
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+        Players go through the snapshot encoding and lasers through their
+        spawn message, so everything between the state and the bytes is
+        covered. Besides the error bounds from quantize.h, what a client
+        reads has to equal what the server snaps, or delta baselines drift.
+    */
+    bool BenchApp::RunQuantizeTest(int samples)
+    {
+        struct Check
+        {
+            const char* name;
+            double bound;
+            double maxError = 0.0;
+            uint64_t values = 0;
+            uint64_t failures = 0;
+
+            void Add(double error)
+            {
+                this->values++;
+                this->maxError = std::max(this->maxError, error);
+                if (!(error <= this->bound))
+                    this->failures++;
+            }
+        };
+        // Half a step of each format, rounded up
+        Check position = { "position", 0.0002 };
+        Check clamped = { "clamped position", 0.0 };
+        Check velocity = { "velocity |v|<4", 0.0017 };
+        Check rotation = { "rotation deg", 0.24 };
+        Check snapped = { "read != snapped", 0.0 };
+        Check time = { "time offset ms", 0.0 };
+        Check malformed = { "malformed", 0.0 };
+
+        auto const angle = [](const glm::quat& a, const glm::quat& b) {
+            double const dot = std::fabs((double)a.x * b.x + (double)a.y * b.y + (double)a.z * b.z + (double)a.w * b.w);
+            return 2.0 * std::acos(std::min(1.0, dot)) * 180.0 / 3.14159265358979323846;
+        };
+        auto const randomQuat = []() {
+            glm::quat q(Core::RandomFloatNTP(), Core::RandomFloatNTP(), Core::RandomFloatNTP(), Core::RandomFloatNTP());
+            return glm::length(q) > 0.001f ? glm::normalize(q) : glm::identity<glm::quat>();
+        };
+
+        float const bound = Net::PositionBound;
+        float const edges[] = { 0.0f, -0.0f, 0.5f, -1.0f, bound, -bound, std::nextafter(bound, 0.0f), std::nextafter(-bound, 0.0f) };
+        float const halfEdges[] = { 0.0f, 4.0f, -4.0f, 3.9999f, 0.0001f, 1.0f / 3.0f, -2.5f };
+        float const s = 0.70710678f;
+        glm::quat const quatEdges[] = {
+            glm::identity<glm::quat>(), glm::quat(0, 1, 0, 0), glm::quat(0, 0, 1, 0), glm::quat(0, 0, 0, 1), glm::quat(-1, 0, 0, 0),
+            glm::quat(0.5f, 0.5f, 0.5f, 0.5f), glm::quat(-0.5f, 0.5f, -0.5f, 0.5f), glm::quat(s, s, 0, 0), glm::quat(0, 0, -s, s),
+            glm::normalize(glm::quat(1.0f, 1.0f, 1.0f, 0.999f))
+        };
+
+        // Players, the boundary values first
+        std::vector<Net::PlayerState> players;
+        for (float x : edges)
+        {
+            for (float v : halfEdges)
+            {
+                Net::PlayerState player;
+                player.position = glm::vec3(x, -x, v);
+                player.velocity = glm::vec3(v, -v, v * 0.5f);
+                player.acceleration = glm::vec3(-v);
+                players.push_back(player);
+            }
+        }
+        for (const glm::quat& q : quatEdges)
+        {
+            Net::PlayerState player;
+            player.direction = q;
+            players.push_back(player);
+        }
+        for (int i = 0; i < samples; i++)
+        {
+            Net::PlayerState player;
+            player.position = glm::vec3(Core::RandomFloatNTP(), Core::RandomFloatNTP(), Core::RandomFloatNTP()) * bound;
+            player.velocity = glm::vec3(Core::RandomFloatNTP(), Core::RandomFloatNTP(), Core::RandomFloatNTP()) * 4.0f;
+            player.acceleration = glm::vec3(Core::RandomFloatNTP(), Core::RandomFloatNTP(), Core::RandomFloatNTP()) * 4.0f;
+            player.direction = randomQuat();
+            players.push_back(player);
+        }
+
+        Net::Snapshot sent;
+        sent.players = players;
+        for (size_t i = 0; i < sent.players.size(); i++)
+            sent.players[i].uuid = (uint32_t)i + 1;
+        std::vector<uint8_t> data;
+        Net::WriteSnapshotDelta(nullptr, sent, Net::Encoding::Quantized, data);
+        Net::Snapshot received;
+        malformed.Add(Net::ReadSnapshotDelta(nullptr, data.data(), data.size(), Net::Encoding::Quantized, received) && received.players.size() == sent.players.size() ? 0.0 : 1.0);
+        for (size_t i = 0; i < received.players.size() && i < sent.players.size(); i++)
+        {
+            const Net::PlayerState& in = sent.players[i];
+            const Net::PlayerState& out = received.players[i];
+            for (int axis = 0; axis < 3; axis++)
+                position.Add(std::fabs((double)in.position[axis] - out.position[axis]));
+            velocity.Add(glm::length(glm::dvec3(in.velocity) - glm::dvec3(out.velocity)));
+            velocity.Add(glm::length(glm::dvec3(in.acceleration) - glm::dvec3(out.acceleration)));
+            rotation.Add(angle(in.direction, out.direction));
+
+            Net::PlayerState snap = in;
+            Net::QuantizePlayerState(snap);
+            bool const same = snap.position == out.position && snap.velocity == out.velocity && snap.acceleration == out.acceleration &&
+                snap.direction.x == out.direction.x && snap.direction.y == out.direction.y && snap.direction.z == out.direction.z && snap.direction.w == out.direction.w;
+            snapped.Add(same ? 0.0 : 1.0);
+        }
+
+        // Outside the bound positions clamp to it
+        float const outside[] = { bound * 1.5f, -bound * 1.5f, 1e9f, -1e9f };
+        for (float x : outside)
+        {
+            glm::vec3 const snap = Net::SnapPosition(glm::vec3(x));
+            clamped.Add(std::fabs((double)snap.x - glm::clamp(x, -bound, bound)));
+        }
+
+        // Lasers, with offsets on and past both ends of the 16 bit range
+        uint64_t const baseTime = 1000000;
+        int64_t const offsets[] = { 0, 1, -1, INT16_MAX, INT16_MIN, INT16_MAX + 1, INT16_MIN - 1, 100000 };
+        for (int i = 0; i < samples + (int)std::size(offsets); i++)
+        {
+            int64_t const offset = i < (int)std::size(offsets) ? offsets[i] : (int64_t)(Core::RandomFloatNTP() * INT16_MAX);
+            Net::LaserState laser;
+            laser.uuid = (uint32_t)i * 7919;
+            laser.startTime = baseTime + offset;
+            laser.endTime = laser.startTime + (uint64_t)(Core::RandomFloat() * 5000.0f);
+            laser.origin = i < (int)std::size(edges) ? glm::vec3(edges[i]) : glm::vec3(Core::RandomFloatNTP(), Core::RandomFloatNTP(), Core::RandomFloatNTP()) * bound;
+            laser.direction = i < (int)std::size(quatEdges) ? quatEdges[i] : randomQuat();
+
+            data.clear();
+            Net::WriteLaserState(laser, baseTime, data);
+            Net::LaserState out;
+            if (!Net::ReadLaserState(data.data(), data.size(), baseTime, out) || out.uuid != laser.uuid) {
+                malformed.Add(1.0);
+                continue;
+            }
+            int64_t const expected = glm::clamp<int64_t>(offset, INT16_MIN, INT16_MAX);
+            time.Add(std::fabs((double)((int64_t)(out.startTime - baseTime) - expected)));
+            time.Add(std::fabs((double)((int64_t)(out.endTime - out.startTime) - (int64_t)(laser.endTime - laser.startTime))));
+            for (int axis = 0; axis < 3; axis++)
+                position.Add(std::fabs((double)laser.origin[axis] - out.origin[axis]));
+            rotation.Add(angle(laser.direction, out.direction));
+        }
+
+        // Cut short data has to be rejected, not read past
+        for (size_t length = 0; length < data.size(); length++)
+        {
+            Net::LaserState out;
+            malformed.Add(Net::ReadLaserState(data.data(), length, baseTime, out) ? 1.0 : 0.0);
+        }
+
+        const Check* const checks[] = { &position, &clamped, &velocity, &rotation, &snapped, &time, &malformed };
+        bool passed = true;
+        printf("%20s %10s %12s %12s %10s\n", "check", "values", "max error", "bound", "failures");
+        for (const Check* check : checks)
+        {
+            printf("%20s %10llu %12.6f %12.6f %10llu\n", check->name, (unsigned long long)check->values, check->maxError, check->bound, (unsigned long long)check->failures);
+            passed = passed && check->failures == 0;
+        }
+        printf("%s\n", passed ? "All quantization bounds hold." : "Quantization bounds exceeded.");
+        return passed;
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+        The messages are what the clients sent, read from the capture, and what
+        the server sent, from replaying it. Each is compressed on its own like
+        a datagram, without the few bytes of ENet headers around it. A message
+        that does not get smaller counts with its own size, ENet sends those
+        uncompressed.
+    */
+    void BenchApp::RunCompressionBenchmark(const char* path)
+    {
+        std::vector<uint8_t> bytes;
+        std::vector<size_t> offsets;
+        auto const add = [&](const uint8_t* data, size_t size) {
+            if (size == 0 || size > ENET_PROTOCOL_MAXIMUM_MTU)
+                return;
+            offsets.push_back(bytes.size());
+            bytes.insert(bytes.end(), data, data + size);
+        };
+
+        Net::CaptureReader reader;
+        if (!reader.Open(path)) {
+            fprintf(stderr, "Could not read the capture file %s, it is missing, not a capture of this version or its header is corrupt.\n", path);
+            return;
+        }
+        Net::CaptureRecord record;
+        const uint8_t* data = nullptr;
+        while (reader.Next(record, data))
+        {
+            if (record.kind == Net::CaptureRecord::Receive)
+                add(data, record.length);
+        }
+        reader.Close();
+        size_t const received = offsets.size();
+
+        GameServer::ReplayResult result;
+        if (!this->server.Replay(path, 0, result, add))
+            return;
+        offsets.push_back(bytes.size());
+        size_t const messages = offsets.size() - 1;
+        printf("%zu messages, %zu received and %zu sent, %.1f bytes on average.\n", messages, received, messages - received, messages > 0 ? (double)bytes.size() / messages : 0.0);
+        if (messages == 0)
+            return;
+
+        Net::PacketCompressor compressor;
+        const char* const priorPath = Core::CVarReadString(this->compressionPrior);
+        if (priorPath[0] != '\0')
+        {
+            static uint32_t counts[Net::PacketCompressor::ContextCount][256];
+            for (size_t i = 0; i < messages; i++)
+                Net::PacketCompressor::Count(&bytes[offsets[i]], offsets[i + 1] - offsets[i], counts);
+            Net::PacketCompressor::Model prior;
+            Net::PacketCompressor::Train(counts, prior);
+            compressor.SetModel(prior);
+            if (!this->WritePrior(priorPath, prior, path, messages))
+                fprintf(stderr, "Could not write the prior to %s.\n", priorPath);
+        }
+
+        struct Method
+        {
+            const char* name;
+            Net::CompressionMethod method;
+            Net::PacketCompressor* compressor;
+        };
+        Method const methods[] = {
+            { "range coder", Net::CompressionMethod::RangeCoder, &compressor },
+            { "model", Net::CompressionMethod::Model, &compressor },
+        };
+
+        printf("%16s %12s %12s %8s %12s %12s\n", "method", "bytes", "compressed", "ratio", "encode ns", "decode ns");
+        std::vector<uint8_t> compressed(ENET_PROTOCOL_MAXIMUM_MTU * 2);
+        std::vector<uint8_t> decompressed(ENET_PROTOCOL_MAXIMUM_MTU);
+        for (const Method& method : methods)
+        {
+            uint64_t total = 0;
+            uint64_t encodeNs = 0;
+            uint64_t decodeNs = 0;
+            size_t mismatches = 0;
+            for (size_t i = 0; i < messages; i++)
+            {
+                size_t const size = offsets[i + 1] - offsets[i];
+                ENetBuffer buffer;
+                buffer.data = &bytes[offsets[i]];
+                buffer.dataLength = size;
+
+                auto const start = std::chrono::steady_clock::now();
+                size_t const length = method.compressor->Compress(method.method, &buffer, 1, size, compressed.data(), size);
+                auto const encoded = std::chrono::steady_clock::now();
+                encodeNs += std::chrono::duration_cast<std::chrono::nanoseconds>(encoded - start).count();
+                if (length == 0 || length >= size)
+                {
+                    total += size;
+                    continue;
+                }
+                total += length;
+
+                size_t const restored = method.compressor->Decompress(compressed.data(), length, decompressed.data(), decompressed.size());
+                decodeNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - encoded).count();
+                if (restored != size || std::memcmp(decompressed.data(), buffer.data, size) != 0)
+                    mismatches++;
+            }
+            printf("%16s %12zu %12llu %8.3f %12.0f %12.0f\n", method.name, bytes.size(), (unsigned long long)total,
+                (double)total / bytes.size(), (double)encodeNs / messages, (double)decodeNs / messages);
+            if (mismatches > 0)
+                printf("%zu messages did not decompress to what was compressed.\n", mismatches);
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+        Writes prior as compressorprior.h.
+    */
+    bool BenchApp::WritePrior(const char* path, const Net::PacketCompressor::Model& prior, const char* session, size_t messages)
+    {
+        FILE* file = fopen(path, "w");
+        if (file == nullptr)
+            return false;
+
+        fprintf(file,
+            "#pragma once\n"
+            "//------------------------------------------------------------------------------\n"
+            "/**\n"
+            "    @file compressorprior.h\n"
+            "\n"
+            "    Byte frequencies of Net::PacketCompressor's model. Generated by the\n"
+            "    server_bench with -sv_bench_compression <capture>\n"
+            "    -sv_bench_compression_prior <file>, regenerate it when the protocol\n"
+            "    changes. Trained on %zu messages of\n"
+            "    %s.\n"
+            "\n"
+            "    @copyright\n"
+            "    (C) 2024 Individual contributors, see AUTHORS file\n"
+            "*/\n"
+            "//------------------------------------------------------------------------------\n"
+            "#include <stdint.h>\n"
+            "\n"
+            "namespace Net\n"
+            "{\n"
+            "\n"
+            "static const uint16_t CompressorPrior[%u][256] = {\n",
+            messages, session, Net::PacketCompressor::ContextCount);
+        for (uint32_t context = 0; context < Net::PacketCompressor::ContextCount; context++)
+        {
+            fprintf(file, "    {\n");
+            for (uint32_t byte = 0; byte < 256; byte++)
+                fprintf(file, "%s%u,%s", byte % 16 == 0 ? "        " : " ", prior.frequencies[context][byte], byte % 16 == 15 ? "\n" : "");
+            fprintf(file, "    },\n");
+        }
+        fprintf(file,
+            "};\n"
+            "\n"
+            "} // namespace Net\n");
+        return fclose(file) == 0;
+    }
+
+    //------------------------------------------------------------------------------
+
+    void BenchApp::Exit()
+    {
+        running = false;
+    }
+
+} // namespace Game
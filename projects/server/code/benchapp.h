@@ -0,0 +1,64 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+	Server benchmark and self-test application
+
+	Runs one benchmark or self-test of the headless server's code, selected by
+	an sv_bench_* or sv_test_* CVar, prints the result and exits.
+
+	(C) 2024 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include "core/app.h"
+#include "gameserver.h"
+#include "net/compressor.h"
+
+namespace Core
+{
+struct CVar;
+}
+
+namespace Game
+{
+class BenchApp : public Core::App
+{
+public:
+	/// constructor
+	BenchApp();
+	/// destructor
+	~BenchApp();
+
+	/// open app
+	bool Open();
+	/// run the selected benchmark or self-test, a long one stops early when the process is interrupted
+	void Run();
+	/// exit app
+	void Exit();
+	/// process exit code, non-zero if a self-test failed or nothing was selected
+	int ExitCode() const { return this->exitCode; }
+private:
+	/// time the collision step for growing ship counts, with and without broadphase
+	void RunCollisionBenchmark(int ticks);
+	/// time the server side of a tick's traffic to loopback clients, with and without socket batching
+	void RunSocketBenchmark(int ticks);
+	/// run the server and bots in this process over a Net::Loopback in lockstep and print the cost per tick
+	void RunLoopbackBenchmark(int clients, int ticks);
+	/// compress the messages of a captured session with every method and print ratio and speed
+	void RunCompressionBenchmark(const char* path);
+	/// round trip boundary and random values through the quantized formats, false if an error exceeds its bound
+	bool RunQuantizeTest(int samples);
+	/// write a trained prior as a header to replace compressorprior.h
+	bool WritePrior(const char* path, const Net::PacketCompressor::Model& prior, const char* session, size_t messages);
+
+	GameServer server;
+	Core::CVar* benchCollisions = nullptr;
+	Core::CVar* benchSockets = nullptr;
+	Core::CVar* maxPlayers = nullptr;
+	Core::CVar* benchCompression = nullptr;
+	Core::CVar* compressionPrior = nullptr;
+	Core::CVar* benchLoopback = nullptr;
+	Core::CVar* benchLoopbackTicks = nullptr;
+	Core::CVar* testQuantize = nullptr;
+	int exitCode = 0;
+};
+} // namespace Game
@@ -0,0 +1,1489 @@
+//------------------------------------------------------------------------------
+// gameserver.cc
+// (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "config.h"
+#include "gameserver.h"
+#include "core/random.h"
+#include "core/cvar.h"
+#include "render/physics.h"
+#include "allocstats.h"
+#include "net/packetpool.h"
+#include <chrono>
+#include <cstdio>
+#include <algorithm>
+#include <vector>
+#include "enet/enet.h"
+#include <proto.h>
+
+using namespace std;
+
+namespace Game
+{
+
+    //------------------------------------------------------------------------------
+
+    GameServer::GameServer()
+    {
+        this->tickRate = Core::CVarCreate(Core::CVar_Int, "sv_tickrate", "60", "Server simulation ticks per second");
+        this->deltaSnapshots = Core::CVarCreate(Core::CVar_Int, "sv_delta_snapshots", "1", "Delta encode snapshots against the last one acknowledged by the client");
+        this->quantize = Core::CVarCreate(Core::CVar_Int, "sv_quantize", "1", "Send snapshots and lasers in the compact quantized format");
+        this->interestRadius = Core::CVarCreate(Core::CVar_Float, "sv_interest_radius", "40", "Players and lasers within this distance of a peer's ship are sent every tick, 0 sends everything to everyone");
+        this->farInterval = Core::CVarCreate(Core::CVar_Int, "sv_interest_far_interval", "10", "Ticks between updates of players outside the interest radius");
+        this->peerBandwidth = Core::CVarCreate(Core::CVar_Int, "sv_peer_bandwidth", "32", "kB/s of player updates per peer, other players are sent by priority within it, 0 sends near players every tick and far ones every sv_interest_far_interval ticks. Needs sv_delta_snapshots");
+        this->reportAllocs = Core::CVarCreate(Core::CVar_Int, "sv_report_allocs", "0", "Print heap allocations per simulation tick once a second");
+        this->broadphase = Core::CVarCreate(Core::CVar_Int, "sv_broadphase", "1", "Find laser and ship collision candidates with a uniform grid, 0 tests every pair");
+        this->lagCompensation = Core::CVarCreate(Core::CVar_Int, "sv_lag_compensation", "250", "Longest time in ms that laser hits are rewound to the shooter's view, 0 disables lag compensation");
+        this->maxInterpolation = Core::CVarCreate(Core::CVar_Int, "sv_lag_compensation_interp", "100", "Largest client interpolation delay in ms that hits are rewound for, on top of half the round trip");
+        this->socketBatching = Core::CVarCreate(Core::CVar_Int, "sv_net_batch", "1", "Send the datagrams of a service together and receive them in batches, with one system call per batch where sendmmsg and recvmmsg exist");
+        this->eventBatching = Core::CVarCreate(Core::CVar_Int, "sv_event_batching", "1", "Send the spawns and despawns of a tick to each peer as one reliable message, 0 sends every event as its own reliable message");
+        this->compression = Core::CVarCreate(Core::CVar_Int, "sv_compress", "2", "Compress datagrams, 0 off, 1 ENet's range coder, 2 the model trained on game traffic. Whatever clients use is decompressed");
+        this->useNetThread = Core::CVarCreate(Core::CVar_Int, "sv_net_thread", "0", "Service ENet on its own thread, exchanging packets with the simulation through lock-free queues");
+        this->metricsInterval = Core::CVarCreate(Core::CVar_Float, "sv_metrics_interval", "0", "Seconds between lines of tick timings, peer and traffic statistics in JSON, 0 disables them");
+        this->metricsPath = Core::CVarCreate(Core::CVar_String, "sv_metrics_file", "", "File the metrics lines are appended to, empty writes them to stdout");
+        this->capturePath = Core::CVarCreate(Core::CVar_String, "sv_capture", "", "Record every connect, packet and disconnect the server handles to this file, for replay with sv_replay");
+        // Conditions what the server receives, the client to server direction
+        Net::CreateConditionerCVars("sv_netsim_");
+    }
+
+    //------------------------------------------------------------------------------
+
+    GameServer::~GameServer() { }
+
+    //------------------------------------------------------------------------------
+
+    bool GameServer::Open(uint16_t port, int playerLimit, Net::Loopback* loopback)
+    {
+        this->SetupAsteroids();
+
+        //ENet
+        if (!Net::InitializeENet()) {
+            fprintf(stderr, "An error Occured while initializing ENet!\n");
+            return false;
+        }
+
+        ENetAddress address;
+        address.host = ENET_HOST_ANY;
+        // On a loopback the socket is never used, any port will do
+        address.port = (loopback != nullptr) ? 0 : port;
+
+        this->host = enet_host_create(&address, playerLimit, Net::ChannelCount, 0, 0);
+
+        if (this->host == NULL) {
+            fprintf(stderr, "An error occurred while trying to create the server! \n");
+            return false;
+        }
+
+        if (loopback != nullptr && !loopback->Attach(this->host, port)) {
+            fprintf(stderr, "Could not attach the server to port %u of the loopback.\n", port);
+            enet_host_destroy(this->host);
+            this->host = nullptr;
+            return false;
+        }
+
+        if (Core::CVarReadInt(this->socketBatching) != 0 && enet_host_socket_batching(this->host, 1) != 0)
+            fprintf(stderr, "Could not allocate the socket batches, sending a datagram per call.\n");
+        if (!Net::PacketCompressor::Attach(this->host, Net::PacketCompressor::MethodFromInt(Core::CVarReadInt(this->compression))))
+            fprintf(stderr, "Could not create the packet compressor, sending datagrams uncompressed.\n");
+
+        // The loopback is serviced on this thread and the conditioner delivers through sockets
+        if (loopback == nullptr)
+        {
+            if (!this->conditioner.Attach(this->host, Net::ReadConditionerCVars("sv_netsim_")))
+                fprintf(stderr, "Could not start the network conditioner, running without.\n");
+
+            if (Core::CVarReadInt(this->useNetThread) != 0)
+                this->netThread.Start(this->host, &this->conditioner);
+        }
+
+        const char* const metricsPath = Core::CVarReadString(this->metricsPath);
+        this->metricsFile = stdout;
+        if (metricsPath[0] != '\0')
+        {
+            this->metricsFile = fopen(metricsPath, "a");
+            if (this->metricsFile == nullptr) {
+                fprintf(stderr, "Could not open %s, writing metrics to stdout.\n", metricsPath);
+                this->metricsFile = stdout;
+            }
+        }
+
+        int const rate = Core::CVarReadInt(this->tickRate);
+        if (rate > 0)
+            this->scheduler.SetTickRate(rate);
+        else
+            fprintf(stderr, "sv_tickrate must be positive, running at %d ticks per second.\n", this->scheduler.GetTickRate());
+        Core::CVarSetModified(this->tickRate, false);
+        const char* const capturePath = Core::CVarReadString(this->capturePath);
+        if (capturePath[0] != '\0' && !this->capture.Open(capturePath, (uint32_t)this->scheduler.GetTickRate()))
+            fprintf(stderr, "Could not create the capture file %s.\n", capturePath);
+
+        this->scheduler.Start();
+        this->nextMetricsTime = Net::LocalTime();
+        this->lockstep = loopback != nullptr;
+        this->lockstepStart = Net::LocalTime();
+        this->lockstepTime = this->lockstepStart;
+        this->lockstepENetStart = enet_time_get();
+        return true;
+    }
+
+    //------------------------------------------------------------------------------
+
+    void GameServer::Close()
+    {
+        // The host belongs to this thread again, received packets still queued are dropped
+        this->netThread.Stop();
+        Net::NetEvent event;
+        while (this->netThread.Poll(event))
+        {
+            if (event.packet != nullptr)
+                enet_packet_destroy(event.packet);
+        }
+
+        this->capture.Close();
+        if (this->metricsFile != nullptr)
+        {
+            if (Core::CVarReadFloat(this->metricsInterval) > 0.0f)
+                this->WriteMetrics(Net::LocalTime());
+            if (this->metricsFile != stdout)
+                fclose(this->metricsFile);
+            this->metricsFile = nullptr;
+        }
+
+        for (ENetPeer* peer : this->peers)
+            peer->data = nullptr;
+        this->peers.clear();
+        this->clients.Clear();
+
+        if (this->host != nullptr)
+        {
+            this->conditioner.Detach();
+            enet_host_destroy(this->host);
+            this->host = nullptr;
+        }
+        this->lockstep = false;
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+        Collider layout has to match the client, which draws its asteroids from the
+        same Core::FastRandom sequence.
+    */
+    void GameServer::SetupAsteroids()
+    {
+        Physics::ColliderMeshId colliderMeshes[6] = {
+            Physics::LoadColliderMesh("assets/space/Asteroid_1_physics.glb"),
+            Physics::LoadColliderMesh("assets/space/Asteroid_2_physics.glb"),
+            Physics::LoadColliderMesh("assets/space/Asteroid_3_physics.glb"),
+            Physics::LoadColliderMesh("assets/space/Asteroid_4_physics.glb"),
+            Physics::LoadColliderMesh("assets/space/Asteroid_5_physics.glb"),
+            Physics::LoadColliderMesh("assets/space/Asteroid_6_physics.glb")
+        };
+
+        // Setup asteroids near
+        for (int i = 0; i < 100; i++)
+        {
+            size_t resourceIndex = (size_t)(Core::FastRandom() % 6);
+            float span = 20.0f;
+            glm::vec3 translation = glm::vec3(
+                Core::RandomFloatNTP() * span,
+                Core::RandomFloatNTP() * span,
+                Core::RandomFloatNTP() * span
+            );
+            glm::vec3 rotationAxis = normalize(translation);
+            float rotation = translation.x;
+            glm::mat4 transform = glm::rotate(rotation, rotationAxis) * glm::translate(translation);
+            Physics::CreateCollider(colliderMeshes[resourceIndex], transform);
+            this->asteroids.push_back(transform);
+        }
+
+        // Setup asteroids far
+        for (int i = 0; i < 50; i++)
+        {
+            size_t resourceIndex = (size_t)(Core::FastRandom() % 6);
+            float span = 80.0f;
+            glm::vec3 translation = glm::vec3(
+                Core::RandomFloatNTP() * span,
+                Core::RandomFloatNTP() * span,
+                Core::RandomFloatNTP() * span
+            );
+            glm::vec3 rotationAxis = normalize(translation);
+            float rotation = translation.x;
+            glm::mat4 transform = glm::rotate(rotation, rotationAxis) * glm::translate(translation);
+            Physics::CreateCollider(colliderMeshes[resourceIndex], transform);
+            this->asteroids.push_back(transform);
+        }
+    }
+
+    //------------------------------------------------------------------------------
+
+    void GameServer::Service()
+    {
+        uint64_t const start = ServerMetrics::Now();
+        Net::NetEvent event;
+        if (this->netThread.Running())
+        {
+            while (this->netThread.Poll(event))
+                HandleEvent(event);
+        }
+        else
+        {
+            ENetEvent enetEvent;
+            while (this->conditioner.Service(this->host, &enetEvent, 0) > 0)
+                HandleEvent(Net::ToNetEvent(enetEvent));
+        }
+        this->metrics.Lap(TickPhase::Service, start);
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+        Events may come from the network thread, so the peer is only used as a
+        handle and its data is read from the event.
+    */
+    void GameServer::HandleEvent(const Net::NetEvent& event)
+    {
+        if (this->capture.IsOpen())
+            this->Capture(event);
+
+        switch (event.type)
+        {
+            case ENET_EVENT_TYPE_CONNECT:
+                printf("A new client connected from %x:%u.\n",
+                    event.address.host,
+                    event.address.port);
+                SendClientConnectS2C(uuid, event.peer);
+                SpawnSpaceShip(uuid, event.peer);
+                uuid++;
+                SendGameStateS2C(event.peer);
+                break;
+            case ENET_EVENT_TYPE_RECEIVE:
+            {
+                ClientState* client = GetClient(event.peer);
+                if (client != nullptr)
+                {
+                    client->roundTripTime = event.roundTripTime;
+                    client->packetLoss = event.packetLoss;
+                    client->packetThrottle = event.packetThrottle;
+                }
+                ProcessReceivedPacket(event.packet->data, event.packet->dataLength, event.peer);
+                enet_packet_destroy(event.packet);
+                break;
+            }
+            case ENET_EVENT_TYPE_DISCONNECT:
+                printf("%x:%u disconnected.\n",
+                    event.address.host,
+                    event.address.port);
+
+                RemoveClient(event.peer);
+                break;
+            default:
+                break;
+        }
+    }
+
+    //------------------------------------------------------------------------------
+
+    int GameServer::Tick()
+    {
+        if (Core::CVarModified(this->tickRate))
+        {
+            int rate = Core::CVarReadInt(this->tickRate);
+            if (rate > 0)
+                this->scheduler.SetTickRate(rate);
+            Core::CVarSetModified(this->tickRate, false);
+        }
+
+        uint64_t const dropped = this->scheduler.droppedTicks;
+        int const ticks = this->scheduler.Advance();
+        if (this->scheduler.droppedTicks != dropped)
+            printf("Server can't keep up, skipped %llu ticks.\n", (unsigned long long)(this->scheduler.droppedTicks - dropped));
+
+        AllocStats const allocsBefore = GetAllocStats();
+        float const dt = (float)this->scheduler.GetTickDelta();
+        for (int i = 0; i < ticks; i++)
+            this->Update(dt);
+
+        if (ticks > 0)
+        {
+            AllocStats const allocs = GetAllocStats() - allocsBefore;
+            this->tickAllocs.allocations += allocs.allocations;
+            this->tickAllocs.bytes += allocs.bytes;
+            this->tickAllocs.enetAllocations += allocs.enetAllocations;
+            this->tickAllocs.enetBytes += allocs.enetBytes;
+
+            if (Core::CVarReadInt(this->reportAllocs) != 0 && this->currentTick / this->scheduler.GetTickRate() != (this->currentTick - ticks) / this->scheduler.GetTickRate())
+            {
+                AllocStats const second = this->tickAllocs - this->reportedAllocs;
+                uint64_t const ticksRun = this->currentTick - this->reportedTick;
+                printf("Allocations per tick: %.1f (%.0f bytes), ENet %.1f (%.0f bytes)\n",
+                    (double)second.allocations / ticksRun, (double)second.bytes / ticksRun,
+                    (double)second.enetAllocations / ticksRun, (double)second.enetBytes / ticksRun);
+                this->reportedAllocs = this->tickAllocs;
+                this->reportedTick = this->currentTick;
+            }
+        }
+
+        float const metricsInterval = Core::CVarReadFloat(this->metricsInterval);
+        if (metricsInterval > 0.0f)
+        {
+            uint64_t const now = Net::LocalTime();
+            if (now >= this->nextMetricsTime)
+            {
+                this->WriteMetrics(now);
+                this->nextMetricsTime = now + (uint64_t)(metricsInterval * 1000.0f);
+            }
+        }
+
+        return ticks;
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+        Peers are sampled once per line rather than per event, so every peer
+        counts the same however much it sends.
+    */
+    void GameServer::WriteMetrics(uint64_t time)
+    {
+        for (const ClientState& client : clients)
+            this->metrics.RecordPeer(client.roundTripTime, client.packetLoss);
+
+        ServerMetrics::Counts counts;
+        counts.tick = this->currentTick;
+        counts.droppedTicks = this->scheduler.droppedTicks - this->metricsDroppedTicks;
+        counts.peers = this->peers.size();
+        counts.ships = this->spaceShips.Size();
+        counts.lasers = this->lasers.Size();
+        counts.pool = Net::GetPoolStats();
+        this->metrics.Write(this->metricsFile, time, counts);
+        this->metricsDroppedTicks = this->scheduler.droppedTicks;
+    }
+
+    //------------------------------------------------------------------------------
+
+    void GameServer::WaitForNextTick()
+    {
+        this->scheduler.WaitForNextTick();
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+        Tick times are computed from the tick count, so they do not drift
+        however long a step takes. ENet's clock is held at them too, so its
+        round trips, throttle and timeouts see one tick per step however fast
+        the machine is. The messages are flushed at the end, the clients
+        receive them when they are serviced next.
+    */
+    void GameServer::Step()
+    {
+        this->lockstepTime = this->lockstepStart + (this->currentTick + 1) * 1000 / (uint64_t)this->scheduler.GetTickRate();
+        this->HoldENetTime();
+        this->Service();
+        this->Update((float)this->scheduler.GetTickDelta());
+        this->HoldENetTime();
+        enet_host_flush(this->host);
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+        ENet's clock is global and keeps running, so this is needed before
+        every host is serviced, not once per step.
+    */
+    void GameServer::HoldENetTime() const
+    {
+        if (this->lockstep)
+            enet_time_set(this->lockstepENetStart + (uint32_t)(this->lockstepTime - this->lockstepStart));
+    }
+
+    //------------------------------------------------------------------------------
+
+    uint64_t GameServer::ServerTime() const
+    {
+        if (this->replaying)
+            return this->replayTime;
+        return this->lockstep ? this->lockstepTime : Net::LocalTime();
+    }
+
+    //------------------------------------------------------------------------------
+
+    void GameServer::Capture(const Net::NetEvent& event)
+    {
+        Net::CaptureRecord record = {};
+        record.tick = this->currentTick;
+        record.time = this->ServerTime();
+        record.peer = event.peer->incomingPeerID;
+        record.roundTripTime = event.roundTripTime;
+        record.packetLoss = event.packetLoss;
+        record.channel = event.channel;
+        switch (event.type)
+        {
+            case ENET_EVENT_TYPE_CONNECT:
+                record.kind = Net::CaptureRecord::Connect;
+                this->capture.Write(record, nullptr, 0);
+                break;
+            case ENET_EVENT_TYPE_RECEIVE:
+                record.kind = Net::CaptureRecord::Receive;
+                this->capture.Write(record, event.packet->data, event.packet->dataLength);
+                break;
+            case ENET_EVENT_TYPE_DISCONNECT:
+                record.kind = Net::CaptureRecord::Disconnect;
+                this->capture.Write(record, nullptr, 0);
+                break;
+            default:
+                break;
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+        FNV-1a, continuing from digest.
+    */
+    uint64_t GameServer::Digest(uint64_t digest, const void* data, size_t size)
+    {
+        const uint8_t* bytes = (const uint8_t*)data;
+        for (size_t i = 0; i < size; i++)
+            digest = (digest ^ bytes[i]) * 1099511628211ull;
+        return digest;
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+        Records are handled in the order they were written, events through
+        HandleEvent and ticks through Update, with the server clock set to the
+        recorded time. Asteroids and everything else drawn from
+        Core::FastRandom come out the same as in the recorded session as long
+        as this runs in a fresh process.
+
+        Peers are stand-ins that ENet sees as disconnected, sends to them fail
+        and free the packet right away, so the send path is measured up to
+        enet_peer_send.
+    */
+    bool GameServer::Replay(const char* path, uint32_t digestInterval, ReplayResult& result, const std::function<void(const uint8_t* data, size_t size)>& sent)
+    {
+        Net::CaptureReader reader;
+        if (!reader.Open(path)) {
+            fprintf(stderr, "Could not read the capture file %s, it is missing, not a capture of this version or its header is corrupt.\n", path);
+            return false;
+        }
+
+        this->SetupAsteroids();
+        if (!Net::InitializeENet()) {
+            fprintf(stderr, "An error Occured while initializing ENet!\n");
+            return false;
+        }
+        this->scheduler.SetTickRate((int)reader.Header().tickRate);
+        float const dt = (float)this->scheduler.GetTickDelta();
+
+        std::vector<ENetPeer> replayPeers(ENET_PROTOCOL_MAXIMUM_PEER_ID);
+        for (size_t i = 0; i < replayPeers.size(); i++)
+            replayPeers[i].incomingPeerID = (enet_uint16)i;
+
+        this->replaying = true;
+        this->replayResult = {};
+        this->replaySent = sent;
+        auto const start = std::chrono::steady_clock::now();
+
+        Net::CaptureRecord record;
+        const uint8_t* data = nullptr;
+        while (reader.Next(record, data))
+        {
+            this->replayTime = record.time;
+            if (record.kind == Net::CaptureRecord::Tick)
+            {
+                this->Update(dt);
+                this->replayResult.ticks++;
+                if (this->currentTick != record.tick)
+                    this->replayResult.mismatchedTicks++;
+                if (digestInterval > 0 && this->currentTick % digestInterval == 0)
+                    printf("Tick %llu digest %016llx\n", (unsigned long long)this->currentTick, (unsigned long long)this->replayResult.digest);
+                continue;
+            }
+
+            if (record.peer >= replayPeers.size())
+                continue;
+            Net::NetEvent event;
+            event.peer = &replayPeers[record.peer];
+            event.channel = record.channel;
+            event.roundTripTime = record.roundTripTime;
+            event.packetLoss = record.packetLoss;
+            if (record.kind == Net::CaptureRecord::Connect)
+                event.type = ENET_EVENT_TYPE_CONNECT;
+            else if (record.kind == Net::CaptureRecord::Disconnect)
+                event.type = ENET_EVENT_TYPE_DISCONNECT;
+            else
+            {
+                event.type = ENET_EVENT_TYPE_RECEIVE;
+                event.packet = enet_packet_create(data, record.length, 0);
+            }
+            this->HandleEvent(event);
+            this->replayResult.events++;
+        }
+
+        // Events of the disconnects after the last tick
+        this->events.Clear();
+        this->replayResult.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        result = this->replayResult;
+        this->replaying = false;
+        this->replaySent = nullptr;
+
+        for (ENetPeer* peer : this->peers)
+            peer->data = nullptr;
+        this->peers.clear();
+        this->clients.Clear();
+        return true;
+    }
+
+    //------------------------------------------------------------------------------
+
+    void GameServer::Update(float dt)
+    {
+        this->currentTick++;
+        uint64_t const tickTime = this->ServerTime();
+        if (this->capture.IsOpen())
+        {
+            Net::CaptureRecord record = {};
+            record.kind = Net::CaptureRecord::Tick;
+            record.tick = this->currentTick;
+            record.time = tickTime;
+            this->capture.Write(record, nullptr, 0);
+        }
+        uint64_t const tickStart = ServerMetrics::Now();
+
+        ApplyInputs();
+        uint64_t phaseStart = this->metrics.Lap(TickPhase::Inputs, tickStart);
+
+        for (SpaceShip& ship : spaceShips) {
+            // Lasers are stamped with the server time of the tick
+            uint64_t const currentTime = tickTime;
+
+            // Check if the ship is attempting to fire and enough time has passed since the last shot
+            if ((ship.bitmap & (1 << 7)) && (currentTime - ship.lastFireTime >= ship.fireRate))
+            {
+                // Define the wing positions (right and left) using the ship's collider end points
+                glm::vec3 wingPositions[2] = {
+                    ship.position + (ship.orientation * (ship.colliderEndPoints[5] + glm::vec3(0,0,1))), // Right wing
+                    ship.position + (ship.orientation * (ship.colliderEndPoints[4] + glm::vec3(0,0,1)))  // Left wing
+                };
+
+                // Lasers are judged against the world the shooter saw when firing
+                ClientState const* shooter = GetClient(ship.peer);
+
+                // Iterate through both wing positions (right and left)
+                for (int i = 0; i < 2; ++i) {
+                    glm::vec3 wingPos = wingPositions[i];
+                    Laser laser = Laser(
+                        uuid,
+                        currentTime,
+                        1000 * 10,  // 10s duration
+                        wingPos,
+                        ship.orientation
+                    );
+                    laser.viewDelay = (shooter != nullptr) ? shooter->viewDelay : 0;
+                    // Spawns are sent by UpdateInterest to the peers that can see it
+                    GameServer::lasers.Insert(laser.uuid, laser);
+                    uuid++;
+                }
+
+                // Update the last fire time
+                ship.lastFireTime = currentTime;
+            }
+
+            ship.Update(dt);
+        }
+        phaseStart = this->metrics.Lap(TickPhase::Ships, phaseStart);
+
+        CheckCollisions(tickTime);
+
+        this->rewindHistory.Begin(this->currentTick, tickTime);
+        for (const SpaceShip& ship : spaceShips)
+            this->rewindHistory.Add(ship.uuid, ship.position);
+        this->rewindHistory.End();
+        phaseStart = this->metrics.Lap(TickPhase::Collisions, phaseStart);
+
+        // Lasers
+        for (size_t i = lasers.Size(); i-- > 0;) {
+            lasers[i].Update(dt, tickTime);
+            lasers[i].CheckCollisions();
+            if (lasers[i].marked_for_deletion) {
+                DespawnLaser(lasers[i].uuid);
+                /*printf("Server Laser marked for deletion: UUID: %u Position: (%f, %f, %f)\n",
+                    lasers[i].uuid,
+                    lasers[i].position.x,
+                    lasers[i].position.y,
+                    lasers[i].position.z);*/
+                lasers.RemoveAt(i);
+            }
+        }
+        phaseStart = this->metrics.Lap(TickPhase::Lasers, phaseStart);
+
+        UpdateInterest(tickTime);
+        FlushEvents();
+        phaseStart = this->metrics.Lap(TickPhase::Interest, phaseStart);
+
+        // All ship states of this tick go out in one packet per peer
+        SendSnapshotS2C(tickTime, peers);
+        this->metrics.RecordTick(this->metrics.Lap(TickPhase::Snapshots, phaseStart) - tickStart);
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+        Clients step their own ship ahead with one input per tick and replay the
+        inputs after input_ack when a snapshot arrives, so the server has to
+        apply them the same way: one per tick, in order.
+    */
+    void GameServer::ApplyInputs()
+    {
+        for (ClientState& client : clients)
+        {
+            // Clients sending sequence 0 set the bitmap when it arrives
+            if (!client.input.Started())
+                continue;
+            uint16_t const bitmap = client.input.Next();
+            SpaceShip* ship = spaceShips.Get(client.ship);
+            if (ship != nullptr)
+                ship->bitmap = bitmap;
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+        Test against the ship's position in past, ships that were not recorded
+        there yet are tested where they are now.
+    */
+    static bool HitsShip(const Laser& laser, const SpaceShip& ship, const Net::RewindHistory::Frame* past)
+    {
+        const glm::vec3* position = (past != nullptr) ? past->Find(ship.uuid) : nullptr;
+        return ship.Intersects(laser, (position != nullptr) ? *position : ship.position);
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+        Ships go into a uniform grid after they moved, each laser and ship then
+        queries the cells around it so only nearby pairs reach the narrowphase.
+        The grid is not updated on teleports, candidates are tested at their
+        current position so a stale entry only costs a failed test.
+
+        Lasers are tested against ships where they were when the shooter saw
+        them, looked up in rewindHistory. The grid holds current positions, so
+        those queries are widened by how far a ship can move in the meantime.
+    */
+    void GameServer::CheckCollisions(uint64_t time)
+    {
+        bool const broadphase = Core::CVarReadInt(this->broadphase) != 0;
+        uint32_t const maxViewDelay = (uint32_t)std::max(0, Core::CVarReadInt(this->lagCompensation));
+        uint32_t const tickMs = 1000 / std::max(1, this->scheduler.GetTickRate());
+
+        float maxRadius = 0.0f;
+        for (const SpaceShip& ship : spaceShips)
+            maxRadius = std::max(maxRadius, ship.radius);
+        // Farthest a ship's center can be from the center of a laser that touches it
+        float const laserReach = maxRadius + Laser::halfLength;
+
+        if (broadphase)
+        {
+            this->collisionGrid.Clear(std::max(2.0f * laserReach, 1.0f));
+            for (size_t i = 0; i < spaceShips.Size(); i++)
+                this->collisionGrid.Insert((uint32_t)i, spaceShips[i].position);
+            this->collisionGrid.Build();
+        }
+
+        // Ships hit by a laser, as indices into spaceShips
+        this->laserHits.clear();
+        for (const Laser& laser : lasers)
+        {
+            // Rewinding less than half a tick is closer to now than to any recorded frame
+            uint32_t const viewDelay = std::min(laser.viewDelay, maxViewDelay);
+            const Net::RewindHistory::Frame* past = nullptr;
+            if (viewDelay * 2 >= tickMs && time > viewDelay)
+                past = this->rewindHistory.Find(time - viewDelay);
+
+            if (broadphase)
+            {
+                float const reach = laserReach + ((past != nullptr) ? SpaceShip::maxSpeed * (time - past->time) / 1000.0f : 0.0f);
+                this->collisionCandidates.clear();
+                this->collisionGrid.Query(laser.position, reach, this->collisionCandidates);
+                for (const Net::InterestGrid::Entry& candidate : this->collisionCandidates)
+                {
+                    if (HitsShip(laser, spaceShips[candidate.id], past))
+                        this->laserHits.push_back(candidate.id);
+                }
+            }
+            else
+            {
+                for (size_t i = 0; i < spaceShips.Size(); i++)
+                {
+                    if (HitsShip(laser, spaceShips[i], past))
+                        this->laserHits.push_back((uint32_t)i);
+                }
+            }
+        }
+        std::sort(this->laserHits.begin(), this->laserHits.end());
+
+        for (size_t i = 0; i < spaceShips.Size(); i++)
+        {
+            SpaceShip& ship = spaceShips[i];
+            SpaceShip* other = nullptr;
+            bool hit = ship.CheckRockCollisions() || std::binary_search(this->laserHits.begin(), this->laserHits.end(), (uint32_t)i);
+
+            if (!hit && broadphase)
+            {
+                this->collisionCandidates.clear();
+                this->collisionGrid.Query(ship.position, ship.radius + maxRadius, this->collisionCandidates);
+                for (const Net::InterestGrid::Entry& candidate : this->collisionCandidates)
+                {
+                    if (candidate.id != i && ship.Intersects(spaceShips[candidate.id]))
+                    {
+                        other = &spaceShips[candidate.id];
+                        break;
+                    }
+                }
+            }
+            else if (!hit)
+            {
+                for (size_t j = 0; j < spaceShips.Size() && other == nullptr; j++)
+                {
+                    if (j != i && ship.Intersects(spaceShips[j]))
+                        other = &spaceShips[j];
+                }
+            }
+
+            if (other != nullptr)
+            {
+                other->Teleport();
+                CollectInterestedPeers(other->uuid, this->interestedPeers);
+                SendTeleportPlayerS2C(&other->player, time, this->interestedPeers);
+                hit = true;
+            }
+
+            if (hit)
+            {
+                ship.Teleport();
+                CollectInterestedPeers(ship.uuid, this->interestedPeers);
+                SendTeleportPlayerS2C(&ship.player, time, this->interestedPeers);
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+        ENetPeer::data holds the handle of the peer's slot in clients, offset by
+        one so a peer without a slot has null data.
+    */
+    static void SetPeerClient(ENetPeer* peer, Util::SlotId id)
+    {
+        peer->data = (void*)((uintptr_t)uint32_t(id) + 1);
+    }
+
+    static Util::SlotId GetPeerClient(const ENetPeer* peer)
+    {
+        if (peer->data == nullptr)
+            return Util::SlotId::Invalid();
+        return Util::SlotId::Create((uint32_t)((uintptr_t)peer->data - 1));
+    }
+
+    //------------------------------------------------------------------------------
+
+    ClientState* GameServer::GetClient(const ENetPeer* peer)
+    {
+        return this->clients.Get(GetPeerClient(peer));
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+        peers and clients are kept in the same order, both remove by moving their
+        last element into the hole.
+    */
+    void GameServer::RemoveClient(ENetPeer* peer)
+    {
+        Util::SlotId const id = GetPeerClient(peer);
+        peer->data = nullptr;
+        ClientState* client = this->clients.Get(id);
+        if (client == nullptr)
+            return;
+
+        uint32_t const shipUuid = client->shipUuid;
+        this->spaceShips.Remove(client->ship);
+
+        size_t const index = client - &this->clients[0];
+        this->clients.RemoveAt(index);
+        this->peers[index] = this->peers.back();
+        this->peers.pop_back();
+
+        SendDespawnPlayerS2C(shipUuid, this->peers);
+    }
+
+    //------------------------------------------------------------------------------
+
+    static Protocol::Laser ToProtocolLaser(const Laser& laser)
+    {
+        return Protocol::Laser(
+            laser.uuid,
+            laser.start_time,
+            laser.end_time,
+            Protocol::Vec3(laser.position.x, laser.position.y, laser.position.z),
+            Protocol::Vec4(laser.direction.x, laser.direction.y, laser.direction.z, laser.direction.w)
+        );
+    }
+
+    /// factor on sv_interest_radius at which entities leave the interest set again
+    static const float InterestHysteresis = 1.25f;
+
+    //------------------------------------------------------------------------------
+    /**
+        Entities enter a peer's interest set within sv_interest_radius of its ship
+        and leave it beyond InterestHysteresis times that, so entities moving along
+        the border do not flicker in and out.
+
+        Players outside the set stay spawned on the peer and get a low rate update
+        with the snapshot. Lasers are spawned on a peer when they enter its set,
+        with their current position, and despawned when they leave it.
+    */
+    void GameServer::UpdateInterest(uint64_t time)
+    {
+        float const enterRadius = Core::CVarReadFloat(this->interestRadius);
+        float const leaveRadius = enterRadius * InterestHysteresis;
+        float const enterRadiusSq = enterRadius * enterRadius;
+        bool const everything = enterRadius <= 0.0f;
+
+        if (!everything)
+        {
+            this->interestGrid.Clear(leaveRadius);
+            for (const SpaceShip& ship : spaceShips)
+                this->interestGrid.Insert(ship.uuid, ship.position);
+            this->interestGrid.Build();
+        }
+
+        // Players near each peer's ship
+        for (ClientState& client : clients)
+        {
+            const SpaceShip* own = spaceShips.Get(client.ship);
+            std::vector<uint32_t>& next = this->nextNearPlayers;
+            next.clear();
+
+            if (everything || own == nullptr)
+            {
+                for (const SpaceShip& ship : spaceShips)
+                    next.push_back(ship.uuid);
+            }
+            else
+            {
+                this->interestQuery.clear();
+                this->interestGrid.Query(own->position, leaveRadius, this->interestQuery);
+                for (const Net::InterestGrid::Entry& entry : this->interestQuery)
+                {
+                    glm::vec3 const d = entry.position - own->position;
+                    if (glm::dot(d, d) <= enterRadiusSq || std::binary_search(client.nearPlayers.begin(), client.nearPlayers.end(), entry.id))
+                        next.push_back(entry.id);
+                }
+            }
+            std::sort(next.begin(), next.end());
+            std::swap(client.nearPlayers, next);
+        }
+
+        // Lasers near each peer's ship
+        for (const Laser& laser : lasers)
+        {
+            this->interestedPeers.clear();
+            if (everything)
+            {
+                for (ClientState& client : clients)
+                {
+                    if (!std::binary_search(client.visibleLasers.begin(), client.visibleLasers.end(), laser.uuid))
+                        this->interestedPeers.push_back(client.peer);
+                    client.nextVisibleLasers.push_back(laser.uuid);
+                }
+            }
+            else
+            {
+                this->interestQuery.clear();
+                this->interestGrid.Query(laser.position, leaveRadius, this->interestQuery);
+                for (const Net::InterestGrid::Entry& entry : this->interestQuery)
+                {
+                    const SpaceShip* ship = spaceShips.Find(entry.id);
+                    ClientState* client = (ship != nullptr) ? GetClient(ship->peer) : nullptr;
+                    if (client == nullptr)
+                        continue;
+
+                    bool const wasVisible = std::binary_search(client->visibleLasers.begin(), client->visibleLasers.end(), laser.uuid);
+                    glm::vec3 const d = entry.position - laser.position;
+                    if (glm::dot(d, d) <= enterRadiusSq || wasVisible)
+                    {
+                        client->nextVisibleLasers.push_back(laser.uuid);
+                        if (!wasVisible)
+                            this->interestedPeers.push_back(ship->peer);
+                    }
+                }
+            }
+
+            if (!this->interestedPeers.empty())
+            {
+                Protocol::Laser l = ToProtocolLaser(laser);
+                SendSpawnLaserS2C(&l, time, this->interestedPeers);
+            }
+        }
+
+        // Lasers that left the set, dead ones were already removed by DespawnLaser
+        for (ClientState& client : clients)
+        {
+            std::sort(client.nextVisibleLasers.begin(), client.nextVisibleLasers.end());
+            for (uint32_t laser : client.visibleLasers)
+            {
+                if (!std::binary_search(client.nextVisibleLasers.begin(), client.nextVisibleLasers.end(), laser))
+                    SendDespawnLaserS2C(laser, { &client.peer, 1 });
+            }
+            std::swap(client.visibleLasers, client.nextVisibleLasers);
+            client.nextVisibleLasers.clear();
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+        Peers that have the ship in their interest set.
+    */
+    void GameServer::CollectInterestedPeers(uint32_t shipUuid, std::vector<ENetPeer*>& out)
+    {
+        out.clear();
+        for (const ClientState& client : clients)
+        {
+            if (std::binary_search(client.nearPlayers.begin(), client.nearPlayers.end(), shipUuid))
+                out.push_back(client.peer);
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+        Despawn a dead laser on the peers that were sent its spawn.
+    */
+    void GameServer::DespawnLaser(uint32_t uuid)
+    {
+        this->interestedPeers.clear();
+        for (ClientState& client : clients)
+        {
+            auto it = std::lower_bound(client.visibleLasers.begin(), client.visibleLasers.end(), uuid);
+            if (it != client.visibleLasers.end() && *it == uuid)
+            {
+                client.visibleLasers.erase(it);
+                this->interestedPeers.push_back(client.peer);
+            }
+        }
+        if (!this->interestedPeers.empty())
+            SendDespawnLaserS2C(uuid, this->interestedPeers);
+    }
+
+    //------------------------------------------------------------------------------
+
+    void GameServer::SpawnSpaceShip(uint32_t uuid, ENetPeer* peer) {
+        //Create a new SpaceShip instance
+        SpaceShip ship;
+        ship.uuid = uuid;
+        ship.peer = peer;
+        ship.Teleport();
+        // Create a new player object for network synchronization
+        ship.player = Protocol::Player(
+            uuid,                                                                                           // Unique player ID
+            Protocol::Vec3(ship.position[0], ship.position[1], ship.position[2]),                           // Initial position (x, y, z)
+            Protocol::Vec3(0, 0, 0),                                                                        // Initial velocity (x, y, z)
+            Protocol::Vec3(0, 0, 0),                                                                        // Initial acceleration (x, y, z)
+            Protocol::Vec4(ship.orientation.x, ship.orientation.y, ship.orientation.z, ship.orientation.w)  // Initial rotation (quaternion x, y, z, w)
+        );
+        Util::SlotId const shipId = GameServer::spaceShips.Insert(uuid, ship);
+        // Send a message to all connected peers, informing them of the new player's spawn+
+        SendSpawnPlayerS2C(&ship.player, GameServer::peers);
+        // Add the peer to the list of connected peers in the game, in the same order as its client slot
+        ClientState client;
+        client.peer = peer;
+        client.ship = shipId;
+        client.shipUuid = uuid;
+        SetPeerClient(peer, GameServer::clients.Insert(uuid, std::move(client)));
+        GameServer::peers.push_back(peer);
+    }
+
+    //<ENet functions>
+    void GameServer::ProcessReceivedPacket(const void* data, size_t dataLength, ENetPeer* sender)
+    {
+        // Ensure the data length is valid
+        if (dataLength < sizeof(uint16_t)) {
+            printf("Received packet is too short.\n");
+            return;
+        }
+
+        // Create a FlatBuffers buffer from the received data
+        auto packetWrapper = Protocol::GetPacketWrapper(data);
+        this->metrics.RecordReceived(packetWrapper->packet_type(), dataLength);
+
+        // Check the type of packet received
+        switch (packetWrapper->packet_type())
+        {
+            case Protocol::PacketType_InputC2S:
+            {
+                // Deserialize InputC2S packet
+                const auto inputPacket = packetWrapper->packet_as_InputC2S();
+                if (inputPacket)
+                {
+                    ClientState* client = GetClient(sender);
+                    if (client == nullptr)
+                        break;
+
+                    if (inputPacket->sequence() == 0)
+                    {
+                        SpaceShip* ship = spaceShips.Get(client->ship);
+                        if (ship != nullptr)
+                            ship->bitmap = inputPacket->bitmap();
+                    }
+                    else
+                    {
+                        const auto previous = inputPacket->previous();
+                        client->input.Receive(inputPacket->sequence(), inputPacket->bitmap(), previous ? previous->data() : nullptr, previous ? previous->size() : 0);
+                    }
+
+                    // Inputs are unreliable, an older ack can arrive after a newer one
+                    if (inputPacket->snapshot_ack() <= this->currentTick)
+                        client->ackedTick = std::max(client->ackedTick, inputPacket->snapshot_ack());
+
+                    // The client says which world it showed, interpolation delay included, and hits are rewound to it.
+                    // It can not have shown a world older than half a round trip, the largest interpolation delay
+                    // credited and a tick of sampling, so a client with a low ping can not claim the full rewind.
+                    // Without a render time the input is as old as its timestamp says and showed a world half a
+                    // round trip older, the timestamp is only trusted within one round trip.
+                    int64_t const now = (int64_t)this->ServerTime();
+                    if (inputPacket->render_time() != 0)
+                    {
+                        int64_t const tickMs = 1000 / std::max(1, this->scheduler.GetTickRate());
+                        int64_t const plausible = client->roundTripTime / 2 + std::max(0, Core::CVarReadInt(this->maxInterpolation)) + tickMs;
+                        int64_t const maxViewDelay = std::min<int64_t>(plausible, std::max(0, Core::CVarReadInt(this->lagCompensation)));
+                        int64_t const shown = std::clamp<int64_t>((int64_t)inputPacket->render_time(), now - maxViewDelay, now);
+                        client->viewDelay = (uint32_t)(now - shown);
+                    }
+                    else
+                    {
+                        int64_t const rtt = client->roundTripTime;
+                        int64_t const sent = std::clamp<int64_t>((int64_t)inputPacket->time(), now - rtt, now);
+                        client->viewDelay = (uint32_t)(now - sent + rtt / 2);
+                    }
+                }
+                break;
+            }
+            case Protocol::PacketType_ClockSyncC2S:
+            {
+                const auto syncPacket = packetWrapper->packet_as_ClockSyncC2S();
+                if (syncPacket)
+                    SendClockSyncS2C(syncPacket->client_time(), sender);
+                break;
+            }
+            default:
+                printf("Received unknown packet type.\n");
+                break;
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+        Sends the finished contents of builder as one packet, ENet reference counts
+        it across peers and frees it after the last one has sent it. With the
+        network thread running the sends are queued to it.
+    */
+    void GameServer::Broadcast(enet_uint32 flags, Net::Channel channel, std::span<ENetPeer* const> peers) {
+        if (peers.empty())
+            return;
+
+        this->metrics.RecordSent(Protocol::GetPacketWrapper(builder.GetBufferPointer())->packet_type(), builder.GetSize(), peers.size());
+        if (this->replaying)
+        {
+            for (const ENetPeer* peer : peers)
+                this->replayResult.digest = Digest(this->replayResult.digest, &peer->incomingPeerID, sizeof(peer->incomingPeerID));
+            this->replayResult.digest = Digest(this->replayResult.digest, builder.GetBufferPointer(), builder.GetSize());
+            this->replayResult.packetsSent += peers.size();
+            this->replayResult.bytesSent += builder.GetSize() * peers.size();
+            if (this->replaySent)
+                this->replaySent(builder.GetBufferPointer(), builder.GetSize());
+        }
+        ENetPacket* packet = enet_packet_create(builder.GetBufferPointer(), builder.GetSize(), flags);
+        this->netThread.Broadcast(peers, (uint8_t)channel, packet);
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+        Copies the finished contents of builder once and remembers it for every
+        peer, FlushEvents sends them. With sv_event_batching 0 it is sent right
+        away instead, still reliable and in order.
+    */
+    void GameServer::QueueEvent(std::span<ENetPeer* const> peers) {
+        if (peers.empty())
+            return;
+
+        if (Core::CVarReadInt(this->eventBatching) == 0)
+        {
+            Broadcast(ENET_PACKET_FLAG_RELIABLE, Net::Channel::Events, peers);
+            return;
+        }
+
+        uint32_t const event = this->events.Add(builder.GetBufferPointer(), builder.GetSize());
+        for (ENetPeer* peer : peers)
+        {
+            ClientState* client = GetClient(peer);
+            if (client != nullptr)
+                client->pendingEvents.push_back(event);
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+        Every peer with pending events gets them in one EventsS2C. The batch is
+        aligned like the events in it, so the client reads them in place.
+    */
+    void GameServer::FlushEvents() {
+        for (ClientState& client : clients)
+        {
+            if (client.pendingEvents.empty())
+                continue;
+
+            this->eventFrames.clear();
+            for (uint32_t event : client.pendingEvents)
+                this->events.Append(event, this->eventFrames);
+
+            builder.Clear();
+            builder.ForceVectorAlignment(this->eventFrames.size(), sizeof(uint8_t), Net::EventBatch::FrameAlignment);
+            auto eventsVec = builder.CreateVector(this->eventFrames);
+            auto eventsPacket = Protocol::CreateEventsS2C(builder, this->currentTick, eventsVec);
+            auto packetWrapper = Protocol::CreatePacketWrapper(builder, Protocol::PacketType_EventsS2C, eventsPacket.Union());
+
+            builder.Finish(packetWrapper);
+            Broadcast(ENET_PACKET_FLAG_RELIABLE, Net::Channel::Events, { &client.peer, 1 });
+            client.pendingEvents.clear();
+        }
+        this->events.Clear();
+    }
+
+    void GameServer::SendClientConnectS2C(uint16_t uuid, ENetPeer* peer) {
+        builder.Clear();
+        auto idPacket = Protocol::CreateClientConnectS2C(builder, uuid, this->ServerTime(), this->scheduler.GetTickRate());
+        auto packetWrapper = Protocol::CreatePacketWrapper(builder, Protocol::PacketType_ClientConnectS2C, idPacket.Union());
+
+        builder.Finish(packetWrapper);
+        Broadcast(ENET_PACKET_FLAG_RELIABLE, Net::Channel::Bulk, { &peer, 1 });
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+        The reply is flushed right away, a reply waiting for the next service
+        would make the return leg look longer and skew the client's estimate.
+    */
+    void GameServer::SendClockSyncS2C(uint64_t clientTime, ENetPeer* peer) {
+        builder.Clear();
+        auto syncPacket = Protocol::CreateClockSyncS2C(builder, clientTime, this->ServerTime());
+        auto packetWrapper = Protocol::CreatePacketWrapper(builder, Protocol::PacketType_ClockSyncS2C, syncPacket.Union());
+
+        builder.Finish(packetWrapper);
+        Broadcast(0, Net::Channel::State, { &peer, 1 });
+        if (this->netThread.Running())
+            this->netThread.Flush();
+        else if (this->host != nullptr)
+            enet_host_flush(this->host);
+    }
+
+    void GameServer::SendGameStateS2C(ENetPeer* peer) {
+        builder.Clear();
+
+        this->snapshotPlayers.clear();
+        for (const SpaceShip& spaceShip : spaceShips)
+            this->snapshotPlayers.push_back(spaceShip.player);
+
+        // lasers are spawned on the peer by UpdateInterest
+        auto playersVec = builder.CreateVectorOfStructs(this->snapshotPlayers.data(), this->snapshotPlayers.size());
+        auto lasersVec = builder.CreateVectorOfStructs<Protocol::Laser>(nullptr, 0);
+
+        auto gameState = Protocol::CreateGameStateS2C(builder, playersVec, lasersVec);
+        auto packetWrapper = Protocol::CreatePacketWrapper(builder, Protocol::PacketType_GameStateS2C, gameState.Union());
+
+        builder.Finish(packetWrapper);
+        Broadcast(ENET_PACKET_FLAG_RELIABLE, Net::Channel::Bulk, { &peer, 1 });
+    }
+
+    void GameServer::SendSpawnPlayerS2C(const Protocol::Player* player, std::span<ENetPeer* const> peers) {
+        builder.Clear();
+        auto telPacket = Protocol::CreateSpawnPlayerS2C(builder, player);
+        auto packetWrapper = Protocol::CreatePacketWrapper(builder, Protocol::PacketType_SpawnPlayerS2C, telPacket.Union());
+        builder.Finish(packetWrapper);
+        QueueEvent(peers);
+    }
+
+    void GameServer::SendDespawnPlayerS2C(uint32_t uuid, std::span<ENetPeer* const> peers) {
+        builder.Clear();
+        auto telPacket = Protocol::CreateDespawnPlayerS2C(builder, uuid);
+        auto packetWrapper = Protocol::CreatePacketWrapper(builder, Protocol::PacketType_DespawnPlayerS2C, telPacket.Union());
+
+        builder.Finish(packetWrapper);
+        QueueEvent(peers);
+    }
+
+    void GameServer::SendTeleportPlayerS2C(const Protocol::Player* player, uint64_t time, std::span<ENetPeer* const> peers) {
+        builder.Clear();
+        auto telPacket = Protocol::CreateTeleportPlayerS2C(builder, time, player);
+        auto packetWrapper = Protocol::CreatePacketWrapper(builder, Protocol::PacketType_TeleportPlayerS2C, telPacket.Union());
+
+        builder.Finish(packetWrapper);
+        Broadcast(ENET_PACKET_FLAG_UNRELIABLE_FRAGMENT, Net::Channel::State, peers);
+    }
+
+    void GameServer::SendSpawnLaserS2C(const Protocol::Laser* laser, uint64_t time, std::span<ENetPeer* const> peers) {
+        builder.Clear();
+        flatbuffers::Offset<Protocol::SpawnLaserS2C> telPacket;
+        if (Core::CVarReadInt(this->quantize) != 0)
+        {
+            Net::LaserState state;
+            state.uuid = laser->uuid();
+            state.startTime = laser->start_time();
+            state.endTime = laser->end_time();
+            state.origin = glm::vec3(laser->origin().x(), laser->origin().y(), laser->origin().z());
+            state.direction = glm::quat(laser->direction().w(), laser->direction().x(), laser->direction().y(), laser->direction().z());
+
+            this->laserData.clear();
+            Net::WriteLaserState(state, time, this->laserData);
+            auto dataVec = builder.CreateVector(this->laserData);
+            telPacket = Protocol::CreateSpawnLaserS2C(builder, nullptr, time, dataVec);
+        }
+        else
+        {
+            telPacket = Protocol::CreateSpawnLaserS2C(builder, laser);
+        }
+        auto packetWrapper = Protocol::CreatePacketWrapper(builder, Protocol::PacketType_SpawnLaserS2C, telPacket.Union());
+
+        builder.Finish(packetWrapper);
+        QueueEvent(peers);
+    }
+
+    void GameServer::SendDespawnLaserS2C(uint32_t uuid, std::span<ENetPeer* const> peers) {
+        builder.Clear();
+        auto telPacket = Protocol::CreateDespawnLaserS2C(builder, uuid);
+        auto packetWrapper = Protocol::CreatePacketWrapper(builder, Protocol::PacketType_DespawnLaserS2C, telPacket.Union());
+
+        builder.Finish(packetWrapper);
+        QueueEvent(peers);
+    }
+
+    //------------------------------------------------------------------------------
+
+    static Net::PlayerState ToPlayerState(const Protocol::Player& player)
+    {
+        Net::PlayerState state;
+        state.uuid = player.uuid();
+        state.position = glm::vec3(player.position().x(), player.position().y(), player.position().z());
+        state.velocity = glm::vec3(player.velocity().x(), player.velocity().y(), player.velocity().z());
+        state.acceleration = glm::vec3(player.acceleration().x(), player.acceleration().y(), player.acceleration().z());
+        state.direction = glm::quat(player.direction().w(), player.direction().x(), player.direction().y(), player.direction().z());
+        return state;
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+        Every peer gets the players in its interest set encoded against the newest
+        snapshot it acknowledged. A peer that has not acknowledged anything recent
+        enough to still be in its history gets them in full. With
+        sv_delta_snapshots 0 they are sent as the plain player list.
+
+        Players outside the interest set are sent in full every
+        sv_interest_far_interval ticks, staggered by uuid.
+
+        With a sv_peer_bandwidth budget every player in the interest set stays
+        in the delta stream, unchanged ones cost nothing there. The priority
+        scheduler only picks among the changed near players, charged what
+        their delta takes, and the far ones, which come in full. A changed
+        near player that was not picked keeps the state the peer has from the
+        baseline, so it is neither removed nor resent in full later.
+    */
+    void GameServer::SendSnapshotS2C(uint64_t time, std::span<ENetPeer* const> peers) {
+        if (peers.empty())
+            return;
+
+        bool const delta = Core::CVarReadInt(this->deltaSnapshots) != 0;
+        Net::Encoding const encoding = (Core::CVarReadInt(this->quantize) != 0) ? Net::Encoding::Quantized : Net::Encoding::Raw;
+        uint64_t const farInterval = (uint64_t)std::max(1, Core::CVarReadInt(this->farInterval));
+
+        // In spaceShips order
+        this->tickStates.clear();
+        for (const SpaceShip& ship : spaceShips)
+        {
+            Net::PlayerState player = ToPlayerState(ship.player);
+            // keep what the client will see, changes below the quantization step are not sent
+            if (encoding == Net::Encoding::Quantized)
+                Net::QuantizePlayerState(player);
+            this->tickStates.push_back(player);
+        }
+
+        for (ENetPeer* peer : peers)
+        {
+            ClientState* client = GetClient(peer);
+
+            uint64_t baselineTick = 0;
+            const Net::Snapshot* baseline = nullptr;
+            if (delta && client->ackedTick != 0 && this->currentTick - client->ackedTick < Net::SnapshotHistory::Size)
+            {
+                baseline = client->history.Find(client->ackedTick);
+                if (baseline != nullptr)
+                    baselineTick = client->ackedTick;
+            }
+
+            // The baseline is still in the history, Store only overwrites the oldest entry
+            Net::Snapshot* current = delta ? &client->history.Store(this->currentTick) : nullptr;
+            this->snapshotPlayers.clear();
+            this->farStates.clear();
+
+            uint32_t budget = delta ? this->SnapshotBudget(*client) : 0;
+            if (budget > 0)
+            {
+                // Baseline players that left the interest set are written as removed
+                if (baseline != nullptr)
+                {
+                    uint32_t removedBytes = 0;
+                    for (const Net::PlayerState& old : baseline->players)
+                    {
+                        if (!std::binary_search(client->nearPlayers.begin(), client->nearPlayers.end(), old.uuid))
+                            removedBytes += (uint32_t)Net::RemovedPlayerSize(old.uuid);
+                    }
+                    budget = budget > removedBytes ? budget - removedBytes : 1;
+                }
+
+                this->SchedulePlayers(*client, budget, encoding, baseline);
+                std::sort(this->scheduledPlayers.begin(), this->scheduledPlayers.end());
+
+                // nearPlayers is sorted and holds the own ship, prediction reconciles against it
+                for (uint32_t near : client->nearPlayers)
+                {
+                    size_t const i = spaceShips.FindIndex(near);
+                    if (i == spaceShips.Size())
+                        continue;
+                    const Net::PlayerState* old = (baseline != nullptr) ? baseline->Find(near) : nullptr;
+                    if (near == client->shipUuid || std::binary_search(this->scheduledPlayers.begin(), this->scheduledPlayers.end(), near))
+                        current->players.push_back(this->tickStates[i]);
+                    else if (old != nullptr)
+                        current->players.push_back(*old);
+                }
+                for (uint32_t uuid : this->scheduledPlayers)
+                {
+                    if (!std::binary_search(client->nearPlayers.begin(), client->nearPlayers.end(), uuid))
+                        this->farStates.push_back(this->tickStates[spaceShips.FindIndex(uuid)]);
+                }
+            }
+            else
+            {
+                // nearPlayers is sorted so the snapshot comes out sorted by uuid
+                for (uint32_t near : client->nearPlayers)
+                {
+                    size_t const i = spaceShips.FindIndex(near);
+                    if (i == spaceShips.Size())
+                        continue;
+                    if (delta)
+                        current->players.push_back(this->tickStates[i]);
+                    else
+                        this->snapshotPlayers.push_back(spaceShips[i].player);
+                }
+
+                for (const Net::PlayerState& player : this->tickStates)
+                {
+                    if ((player.uuid + this->currentTick) % farInterval == 0 && !std::binary_search(client->nearPlayers.begin(), client->nearPlayers.end(), player.uuid))
+                        this->farStates.push_back(player);
+                }
+            }
+
+            builder.Clear();
+            flatbuffers::Offset<flatbuffers::Vector<uint8_t>> farVec;
+            if (!this->farStates.empty())
+            {
+                this->snapshotFar.clear();
+                Net::WritePlayerStates(this->farStates, encoding, this->snapshotFar);
+                farVec = builder.CreateVector(this->snapshotFar);
+            }
+
+            flatbuffers::Offset<Protocol::SnapshotS2C> snapshot;
+            if (delta)
+            {
+                this->snapshotDelta.clear();
+                Net::WriteSnapshotDelta(baseline, *current, encoding, this->snapshotDelta);
+                auto deltaVec = builder.CreateVector(this->snapshotDelta);
+                snapshot = Protocol::CreateSnapshotS2C(builder, this->currentTick, time, 0, baselineTick, deltaVec, encoding == Net::Encoding::Quantized, farVec, client->input.Ack());
+            }
+            else
+            {
+                auto playersVec = builder.CreateVectorOfStructs(this->snapshotPlayers.data(), this->snapshotPlayers.size());
+                snapshot = Protocol::CreateSnapshotS2C(builder, this->currentTick, time, playersVec, 0, 0, encoding == Net::Encoding::Quantized, farVec, client->input.Ack());
+            }
+            auto packetWrapper = Protocol::CreatePacketWrapper(builder, Protocol::PacketType_SnapshotS2C, snapshot.Union());
+
+            builder.Finish(packetWrapper);
+            Broadcast(ENET_PACKET_FLAG_UNRELIABLE_FRAGMENT, Net::Channel::State, { &peer, 1 });
+        }
+    }
+
+    /// bytes of a snapshot packet besides the player updates: UDP and ENet headers, the flatbuffer tables and the own ship
+    static const uint32_t SnapshotOverhead = 128;
+    /// lowest fraction of sv_peer_bandwidth a throttled peer still gets
+    static const float MinBudgetFraction = 0.25f;
+    /// priority factors of ships that fire and of ships that neither steer nor move
+    static const float FiringPriority = 2.0f;
+    static const float IdlePriority = 0.1f;
+    /// units per second below which an unsteered ship counts as idle
+    static const float IdleSpeed = 0.05f;
+
+    //------------------------------------------------------------------------------
+    /**
+        ENet lowers a peer's throttle when its round trip rises above the
+        average or packets get lost, and raises it again as the link recovers.
+        The budget follows it, down to MinBudgetFraction so the peer still sees
+        the nearest ships move.
+    */
+    uint32_t GameServer::SnapshotBudget(const ClientState& client) const
+    {
+        int const bandwidth = Core::CVarReadInt(this->peerBandwidth);
+        if (bandwidth <= 0)
+            return 0;
+
+        float const throttle = std::max(MinBudgetFraction, (float)client.packetThrottle / (float)ENET_PEER_PACKET_THROTTLE_SCALE);
+        float const perTick = bandwidth * 1000.0f * throttle / std::max(1, this->scheduler.GetTickRate());
+        return (uint32_t)std::max(1.0f, perTick - SnapshotOverhead);
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+        A player's priority falls off with its distance from the peer's ship,
+        in units of the interest radius, so the nearest ships are sent nearly
+        every tick and far ones at a rate that drops with the square of the
+        distance. Firing ships count double, ships that are neither steered nor
+        moving a tenth, their state barely changes. Time since the last send
+        is what the accumulator adds up.
+
+        Bandwidth per peer stays at the budget however many players there are,
+        more players only share it. Near players cost what their delta against
+        baseline takes, far ones their full state.
+    */
+    void GameServer::SchedulePlayers(ClientState& client, uint32_t budget, Net::Encoding encoding, const Net::Snapshot* baseline)
+    {
+        const SpaceShip* own = spaceShips.Get(client.ship);
+        float const radius = Core::CVarReadFloat(this->interestRadius) > 0.0f ? Core::CVarReadFloat(this->interestRadius) : 40.0f;
+
+        client.priorities.Begin();
+        for (size_t i = 0; i < spaceShips.Size(); i++)
+        {
+            const SpaceShip& ship = spaceShips[i];
+            if (ship.uuid == client.shipUuid)
+                continue;
+
+            float const distance = (own != nullptr) ? glm::distance(own->position, ship.position) / radius : 0.0f;
+            float priority = 1.0f / (1.0f + distance * distance);
+            if (ship.bitmap & (1 << 7))
+                priority *= FiringPriority;
+            else if (ship.bitmap == 0 && glm::length(ship.linearVelocity) * SpaceShip::velocityScale < IdleSpeed)
+                priority *= IdlePriority;
+            uint32_t cost = (uint32_t)Net::PlayerStateSize(ship.uuid, encoding);
+            if (std::binary_search(client.nearPlayers.begin(), client.nearPlayers.end(), ship.uuid))
+            {
+                // Unchanged near players are in the delta stream for free
+                cost = (uint32_t)Net::PlayerDeltaSize((baseline != nullptr) ? baseline->Find(ship.uuid) : nullptr, this->tickStates[i], encoding);
+                if (cost == 0)
+                    continue;
+            }
+            client.priorities.Add(ship.uuid, priority, cost);
+        }
+
+        this->scheduledPlayers.clear();
+        client.priorities.Select(budget, this->scheduledPlayers);
+    }
+
+} // namespace Game
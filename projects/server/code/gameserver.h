@@ -0,0 +1,268 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+	Game server
+
+	Owns the authoritative simulation, the asteroid colliders and the ENet host.
+	Has no window or render device dependencies so it can be driven by both the
+	windowed server and the headless dedicated server.
+
+	(C) 2024 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include "spaceship.h"
+#include "core/tickscheduler.h"
+#include "core/slotmap.h"
+#include "render/physics.h"
+#include "net/snapshot.h"
+#include "net/interestgrid.h"
+#include "net/rewindhistory.h"
+#include "net/inputstream.h"
+#include "net/clocksync.h"
+#include "net/netthread.h"
+#include "net/conditioner.h"
+#include "net/capture.h"
+#include "net/priority.h"
+#include "net/compressor.h"
+#include "net/channels.h"
+#include "net/eventbatch.h"
+#include "net/loopback.h"
+#include "allocstats.h"
+#include "metrics.h"
+#include "enet/enet.h"
+#include <proto.h>
+#include <vector>
+#include <span>
+#include <functional>
+
+namespace Core
+{
+struct CVar;
+}
+
+namespace Game
+{
+/// per peer replication state, ENetPeer::data holds the handle of its slot
+struct ClientState
+{
+	ENetPeer* peer = nullptr;
+	/// the peer's space ship
+	Util::SlotId ship = Util::SlotId::Invalid();
+	uint32_t shipUuid = 0;
+	/// newest snapshot tick the peer acknowledged, 0 if none
+	uint64_t ackedTick = 0;
+	/// ENet's round trip estimate in ms, as of the newest event from the peer
+	uint32_t roundTripTime = 0;
+	/// ENet's packet loss estimate scaled by ENET_PEER_PACKET_LOSS_SCALE, as of the newest event from the peer
+	uint32_t packetLoss = 0;
+	/// ENet's throttle of unreliable packets scaled by ENET_PEER_PACKET_THROTTLE_SCALE, as of the newest event from the peer
+	uint32_t packetThrottle = ENET_PEER_DEFAULT_PACKET_THROTTLE;
+	/// sequenced inputs, applied to the ship one per tick
+	Net::InputReceiver input;
+	/// ms between the server state the peer sees and the server's clock, from the render time of its inputs or estimated from their timestamps and the round trip time
+	uint32_t viewDelay = 0;
+	/// snapshots sent to this peer, baselines for the delta encoding
+	Net::SnapshotHistory history;
+	/// players within the interest radius, sorted by uuid
+	std::vector<uint32_t> nearPlayers;
+	/// picks the other players sent each tick when sv_peer_bandwidth is set
+	Net::PriorityAccumulator priorities;
+	/// lasers the peer has been sent a spawn for, sorted by uuid
+	std::vector<uint32_t> visibleLasers;
+	/// visible lasers of the current tick, swapped with visibleLasers
+	std::vector<uint32_t> nextVisibleLasers;
+	/// spawns and despawns queued for the peer this tick, indices into GameServer's event batch
+	std::vector<uint32_t> pendingEvents;
+};
+
+class GameServer
+{
+public:
+	/// outcome of a Replay
+	struct ReplayResult
+	{
+		uint64_t ticks = 0;
+		uint64_t events = 0;
+		/// ticks that did not get the number they were recorded with
+		uint64_t mismatchedTicks = 0;
+		/// packets and bytes sent, counted once per peer
+		uint64_t packetsSent = 0;
+		uint64_t bytesSent = 0;
+		/// FNV-1a of every message sent and the peers it went to, equal for builds that send the same
+		uint64_t digest = 14695981039346656037ull;
+		/// wall clock time of the replay
+		double seconds = 0.0;
+	};
+
+	/// constructor
+	GameServer();
+	/// destructor
+	~GameServer();
+
+	/// setup asteroid colliders and create the ENet host, with loopback it is attached to it at port and runs in lockstep, see Step
+	bool Open(uint16_t port, int playerLimit, Net::Loopback* loopback = nullptr);
+	/// destroy the ENet host
+	void Close();
+	/// handle all pending ENet events
+	void Service();
+	/// run all simulation ticks that are due, returns the number of ticks run
+	int Tick();
+	/// block until the next simulation tick is due
+	void WaitForNextTick();
+	/// with a loopback, handle the pending events, run one tick and send its messages, server time advances by exactly one tick
+	void Step();
+	/// with a loopback, set ENet's clock to the current step's time, before servicing the other hosts on it
+	void HoldENetTime() const;
+	/// step the simulation and send the resulting state to all peers
+	void Update(float dt);
+	/// test ships against asteroids, lasers and each other, teleports the ships that hit something
+	void CheckCollisions(uint64_t time);
+	/// sample the peers and write a metrics line
+	void WriteMetrics(uint64_t time);
+	/// run the session recorded with sv_capture at path as fast as possible, instead of Open, prints the digest every digestInterval ticks if not 0
+	bool Replay(const char* path, uint32_t digestInterval, ReplayResult& result, const std::function<void(const uint8_t* data, size_t size)>& sent = nullptr);
+
+	/// fixed rate simulation clock, rate is controlled by sv_tickrate
+	Core::TickScheduler scheduler;
+	/// number of simulation steps taken
+	uint64_t currentTick = 0;
+
+	/// asteroid collider transforms, in creation order
+	std::vector<glm::mat4> asteroids = {};
+
+	/// connected peers, in the same order as clients
+	std::vector<ENetPeer*> peers = {};
+	Util::SlotMap<ClientState> clients;
+	/// keyed by uuid
+	Util::SlotMap<SpaceShip> spaceShips;
+	Util::SlotMap<Laser> lasers;
+
+	/// heap allocations made by all Tick() calls, divide by currentTick for the average per tick
+	AllocStats tickAllocs;
+	/// services the host instead of Service() when sv_net_thread is set
+	Net::NetThread netThread;
+	/// simulated latency, loss and bandwidth of received datagrams, controlled by the sv_netsim_ cvars
+	Net::Conditioner conditioner;
+	/// phase timings, peer and traffic statistics, written every sv_metrics_interval seconds
+	ServerMetrics metrics;
+
+private:
+	void SetupAsteroids();
+	void HandleEvent(const Net::NetEvent& event);
+	/// append event to the capture file
+	void Capture(const Net::NetEvent& event);
+	/// ms, the recorded time during Replay
+	uint64_t ServerTime() const;
+	static uint64_t Digest(uint64_t digest, const void* data, size_t size);
+	void ProcessReceivedPacket(const void* data, size_t dataLength , ENetPeer* sender);
+	void SpawnSpaceShip(uint32_t uuid, ENetPeer* peer);
+	ClientState* GetClient(const ENetPeer* peer);
+	void RemoveClient(ENetPeer* peer);
+	void ApplyInputs();
+	void UpdateInterest(uint64_t time);
+	void CollectInterestedPeers(uint32_t shipUuid, std::vector<ENetPeer*>& out);
+	void DespawnLaser(uint32_t uuid);
+
+	/// send the finished builder to peers on channel as one reference counted packet
+	void Broadcast(enet_uint32 flags, Net::Channel channel, std::span<ENetPeer* const> peers);
+	/// queue the finished builder as an event for peers, sent with the others of the tick by FlushEvents
+	void QueueEvent(std::span<ENetPeer* const> peers);
+	/// send every peer its queued events as one reliable EventsS2C
+	void FlushEvents();
+	void SendClientConnectS2C(uint16_t uuid, ENetPeer* peer);
+	void SendClockSyncS2C(uint64_t clientTime, ENetPeer* peer);
+	void SendGameStateS2C(ENetPeer* peer);
+	void SendSpawnPlayerS2C(const Protocol::Player* player, std::span<ENetPeer* const> peers);
+	void SendDespawnPlayerS2C(uint32_t uuid, std::span<ENetPeer* const> peers);
+	void SendTeleportPlayerS2C(const Protocol::Player* player, uint64_t time, std::span<ENetPeer* const> peers);
+	void SendSpawnLaserS2C(const Protocol::Laser* laser, uint64_t time, std::span<ENetPeer* const> peers);
+	void SendDespawnLaserS2C(uint32_t uuid, std::span<ENetPeer* const> peers);
+	void SendSnapshotS2C(uint64_t time, std::span<ENetPeer* const> peers);
+	/// bytes of player updates client gets this tick, 0 if unlimited
+	uint32_t SnapshotBudget(const ClientState& client) const;
+	/// pick the players sent to client this tick into scheduledPlayers, near ones that did not change since baseline are not candidates
+	void SchedulePlayers(ClientState& client, uint32_t budget, Net::Encoding encoding, const Net::Snapshot* baseline);
+
+	ENetHost* host = nullptr;
+	uint32_t uuid = 0;
+	Core::CVar* tickRate = nullptr;
+	Core::CVar* deltaSnapshots = nullptr;
+	Core::CVar* quantize = nullptr;
+
+	Core::CVar* interestRadius = nullptr;
+	Core::CVar* farInterval = nullptr;
+	Core::CVar* peerBandwidth = nullptr;
+	Core::CVar* reportAllocs = nullptr;
+	Core::CVar* broadphase = nullptr;
+	Core::CVar* lagCompensation = nullptr;
+	Core::CVar* maxInterpolation = nullptr;
+	Core::CVar* socketBatching = nullptr;
+	Core::CVar* eventBatching = nullptr;
+	Core::CVar* compression = nullptr;
+	Core::CVar* useNetThread = nullptr;
+	Core::CVar* metricsInterval = nullptr;
+	Core::CVar* metricsPath = nullptr;
+	Core::CVar* capturePath = nullptr;
+
+	/// tickAllocs and tick at the last sv_report_allocs print
+	AllocStats reportedAllocs;
+	uint64_t reportedTick = 0;
+
+	/// sv_metrics_file or stdout
+	FILE* metricsFile = nullptr;
+	/// server time of the next metrics write
+	uint64_t nextMetricsTime = 0;
+	/// scheduler.droppedTicks at the last metrics write
+	uint64_t metricsDroppedTicks = 0;
+
+	/// written while sv_capture is set
+	Net::CaptureWriter capture;
+	/// true during Replay
+	bool replaying = false;
+	/// opened on a loopback, time only advances with Step
+	bool lockstep = false;
+	/// ms, server time when the loopback was opened and of the current Step
+	uint64_t lockstepStart = 0;
+	uint64_t lockstepTime = 0;
+	/// ENet's time when the loopback was opened
+	uint32_t lockstepENetStart = 0;
+	/// ms, server time of the record being replayed
+	uint64_t replayTime = 0;
+	ReplayResult replayResult;
+	/// called with every message sent during a replay, once however many peers it goes to
+	std::function<void(const uint8_t* data, size_t size)> replaySent;
+
+	/// ship positions of the current tick
+	Net::InterestGrid interestGrid;
+	std::vector<Net::InterestGrid::Entry> interestQuery;
+	/// interest set being rebuilt, swapped into ClientState::nearPlayers
+	std::vector<uint32_t> nextNearPlayers;
+	/// peers of the current tick that get a laser spawn or teleport
+	std::vector<ENetPeer*> interestedPeers;
+
+	/// ship positions of the current tick, ids are indices into spaceShips
+	Net::InterestGrid collisionGrid;
+	std::vector<Net::InterestGrid::Entry> collisionCandidates;
+	/// indices of the ships hit by a laser this tick, sorted
+	std::vector<uint32_t> laserHits;
+	/// ship positions of the last ticks, for lag compensated laser hits
+	Net::RewindHistory rewindHistory;
+
+	/// shared by all Send functions, cleared before each message
+	flatbuffers::FlatBufferBuilder builder;
+	/// state of all players this tick, in spaceShips order
+	std::vector<Net::PlayerState> tickStates;
+	std::vector<Net::PlayerState> farStates;
+	/// uuids picked by SchedulePlayers
+	std::vector<uint32_t> scheduledPlayers;
+	std::vector<Protocol::Player> snapshotPlayers;
+	std::vector<uint8_t> snapshotDelta;
+	std::vector<uint8_t> snapshotFar;
+	std::vector<uint8_t> laserData;
+	/// events queued this tick
+	Net::EventBatch events;
+	/// the events of one peer, framed
+	std::vector<uint8_t> eventFrames;
+};
+
+} // namespace Game
@@ -0,0 +1,138 @@
+//------------------------------------------------------------------------------
+// headlessapp.cc
+// (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "config.h"
+#include "headlessapp.h"
+#include "core/cvar.h"
+#include <atomic>
+#include <csignal>
+#include <algorithm>
+#include "enet/enet.h"
+
+namespace Game
+{
+
+    static std::atomic<bool> running = false;
+
+    //------------------------------------------------------------------------------
+
+    static void HandleSignal(int)
+    {
+        running = false;
+    }
+
+    //------------------------------------------------------------------------------
+
+    HeadlessApp::HeadlessApp()
+    {
+        this->maxPlayers = Core::CVarCreate(Core::CVar_Int, "sv_max_players", "32", "Most clients connected at once, raise it for load tests with the bot client");
+        this->replay = Core::CVarCreate(Core::CVar_String, "sv_replay", "", "Replay a file recorded with sv_capture as fast as possible without sockets and exit instead of running the server");
+        this->replayDigestInterval = Core::CVarCreate(Core::CVar_Int, "sv_replay_digest_interval", "0", "Ticks between printed digests of what the replay sent so far, diff the output of two builds to find where they diverge");
+    }
+
+    //------------------------------------------------------------------------------
+
+    HeadlessApp::~HeadlessApp() { }
+
+    //------------------------------------------------------------------------------
+
+    bool HeadlessApp::Open()
+    {
+        App::Open();
+        std::signal(SIGINT, HandleSignal);
+        std::signal(SIGTERM, HandleSignal);
+        running = true;
+        return true;
+    }
+
+    //------------------------------------------------------------------------------
+
+    void HeadlessApp::Run()
+    {
+        const char* const replayPath = Core::CVarReadString(this->replay);
+        if (replayPath[0] != '\0')
+        {
+            this->RunReplay(replayPath);
+            return;
+        }
+
+        if (!this->server.Open(7777, std::clamp<int>(Core::CVarReadInt(this->maxPlayers), 1, ENET_PROTOCOL_MAXIMUM_PEER_ID)))
+            return;
+
+        printf("Headless server running at %d ticks per second, press Ctrl+C to stop.\n", this->server.scheduler.GetTickRate());
+
+        while (running)
+        {
+            this->server.Service();
+            this->server.Tick();
+            this->server.WaitForNextTick();
+        }
+
+        printf("Ran %llu ticks, %llu overruns, %llu ticks skipped.\n",
+            (unsigned long long)this->server.scheduler.tick,
+            (unsigned long long)this->server.scheduler.overruns,
+            (unsigned long long)this->server.scheduler.droppedTicks);
+
+        uint64_t const ticks = std::max<uint64_t>(1, this->server.currentTick);
+        printf("Allocations per tick: %.1f (%.0f bytes), ENet %.1f (%.0f bytes).\n",
+            (double)this->server.tickAllocs.allocations / ticks, (double)this->server.tickAllocs.bytes / ticks,
+            (double)this->server.tickAllocs.enetAllocations / ticks, (double)this->server.tickAllocs.enetBytes / ticks);
+
+        if (this->server.netThread.Running())
+        {
+            Net::NetThread::QueueStats const queues[2] = { this->server.netThread.InboundStats(), this->server.netThread.OutboundStats() };
+            const char* const names[2] = { "inbound", "outbound" };
+            for (int i = 0; i < 2; i++)
+            {
+                printf("Network thread %s: %llu items, mean latency %.0f us, max %llu us, max depth %u.\n", names[i],
+                    (unsigned long long)queues[i].items,
+                    queues[i].items > 0 ? (double)queues[i].totalLatency / queues[i].items : 0.0,
+                    (unsigned long long)queues[i].maxLatency,
+                    queues[i].maxDepth);
+            }
+        }
+
+        if (this->server.conditioner.Attached())
+        {
+            Net::Conditioner::Stats const conditioned = this->server.conditioner.GetStats();
+            printf("Network conditioner: %llu datagrams received, %llu dropped, %llu over the bandwidth limit, %llu duplicated, %llu reordered.\n",
+                (unsigned long long)conditioned.received,
+                (unsigned long long)conditioned.dropped,
+                (unsigned long long)conditioned.overflowed,
+                (unsigned long long)conditioned.duplicated,
+                (unsigned long long)conditioned.reordered);
+        }
+
+        this->server.Close();
+    }
+
+    //------------------------------------------------------------------------------
+
+    void HeadlessApp::RunReplay(const char* path)
+    {
+        GameServer::ReplayResult result;
+        if (!this->server.Replay(path, (uint32_t)std::max(0, Core::CVarReadInt(this->replayDigestInterval)), result))
+            return;
+
+        printf("Replayed %llu ticks and %llu events in %.3f s, %.1f us per tick.\n",
+            (unsigned long long)result.ticks,
+            (unsigned long long)result.events,
+            result.seconds,
+            result.ticks > 0 ? result.seconds * 1000000.0 / result.ticks : 0.0);
+        printf("Sent %llu packets, %llu bytes, digest %016llx.\n",
+            (unsigned long long)result.packetsSent,
+            (unsigned long long)result.bytesSent,
+            (unsigned long long)result.digest);
+        if (result.mismatchedTicks > 0)
+            printf("%llu ticks were numbered differently than when recorded, the capture comes from a different session setup.\n", (unsigned long long)result.mismatchedTicks);
+    }
+
+    //------------------------------------------------------------------------------
+
+    void HeadlessApp::Exit()
+    {
+        running = false;
+    }
+
+} // namespace Game
@@ -0,0 +1,44 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+	Headless dedicated server application
+
+	Runs the game server without a window, GL context or render device.
+
+	(C) 2024 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include "core/app.h"
+#include "gameserver.h"
+
+namespace Core
+{
+struct CVar;
+}
+
+namespace Game
+{
+class HeadlessApp : public Core::App
+{
+public:
+	/// constructor
+	HeadlessApp();
+	/// destructor
+	~HeadlessApp();
+
+	/// open app
+	bool Open();
+	/// run app until Exit is called or the process is interrupted
+	void Run();
+	/// exit app
+	void Exit();
+private:
+	/// replay a capture at full speed and print how long it took and what it sent
+	void RunReplay(const char* path);
+
+	GameServer server;
+	Core::CVar* maxPlayers = nullptr;
+	Core::CVar* replay = nullptr;
+	Core::CVar* replayDigestInterval = nullptr;
+};
+} // namespace Game
@@ -4,11 +4,13 @@
 //------------------------------------------------------------------------------
 #include "config.h"
 #include "spacegameapp.h"
+#include "core/cvar.h"
 
 int
 main(int argc, const char** argv)
 {
 	Game::SpaceGameApp app;
+	Core::CVarParseCommandLine(argc, argv);
 	if (app.Open())
 	{
 		app.Run();
@@ -0,0 +1,153 @@
+//------------------------------------------------------------------------------
+// metrics.cc
+// (C) 2024 Individual contributors, see AUTHORS file
+//------------------------------------------------------------------------------
+#include "config.h"
+#include "metrics.h"
+#include "enet/enet.h"
+#include <chrono>
+
+namespace Game
+{
+
+    static const char* const phaseNames[(size_t)TickPhase::Count] = {
+        "service", "inputs", "ships", "collisions", "lasers", "interest", "snapshots"
+    };
+
+    //------------------------------------------------------------------------------
+    /**
+        Writes "name":{...} with the values divided by scale.
+    */
+    static void WriteHistogram(FILE* file, const char* name, const Core::Histogram& histogram, double scale)
+    {
+        fprintf(file, "\"%s\":{\"count\":%llu,\"mean\":%.3f,\"min\":%.3f,\"p50\":%.3f,\"p90\":%.3f,\"p99\":%.3f,\"max\":%.3f}",
+            name,
+            (unsigned long long)histogram.Count(),
+            histogram.Mean() / scale,
+            histogram.Min() / scale,
+            histogram.Percentile(50.0) / scale,
+            histogram.Percentile(90.0) / scale,
+            histogram.Percentile(99.0) / scale,
+            histogram.Max() / scale);
+    }
+
+    //------------------------------------------------------------------------------
+
+    uint64_t ServerMetrics::Now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    //------------------------------------------------------------------------------
+
+    void ServerMetrics::RecordTick(uint64_t duration)
+    {
+        this->ticks.Record(duration);
+    }
+
+    //------------------------------------------------------------------------------
+
+    void ServerMetrics::RecordSent(Protocol::PacketType type, size_t bytes, size_t peers)
+    {
+        if (type > Protocol::PacketType_MAX)
+            return;
+        this->sent[type].packets += peers;
+        this->sent[type].bytes += bytes * peers;
+    }
+
+    //------------------------------------------------------------------------------
+
+    void ServerMetrics::RecordReceived(Protocol::PacketType type, size_t bytes)
+    {
+        if (type > Protocol::PacketType_MAX)
+            return;
+        this->received[type].packets++;
+        this->received[type].bytes += bytes;
+    }
+
+    //------------------------------------------------------------------------------
+
+    void ServerMetrics::RecordPeer(uint32_t roundTripTime, uint32_t packetLoss)
+    {
+        this->roundTrips.Record(roundTripTime);
+        this->packetLoss.Record((uint64_t)packetLoss * 10000 / ENET_PEER_PACKET_LOSS_SCALE);
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+        Phase and tick times are written in us, round trips in ms and packet
+        loss in percent. Traffic is the flatbuffer payload, without ENet's and
+        UDP's headers, listed for the message types that were used. ENet's
+        allocations are counted over the interval, blocks in use and the
+        pool's slabs are what they are at the time of the write.
+    */
+    void ServerMetrics::Write(FILE* file, uint64_t time, const Counts& counts)
+    {
+        fprintf(file, "{\"time\":%llu,\"interval_ms\":%llu,\"tick\":%llu,\"dropped_ticks\":%llu,\"peers\":%zu,\"ships\":%zu,\"lasers\":%zu,",
+            (unsigned long long)time,
+            (unsigned long long)(this->lastWrite != 0 ? time - this->lastWrite : 0),
+            (unsigned long long)counts.tick,
+            (unsigned long long)counts.droppedTicks,
+            counts.peers,
+            counts.ships,
+            counts.lasers);
+
+        WriteHistogram(file, "tick_us", this->ticks, 1000.0);
+        fprintf(file, ",\"phases_us\":{");
+        for (size_t i = 0; i < (size_t)TickPhase::Count; i++)
+        {
+            if (i > 0)
+                fputc(',', file);
+            WriteHistogram(file, phaseNames[i], this->phases[i], 1000.0);
+        }
+        fputc('}', file);
+
+        fputc(',', file);
+        WriteHistogram(file, "rtt_ms", this->roundTrips, 1.0);
+        fputc(',', file);
+        WriteHistogram(file, "loss_pct", this->packetLoss, 100.0);
+
+        Traffic const* const traffic[2] = { this->sent, this->received };
+        const char* const trafficNames[2] = { "sent", "received" };
+        for (int direction = 0; direction < 2; direction++)
+        {
+            fprintf(file, ",\"%s\":{", trafficNames[direction]);
+            bool first = true;
+            for (int type = 0; type <= Protocol::PacketType_MAX; type++)
+            {
+                if (traffic[direction][type].packets == 0)
+                    continue;
+                fprintf(file, "%s\"%s\":{\"packets\":%llu,\"bytes\":%llu}",
+                    first ? "" : ",",
+                    Protocol::EnumNamePacketType((Protocol::PacketType)type),
+                    (unsigned long long)traffic[direction][type].packets,
+                    (unsigned long long)traffic[direction][type].bytes);
+                first = false;
+            }
+            fputc('}', file);
+        }
+
+        fprintf(file, ",\"enet_pool\":{\"allocations\":%llu,\"bytes\":%llu,\"large\":%llu,\"in_use\":%llu,\"reserved_bytes\":%llu}",
+            (unsigned long long)(counts.pool.allocations - this->lastPool.allocations),
+            (unsigned long long)(counts.pool.bytes - this->lastPool.bytes),
+            (unsigned long long)(counts.pool.largeAllocations - this->lastPool.largeAllocations),
+            (unsigned long long)counts.pool.blocksInUse,
+            (unsigned long long)counts.pool.reservedBytes);
+        fprintf(file, "}\n");
+        fflush(file);
+
+        for (Core::Histogram& phase : this->phases)
+            phase.Clear();
+        this->ticks.Clear();
+        this->roundTrips.Clear();
+        this->packetLoss.Clear();
+        for (int type = 0; type <= Protocol::PacketType_MAX; type++)
+        {
+            this->sent[type] = {};
+            this->received[type] = {};
+        }
+        this->lastWrite = time;
+        this->lastPool = counts.pool;
+    }
+
+} // namespace Game
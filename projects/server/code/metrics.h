@@ -0,0 +1,106 @@
+#pragma once
+//------------------------------------------------------------------------------
+/**
+	Server metrics
+
+	Collects timings of the phases of every server tick, round trip and
+	packet loss of every peer, traffic per message type, ENet's allocations
+	and entity counts.
+	Timings and peer samples go into Core::Histograms, which cost a clock read
+	and a few nanoseconds per sample. Write emits everything collected since
+	the previous call as one JSON object per line, for scripts to read.
+
+	(C) 2024 Individual contributors, see AUTHORS file
+*/
+//------------------------------------------------------------------------------
+#include "core/histogram.h"
+#include "net/packetpool.h"
+#include <proto.h>
+#include <stdio.h>
+
+namespace Game
+{
+/// parts of a server tick that are timed separately, in order
+enum class TickPhase : uint8_t
+{
+	/// handling received events, once per Service call
+	Service,
+	Inputs,
+	/// ship movement and firing
+	Ships,
+	/// collision tests and the lag compensation history
+	Collisions,
+	Lasers,
+	/// interest sets, laser spawns and despawns
+	Interest,
+	Snapshots,
+	Count
+};
+
+class ServerMetrics
+{
+public:
+	/// world state at the time of a Write
+	struct Counts
+	{
+		uint64_t tick = 0;
+		/// ticks skipped since the last Write because the server fell behind
+		uint64_t droppedTicks = 0;
+		size_t peers = 0;
+		size_t ships = 0;
+		size_t lasers = 0;
+		/// ENet's allocator totals
+		Net::PoolStats pool;
+	};
+
+	/// steady clock in ns, the time base of the phase timings
+	static uint64_t Now();
+
+	/// record the time from start until now into phase, returns now to start the next phase from
+	uint64_t Lap(TickPhase phase, uint64_t start);
+	/// record the duration of a whole tick in ns
+	void RecordTick(uint64_t duration);
+	/// a message of type and size sent to a number of peers
+	void RecordSent(Protocol::PacketType type, size_t bytes, size_t peers);
+	/// a message of type and size received
+	void RecordReceived(Protocol::PacketType type, size_t bytes);
+	/// a peer's round trip in ms and packet loss scaled by ENET_PEER_PACKET_LOSS_SCALE, sampled once per Write
+	void RecordPeer(uint32_t roundTripTime, uint32_t packetLoss);
+
+	/// write one line of JSON with everything recorded since the last Write, then start over
+	void Write(FILE* file, uint64_t time, const Counts& counts);
+
+private:
+	struct Traffic
+	{
+		uint64_t packets = 0;
+		uint64_t bytes = 0;
+	};
+
+	/// ns
+	Core::Histogram phases[(size_t)TickPhase::Count];
+	Core::Histogram ticks;
+	/// ms
+	Core::Histogram roundTrips;
+	/// hundredths of a percent
+	Core::Histogram packetLoss;
+	Traffic sent[Protocol::PacketType_MAX + 1];
+	Traffic received[Protocol::PacketType_MAX + 1];
+	/// server time of the last Write
+	uint64_t lastWrite = 0;
+	/// pool totals at the last Write
+	Net::PoolStats lastPool;
+};
+
+//------------------------------------------------------------------------------
+/**
+*/
+inline uint64_t
+ServerMetrics::Lap(TickPhase phase, uint64_t start)
+{
+	uint64_t const now = Now();
+	this->phases[(size_t)phase].Record(now - start);
+	return now;
+}
+
+} // namespace Game
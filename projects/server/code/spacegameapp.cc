@@ -17,13 +17,9 @@
 #include "core/random.h"
 #include "render/input/inputserver.h"
 #include "core/cvar.h"
-#include "render/physics.h"
 #include <chrono>
-#include "spaceship.h"
-#include <vector>
-#include "enet/enet.h"
-#include <proto.h>
-#include <utility>
+#include <algorithm>
+#include "gameserver.h"
 
 using namespace Display;
 using namespace Render;
@@ -77,176 +73,18 @@ namespace Game
         Camera* cam = CameraManager::GetCamera(CAMERA_MAIN);
         cam->projection = projection;
 
-        // load all resources
-        ModelId models[6] = {
-            LoadModel("assets/space/Asteroid_1.glb"),
-            LoadModel("assets/space/Asteroid_2.glb"),
-            LoadModel("assets/space/Asteroid_3.glb"),
-            LoadModel("assets/space/Asteroid_4.glb"),
-            LoadModel("assets/space/Asteroid_5.glb"),
-            LoadModel("assets/space/Asteroid_6.glb")
-        };
-        Physics::ColliderMeshId colliderMeshes[6] = {
-            Physics::LoadColliderMesh("assets/space/Asteroid_1_physics.glb"),
-            Physics::LoadColliderMesh("assets/space/Asteroid_2_physics.glb"),
-            Physics::LoadColliderMesh("assets/space/Asteroid_3_physics.glb"),
-            Physics::LoadColliderMesh("assets/space/Asteroid_4_physics.glb"),
-            Physics::LoadColliderMesh("assets/space/Asteroid_5_physics.glb"),
-            Physics::LoadColliderMesh("assets/space/Asteroid_6_physics.glb")
-        };
-
-        std::vector<std::tuple<ModelId, Physics::ColliderId, glm::mat4>> asteroids;
-
-        // Setup asteroids near
-        for (int i = 0; i < 100; i++)
-        {
-            std::tuple<ModelId, Physics::ColliderId, glm::mat4> asteroid;
-            size_t resourceIndex = (size_t)(Core::FastRandom() % 6);
-            std::get<0>(asteroid) = models[resourceIndex];
-            float span = 20.0f;
-            glm::vec3 translation = glm::vec3(
-                Core::RandomFloatNTP() * span,
-                Core::RandomFloatNTP() * span,
-                Core::RandomFloatNTP() * span
-            );
-            glm::vec3 rotationAxis = normalize(translation);
-            float rotation = translation.x;
-            glm::mat4 transform = glm::rotate(rotation, rotationAxis) * glm::translate(translation);
-            std::get<1>(asteroid) = Physics::CreateCollider(colliderMeshes[resourceIndex], transform);
-            std::get<2>(asteroid) = transform;
-            asteroids.push_back(asteroid);
-        }
-
-        // Setup asteroids far
-        for (int i = 0; i < 50; i++)
-        {
-            std::tuple<ModelId, Physics::ColliderId, glm::mat4> asteroid;
-            size_t resourceIndex = (size_t)(Core::FastRandom() % 6);
-            std::get<0>(asteroid) = models[resourceIndex];
-            float span = 80.0f;
-            glm::vec3 translation = glm::vec3(
-                Core::RandomFloatNTP() * span,
-                Core::RandomFloatNTP() * span,
-                Core::RandomFloatNTP() * span
-            );
-            glm::vec3 rotationAxis = normalize(translation);
-            float rotation = translation.x;
-            glm::mat4 transform = glm::rotate(rotation, rotationAxis) * glm::translate(translation);
-            std::get<1>(asteroid) = Physics::CreateCollider(colliderMeshes[resourceIndex], transform);
-            std::get<2>(asteroid) = transform;
-            asteroids.push_back(asteroid);
-        }
-
-        // Setup skybox
-        /*std::vector<const char*> skybox
-        {
-            "assets/space/bg.png",
-            "assets/space/bg.png",
-            "assets/space/bg.png",
-            "assets/space/bg.png",
-            "assets/space/bg.png",
-            "assets/space/bg.png"
-        };
-        TextureResourceId skyboxId = TextureResource::LoadCubemap("skybox", skybox, true);
-        RenderDevice::SetSkybox(skyboxId);*/
-
         Input::Keyboard* kbd = Input::GetDefaultKeyboard();
 
-        const int numLights = 40;
-        Render::PointLightId lights[numLights];
-        // Setup lights
-        /*for (int i = 0; i < numLights; i++)
-        {
-            glm::vec3 translation = glm::vec3(
-                Core::RandomFloatNTP() * 20.0f,
-                Core::RandomFloatNTP() * 20.0f,
-                Core::RandomFloatNTP() * 20.0f
-            );
-            glm::vec3 color = glm::vec3(
-                Core::RandomFloat(),
-                Core::RandomFloat(),
-                Core::RandomFloat()
-            );
-            lights[i] = Render::LightServer::CreatePointLight(translation, color, Core::RandomFloat() * 4.0f, 1.0f + (15 + Core::RandomFloat() * 10.0f));
-        }*/
-
-        /*SpaceShip ship;
-        ship.model = LoadModel("assets/space/spaceship.glb");
-        Physics::ColliderMeshId ShipCollider = Physics::LoadColliderMesh("assets/space/spaceship_physics.glb");
-        ship.collider = Physics::CreateCollider(ShipCollider, ship.transform);*/
-
-
-        ModelId laserModel = LoadModel("assets/space/laser.glb");
-
-        std::clock_t c_start = std::clock();
         double dt = 0.01667f;
 
-        //ENet
-        if (enet_initialize() != 0) {
-            fprintf(stderr, "An error Occured while initializing ENet!\n");
-        }
-        atexit(enet_deinitialize);
-
-        ENetAddress address;
-        ENetEvent event;
-        ENetHost* server;
-
-        address.host = ENET_HOST_ANY;
-        address.port = 7777;
-        
-        int playerLimit = 32;
-        server = enet_host_create(&address, playerLimit, 1, 0, 0);
-
-        if (server == NULL) {
-            fprintf(stderr, "An error occurred while trying to create the server! \n");
-        }
+        if (!this->server.Open(7777, 32))
+            return;
 
         // game loop
         while (this->window->IsOpen())
         {
-            //<Event>
-            while (enet_host_service(server, &event, 0) > 0)
-            {
-                switch (event.type)
-                {
-                    case ENET_EVENT_TYPE_CONNECT:
-                        printf("A new client connected from %x:%u.\n",
-                            event.peer->address.host,
-                            event.peer->address.port);
-                        SendClientConnectS2C(uuid, event.peer);
-                        SpawnSpaceShip(uuid, event.peer);
-                        uuid++;
-                        SendGameStateS2C(SpaceGameApp::spaceShips, SpaceGameApp::lasers, event.peer);
-                        break;
-                    case ENET_EVENT_TYPE_RECEIVE:
-                        ProcessReceivedPacket(event.packet->data, event.packet->dataLength, event.peer);
-                        break;
-                    case ENET_EVENT_TYPE_DISCONNECT:
-                        printf("%x:%u disconnected.\n",
-                            event.peer->address.host,
-                            event.peer->address.port);
-
-                        ENetPeer* peerToDespawn = event.peer;
-                        for (int i = 0; i < SpaceGameApp::peers.size(); i++) {
-                            if (event.peer == SpaceGameApp::peers[i]) {
-                                SpaceGameApp::peers.erase(SpaceGameApp::peers.begin() + i);
-                                break;
-                            }
-                        }
-
-                        auto it = std::find_if(spaceShips.begin(), spaceShips.end(), [peerToDespawn](const SpaceShip& player) {
-                            return player.peer == peerToDespawn;
-                        });
-
-                        if (it != spaceShips.end()) {
-                            SendDespawnPlayerS2C(it->uuid, SpaceGameApp::peers);
-                            spaceShips.erase(it);
-                        }
-                        break;
-                }
-            }
-            //</Event>
-            
+            this->server.Service();
+
             auto timeStart = std::chrono::steady_clock::now();
             glClear(GL_DEPTH_BUFFER_BIT);
             glEnable(GL_DEPTH_TEST);
@@ -255,69 +93,16 @@ namespace Game
 
             this->window->Update();
 
-            for (SpaceShip& ship : spaceShips) {
-                // Get the current time in milliseconds
-                uint64_t currentTime = duration_cast<chrono::milliseconds>(chrono::system_clock::now().time_since_epoch()).count();
+            // simulation runs at the fixed server tick rate, independent of the frame rate
+            this->server.Tick();
 
-                // Check if the ship is attempting to fire and enough time has passed since the last shot
-                if ((ship.bitmap & (1 << 7)) && (currentTime - ship.lastFireTime >= ship.fireRate))
-                {
-                    // Define the wing positions (right and left) using the ship's collider end points
-                    glm::vec3 wingPositions[2] = {
-                        ship.position + (ship.orientation * (ship.colliderEndPoints[5] + glm::vec3(0,0,1))), // Right wing
-                        ship.position + (ship.orientation * (ship.colliderEndPoints[4] + glm::vec3(0,0,1)))  // Left wing
-                    };
-
-                    // Iterate through both wing positions (right and left)
-                    for (int i = 0; i < 2; ++i) {
-                        glm::vec3 wingPos = wingPositions[i];
-                        Laser laser = Laser(
-                            uuid,
-                            currentTime,
-                            1000 * 10,  // 10s duration
-                            wingPos,
-                            ship.orientation
-                        );
-                        SpaceGameApp::lasers.push_back(laser);
-
-                        // Create and send the protocol laser packet
-                        Protocol::Laser l = Protocol::Laser(
-                            laser.uuid,
-                            laser.start_time,
-                            laser.end_time,
-                            Protocol::Vec3(laser.position.x, laser.position.y, laser.position.z),
-                            Protocol::Vec4(laser.direction.x, laser.direction.y, laser.direction.z, laser.direction.w)
-                        );
-
-                        SendSpawnLaserS2C(&l, peers);
-                        uuid++;
-                    }
-
-                    // Update the last fire time
-                    ship.lastFireTime = currentTime;
-                }
-
-                ship.Update(dt);
-                SendUpdatePlayerS2C(&ship.player, currentTime, peers);
+            this->DrawDebug();
 
-                if (ship.CheckCollisions(SpaceGameApp::lasers, SpaceGameApp::spaceShips)) {
-                    SendTeleportPlayerS2C(&ship.player, currentTime, peers);
-                }
-            }
-
-            // Lasers
-            for (int i = lasers.size() - 1; i >= 0; i--) {
-                lasers[i].Update(dt);
-                lasers[i].CheckCollisions();
-                if (lasers[i].marked_for_deletion) {
-                    SendDespawnLaserS2C(lasers[i].uuid, peers);
-                    /*printf("Server Laser marked for deletion: UUID: %u Position: (%f, %f, %f)\n",
-                        lasers[i].uuid,
-                        lasers[i].position.x,
-                        lasers[i].position.y,
-                        lasers[i].position.z);*/
-                    lasers.erase(lasers.begin() + i);
-                }
+            // follow the most recently updated ship
+            if (!this->server.spaceShips.Empty())
+            {
+                const SpaceShip& ship = this->server.spaceShips[this->server.spaceShips.Size() - 1];
+                cam->view = glm::lookAt(ship.camPos, ship.camPos + glm::vec3(ship.transform[2]), glm::vec3(ship.transform[1]));
             }
 
             // Execute the entire rendering pipeline
@@ -329,12 +114,11 @@ namespace Game
             auto timeEnd = std::chrono::steady_clock::now();
             dt = std::min(0.04, std::chrono::duration<double>(timeEnd - timeStart).count());
             
-            if (kbd->pressed[Input::Key::Code::Escape]) {
-                enet_host_destroy(server);
+            if (kbd->pressed[Input::Key::Code::Escape])
                 this->Exit();
-            }
-                
         }
+
+        this->server.Close();
     }
 
     //------------------------------------------------------------------------------
@@ -354,15 +138,21 @@ namespace Game
             ImGui::Begin("Player Info");
 
             // Display the number of players
-            int playerCount = static_cast<int>(spaceShips.size());
+            int playerCount = static_cast<int>(this->server.spaceShips.Size());
             ImGui::Text("Number of players: %d", playerCount);
 
+            // Display the simulation clock
+            ImGui::Text("Tick: %llu @ %d Hz", (unsigned long long)this->server.scheduler.tick, this->server.scheduler.GetTickRate());
+            ImGui::Text("Overruns: %llu, skipped ticks: %llu", (unsigned long long)this->server.scheduler.overruns, (unsigned long long)this->server.scheduler.droppedTicks);
+            uint64_t const ticks = std::max<uint64_t>(1, this->server.currentTick);
+            ImGui::Text("Allocations per tick: %.1f, ENet: %.1f", (double)this->server.tickAllocs.allocations / ticks, (double)this->server.tickAllocs.enetAllocations / ticks);
+
             ImGui::Separator();
 
             // Assuming `peers` is a container storing active ENetPeer connections
             ImGui::Text("Peers:");
 
-            for (const ENetPeer* peer : peers) // Assuming `peers` holds `ENetPeer*` pointers
+            for (const ENetPeer* peer : this->server.peers) // Assuming `peers` holds `ENetPeer*` pointers
             {
                 // Print peer address and port
                 ImGui::Text("Peer: %u.%u.%u.%u:%u",
@@ -377,7 +167,7 @@ namespace Game
             ImGui::Separator();
 
             // Loop through each spaceship and display UUID, position, and peer details
-            for (const SpaceShip& ship : spaceShips)
+            for (const SpaceShip& ship : this->server.spaceShips)
             {
                 // Display ship's UUID (assuming it's an unsigned int)
                 ImGui::Text("Ship ID: %u", ship.uuid);
@@ -415,161 +205,27 @@ namespace Game
 
     //------------------------------------------------------------------------------
 
-    void SpaceGameApp::SpawnSpaceShip(uint32_t uuid, ENetPeer* peer) {
-        //Create a new SpaceShip instance
-        SpaceShip ship;
-        ship.uuid = uuid;
-        ship.peer = peer;
-        ship.Teleport();
-        // Create a new player object for network synchronization
-        ship.player = Protocol::Player(
-            uuid,                                                                                           // Unique player ID
-            Protocol::Vec3(ship.position[0], ship.position[1], ship.position[2]),                           // Initial position (x, y, z)
-            Protocol::Vec3(0, 0, 0),                                                                        // Initial velocity (x, y, z)
-            Protocol::Vec3(0, 0, 0),                                                                        // Initial acceleration (x, y, z)
-            Protocol::Vec4(ship.orientation.x, ship.orientation.y, ship.orientation.z, ship.orientation.w)  // Initial rotation (quaternion x, y, z, w)
-        );
-        SpaceGameApp::spaceShips.push_back(ship);
-        // Send a message to all connected peers, informing them of the new player's spawn+
-        SendSpawnPlayerS2C(&ship.player, SpaceGameApp::peers);
-        // Add the peer to the list of connected peers in the game
-        SpaceGameApp::peers.push_back(peer);
-    }
+    //------------------------------------------------------------------------------
 
-    //<ENet functions>
-    void SpaceGameApp::ProcessReceivedPacket(const void* data, size_t dataLength, ENetPeer* sender)
+    void SpaceGameApp::DrawDebug()
     {
-        // Ensure the data length is valid
-        if (dataLength < sizeof(uint16_t)) {
-            printf("Received packet is too short.\n");
-            return;
-        }
-
-        // Create a FlatBuffers buffer from the received data
-        auto packetWrapper = Protocol::GetPacketWrapper(data);
-
-        // Check the type of packet received
-        switch (packetWrapper->packet_type())
+        for (const SpaceShip& ship : this->server.spaceShips)
         {
-            case Protocol::PacketType_InputC2S:
+            // debug draw collision rays
+            glm::mat4 rotation = (glm::mat4)ship.orientation;
+            for (int i = 0; i < 8; i++)
             {
-                // Deserialize InputC2S packet
-                const auto inputPacket = packetWrapper->packet_as_InputC2S();
-                if (inputPacket)
-                {
-                    for (auto& ship : spaceShips) {
-                        if (ship.peer == sender) {
-                            ship.bitmap = inputPacket->bitmap();
-                        }
-                    }
-                }
-                break;
+                glm::vec3 dir = rotation * glm::vec4(glm::normalize(ship.colliderEndPoints[i]), 0.0f);
+                float len = glm::length(ship.colliderEndPoints[i]);
+                Debug::DrawLine(ship.position, ship.position + dir * len, 1.0f, glm::vec4(0, 1, 0, 1), glm::vec4(0, 1, 0, 1), Debug::RenderMode::AlwaysOnTop);
             }
-            default:
-                printf("Received unknown packet type.\n");
-                break;
         }
-    }
-
-    void SpaceGameApp::SendClientConnectS2C(uint16_t uuid, ENetPeer* peer) {
-        flatbuffers::FlatBufferBuilder builder;
-        auto idPacket = Protocol::CreateClientConnectS2C(builder, uuid, chrono::duration_cast<chrono::milliseconds>(chrono::system_clock::now().time_since_epoch()).count());
-        auto packetWrapper = Protocol::CreatePacketWrapper(builder, Protocol::PacketType_ClientConnectS2C, idPacket.Union());
-
-        builder.Finish(packetWrapper);
-        ENetPacket* packet = enet_packet_create(builder.GetBufferPointer(), builder.GetSize(), ENET_PACKET_FLAG_UNRELIABLE_FRAGMENT);
-        enet_peer_send(peer, 0, packet);
-    }
-
-    void SpaceGameApp::SendGameStateS2C(std::vector<SpaceShip>& spaceShips, std::vector<Laser>& lasers, ENetPeer* peer) {
-        flatbuffers::FlatBufferBuilder builder(1024);
-
-        std::vector<Protocol::Player> p;
-        std::vector<Protocol::Laser> l;
 
-        for (auto& spaceShip : spaceShips) {
-            Protocol::Player player = spaceShip.player;
-            p.push_back(player);
-        }
-        for (auto& laser : lasers) {
-            //l.push_back();
+        for (const Laser& laser : this->server.lasers)
+        {
+            glm::vec3 forward = laser.direction * glm::vec3(0, 0, 1);
+            Debug::DrawLine(laser.position - forward * 0.5f, laser.position + forward * 0.5f, 1.0f, glm::vec4(0, 1, 0, 1), glm::vec4(0, 1, 0, 1), Debug::RenderMode::AlwaysOnTop);
         }
-
-        auto playersVec = builder.CreateVectorOfStructs(p.data(), p.size());
-        auto lasersVec = builder.CreateVectorOfStructs(l.data(), l.size());
-
-        auto gameState = Protocol::CreateGameStateS2C(builder, playersVec, lasersVec);
-        auto packetWrapper = Protocol::CreatePacketWrapper(builder, Protocol::PacketType_GameStateS2C, gameState.Union());
-
-        builder.Finish(packetWrapper);
-
-        ENetPacket* enetPacket = enet_packet_create(builder.GetBufferPointer(), builder.GetSize(), ENET_PACKET_FLAG_RELIABLE);
-        enet_peer_send(peer, 0, enetPacket);
-    }
-
-    void SpaceGameApp::SendSpawnPlayerS2C(Protocol::Player* player, vector<ENetPeer*> peers) {
-        flatbuffers::FlatBufferBuilder builder;
-        auto telPacket = Protocol::CreateSpawnPlayerS2C(builder, player);
-        auto packetWrapper = Protocol::CreatePacketWrapper(builder, Protocol::PacketType_SpawnPlayerS2C, telPacket.Union());
-        builder.Finish(packetWrapper);
-        ENetPacket* packet = enet_packet_create(builder.GetBufferPointer(), builder.GetSize(), ENET_PACKET_FLAG_UNRELIABLE_FRAGMENT);
-        for (ENetPeer* peer : peers)
-            enet_peer_send(peer, 0, packet);
-    }
-
-    void SpaceGameApp::SendDespawnPlayerS2C(uint32_t uuid, vector<ENetPeer*> peers) {
-        flatbuffers::FlatBufferBuilder builder;
-        auto telPacket = Protocol::CreateDespawnPlayerS2C(builder, uuid);
-        auto packetWrapper = Protocol::CreatePacketWrapper(builder, Protocol::PacketType_DespawnPlayerS2C, telPacket.Union());
-
-        builder.Finish(packetWrapper);
-        ENetPacket* packet = enet_packet_create(builder.GetBufferPointer(), builder.GetSize(), ENET_PACKET_FLAG_UNRELIABLE_FRAGMENT);
-        for (ENetPeer* peer : peers)
-            enet_peer_send(peer, 0, packet);
-    }
-
-    void SpaceGameApp::SendUpdatePlayerS2C(const Protocol::Player* player, uint64_t time, vector<ENetPeer*> peers) {
-        flatbuffers::FlatBufferBuilder builder;
-        auto telPacket = Protocol::CreateUpdatePlayerS2C(builder, time, player);
-        auto packetWrapper = Protocol::CreatePacketWrapper(builder, Protocol::PacketType_UpdatePlayerS2C, telPacket.Union());
-
-        builder.Finish(packetWrapper);
-        ENetPacket* packet = enet_packet_create(builder.GetBufferPointer(), builder.GetSize(), ENET_PACKET_FLAG_UNRELIABLE_FRAGMENT);
-        for (ENetPeer* peer : peers)
-            enet_peer_send(peer, 0, packet);
-    }
-
-    void SpaceGameApp::SendTeleportPlayerS2C(const Protocol::Player* player, uint64_t time, vector<ENetPeer*> peers) {
-        flatbuffers::FlatBufferBuilder builder;
-        auto telPacket = Protocol::CreateTeleportPlayerS2C(builder, time, player);
-        auto packetWrapper = Protocol::CreatePacketWrapper(builder, Protocol::PacketType_TeleportPlayerS2C, telPacket.Union());
-
-        builder.Finish(packetWrapper);
-        ENetPacket* packet = enet_packet_create(builder.GetBufferPointer(), builder.GetSize(), ENET_PACKET_FLAG_UNRELIABLE_FRAGMENT);
-        for (ENetPeer* peer : peers)
-            enet_peer_send(peer, 0, packet);
-    }
-
-    void SpaceGameApp::SendSpawnLaserS2C(const Protocol::Laser* laser, vector<ENetPeer*> peers) {
-        flatbuffers::FlatBufferBuilder builder;
-        auto telPacket = Protocol::CreateSpawnLaserS2C(builder, laser);
-        auto packetWrapper = Protocol::CreatePacketWrapper(builder, Protocol::PacketType_SpawnLaserS2C, telPacket.Union());
-
-        builder.Finish(packetWrapper);
-        ENetPacket* packet = enet_packet_create(builder.GetBufferPointer(), builder.GetSize(), ENET_PACKET_FLAG_UNRELIABLE_FRAGMENT);
-        for (ENetPeer* peer : peers)
-            enet_peer_send(peer, 0, packet);
-    }
-
-    void SpaceGameApp::SendDespawnLaserS2C(uint32_t uuid, vector<ENetPeer*> peers) {
-        flatbuffers::FlatBufferBuilder builder;
-        auto telPacket = Protocol::CreateDespawnLaserS2C(builder, uuid);
-        auto packetWrapper = Protocol::CreatePacketWrapper(builder, Protocol::PacketType_DespawnLaserS2C, telPacket.Union());
-
-        builder.Finish(packetWrapper);
-        ENetPacket* packet = enet_packet_create(builder.GetBufferPointer(), builder.GetSize(), ENET_PACKET_FLAG_UNRELIABLE_FRAGMENT);
-        for(ENetPeer* peer : peers)
-            enet_peer_send(peer, 0, packet);
     }
 
 } // namespace Game
\ No newline at end of file
@@ -8,9 +8,7 @@
 //------------------------------------------------------------------------------
 #include "core/app.h"
 #include "render/window.h"
-#include "spaceship.h"
-#include "enet/enet.h"
-#include <proto.h>
+#include "gameserver.h"
 
 namespace Game
 {
@@ -31,25 +29,11 @@ public:
 private:
 	/// show some ui things
 	void RenderUI();
-	void ProcessReceivedPacket(const void* data, size_t dataLength , ENetPeer* sender);
-	void SpawnSpaceShip(uint32_t uuid, ENetPeer* peer);
-
-	void SendClientConnectS2C(uint16_t uuid, ENetPeer* peer);
-	void SendGameStateS2C(std::vector<SpaceShip>& spaceShips, std::vector<Laser>& lasers, ENetPeer* peer);
-	void SendSpawnPlayerS2C(Protocol::Player* player, std::vector<ENetPeer*> peers);
-	void SendDespawnPlayerS2C(uint32_t uuid, std::vector<ENetPeer*> peers);
-	void SendUpdatePlayerS2C(const Protocol::Player* player, uint64_t time, std::vector<ENetPeer*> peers);
-	void SendTeleportPlayerS2C(const Protocol::Player* player, uint64_t time, std::vector<ENetPeer*> peers);
-	void SendSpawnLaserS2C(const Protocol::Laser* laser, std::vector<ENetPeer*> peers);
-	void SendDespawnLaserS2C(uint32_t uuid, std::vector<ENetPeer*> peers);
+	/// draw collision rays and lasers of the simulation
+	void DrawDebug();
 
 	Display::Window* window;
-
-	std::vector<ENetPeer*> peers = {};
-	std::vector<SpaceShip> spaceShips = {};
-	std::vector<Laser> lasers = {};
+	GameServer server;
 };
 
-static unsigned int uuid = 0;
-
 } // namespace Game
\ No newline at end of file
@@ -1,17 +1,12 @@
 #pragma once
-#include "render/model.h"
 #include <iostream>
 #include <chrono>
+#include <vector>
 #include "render/physics.h"
-#include "render/debugrender.h"
+#include "net/shipmovement.h"
 #include "enet/enet.h"
 #include <proto.h>
 
-namespace Render
-{
-    struct ParticleEmitter;
-}
-
 namespace Game
 {
 
@@ -23,13 +18,15 @@ namespace Game
         }
 
         uint32_t uuid;	        // Unique universal identifier of the laser.
-        uint64_t start_time;	// The UNIX time in ms when the laser was created.
-        uint64_t end_time;	    // The UNIX time in ms when the laser should die.
+        uint64_t start_time;	// The server time in ms when the laser was created.
+        uint64_t end_time;	    // The server time in ms when the laser should die.
         glm::vec3 position;		// the position of the laser.
         glm::quat direction;	// The quaternion direction of the laser.
 
         glm::mat4 transform = glm::mat4(1);
         float Speed = 10.0f;
+        static constexpr float halfLength = 0.5f;    // Half the length of the laser segment.
+        uint32_t viewDelay = 0;     // How far in ms the shooter's view lagged the server, hits are tested against ships that long ago.
         bool marked_for_deletion = false;
 
         /*void Update(float dt)
@@ -57,7 +54,7 @@ namespace Game
             return payload.hit;
         }*/
 
-        void Update(float dt)
+        void Update(float dt, uint64_t current_time)
         {
             // Get the forward vector (Z-axis) from the quaternion direction
             glm::vec3 forward = direction * glm::vec3(0, 0, 1);
@@ -66,13 +63,9 @@ namespace Game
             // Update the transformation matrix with the new position and direction
             transform = glm::translate(glm::mat4(1.0f), position) * glm::mat4_cast(direction);
 
-            uint64_t current_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
             if (current_time >= end_time) {
                 marked_for_deletion = true;
             }
-
-            // Debug draw collision rays using the forward vector from the quaternion
-            Debug::DrawLine(position - forward * 0.5f, position + forward * 0.5f, 1.0f, glm::vec4(0, 1, 0, 1), glm::vec4(0, 1, 0, 1), Debug::RenderMode::AlwaysOnTop);
         }
 
         bool CheckCollisions()
@@ -90,44 +83,17 @@ namespace Game
         }
     };
 
-    struct SpaceShip
+    // Movement state and constants are in Net::ShipMovement, shared with the client's prediction
+    struct SpaceShip : Net::ShipMovement
     {
         SpaceShip() = default;
         ~SpaceShip() = default;
-        SpaceShip& operator=(const SpaceShip& other) {
-            if (this != &other) {
-                position = other.position;
-                orientation = other.orientation;
-                camPos = other.camPos;
-                transform = other.transform;
-                linearVelocity = other.linearVelocity;
-                currentSpeed = other.currentSpeed;
-                // Copy other relevant fields as needed
-                uuid = other.uuid;
-                peer = other.peer; // Consider how you want to manage peer ownership
-                player = other.player; // Assuming Protocol::Player has a proper copy assignment operator
-            }
-            return *this;
-        }
 
-        glm::vec3 position = glm::vec3(0);
-        glm::quat orientation = glm::identity<glm::quat>();
         glm::vec3 camPos = glm::vec3(0, 1.0f, -2.0f);
-        glm::mat4 transform = glm::mat4(1);
-        glm::vec3 linearVelocity = glm::vec3(0);
-
-        const float normalSpeed = 1.0f;
-        const float boostSpeed = normalSpeed * 2.0f;
-        const float accelerationFactor = 1.0f;
-        const float camOffsetY = 1.0f;
-        const float cameraSmoothFactor = 10.0f;
-
-        float currentSpeed = 0.0f;
 
-        float rotationZ = 0;
-        float rotXSmooth = 0;
-        float rotYSmooth = 0;
-        float rotZSmooth = 0;
+        static constexpr float camOffsetY = 1.0f;
+        static constexpr float cameraSmoothFactor = 10.0f;
+        static constexpr float maxSpeed = boostSpeed * velocityScale;  // Units per second.
 
         uint64_t lastFireTime = 0;  // Stores the time of the last fired shot
         float fireRate = 200.0f;    // Fire rate in milliseconds (e.g., 200 ms between shots)
@@ -141,13 +107,16 @@ namespace Game
 
         void Update(float dt);
 
-        bool CheckCollisions(std::vector<Laser>& lasers, std::vector<SpaceShip>& ships);
+        // Narrowphase, candidate pairs come from GameServer's broadphase
+        bool CheckRockCollisions() const;
+        bool Intersects(const Laser& laser, const glm::vec3& center) const;
+        bool Intersects(const SpaceShip& ship) const;
 
         void Teleport();
 
         glm::vec3 SpawnInRandomPosition(float radius);
 
-        const glm::vec3 colliderEndPoints[8] = {
+        static inline const glm::vec3 colliderEndPoints[8] = {
             glm::vec3(-1.10657, -0.480347, -0.346542),  // right wing
             glm::vec3(1.10657, -0.480347, -0.346542),  // left wing
             glm::vec3(-0.342382, 0.25109, -0.010299),   // right top
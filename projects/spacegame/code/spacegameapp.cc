@@ -18,12 +18,15 @@
 #include "core/random.h"
 #include "render/input/inputserver.h"
 #include "core/cvar.h"
+#include "net/packetpool.h"
+#include "net/compressor.h"
 #include "render/physics.h"
 #include <chrono>
 #include "spaceship.h"
 #include <vector>
 #include <proto.h>
 #include <iostream>
+#include <algorithm>
 
 using namespace Display;
 using namespace Render;
@@ -35,7 +38,17 @@ namespace Game
 
     //------------------------------------------------------------------------------
     
-    SpaceGameApp::SpaceGameApp(){ }
+    SpaceGameApp::SpaceGameApp()
+    {
+        this->prediction = Core::CVarCreate(Core::CVar_Int, "cl_prediction", "1", "Predict our own ship from local inputs instead of waiting for the server");
+        this->predictionSmoothing = Core::CVarCreate(Core::CVar_Float, "cl_prediction_smoothing", "10", "Rate per second at which prediction errors are blended out, 0 snaps");
+        this->interpolationDelay = Core::CVarCreate(Core::CVar_Int, "cl_interp", "50", "Minimum delay in ms remote ships are shown behind the server, to interpolate between snapshots");
+        this->interpolationAdaptive = Core::CVarCreate(Core::CVar_Int, "cl_interp_adaptive", "1", "Raise the interpolation delay by twice the measured snapshot jitter");
+        this->compression = Core::CVarCreate(Core::CVar_Int, "cl_compress", "2", "Compress datagrams like sv_compress, 0 off, 1 ENet's range coder, 2 the model trained on game traffic");
+        this->useNetThread = Core::CVarCreate(Core::CVar_Int, "cl_net_thread", "0", "Service the connection on its own thread, exchanging packets with the game through lock-free queues");
+        // Conditions what the client receives, the server to client direction
+        Net::CreateConditionerCVars("cl_netsim_");
+    }
 
     //------------------------------------------------------------------------------
     
@@ -187,25 +200,47 @@ namespace Game
         double dt = 0.01667f;
 
         //ENet setup
-        if (enet_initialize() != 0)
+        if (!Net::InitializeENet())
         {
             fprintf(stderr, "An error Occured while initializing ENet!\n");
         }
 
-        atexit(enet_deinitialize);
-
-        client = enet_host_create(NULL, 1, 1, 0, 0);
+        client = enet_host_create(NULL, 1, Net::ChannelCount, 0, 0);
 
         if (client == NULL)
         {
             fprintf(stderr, "An error occurred while trying to create ENet client!\n");
         }
+        else
+        {
+            if (!Net::PacketCompressor::Attach(client, Net::PacketCompressor::MethodFromInt(Core::CVarReadInt(this->compression))))
+                fprintf(stderr, "Could not create the packet compressor, sending datagrams uncompressed.\n");
+            if (!this->conditioner.Attach(client, Net::ReadConditionerCVars("cl_netsim_")))
+                fprintf(stderr, "Could not start the network conditioner, running without.\n");
+        }
 
         // game loop
         while (this->window->IsOpen())
         {
             /// <Event>
-            while (enet_host_service(client, &event, 0) > 0)
+            if (this->netThread.Running())
+            {
+                Net::NetEvent netEvent;
+                while (this->netThread.Poll(netEvent))
+                {
+                    if (netEvent.type == ENET_EVENT_TYPE_RECEIVE)
+                    {
+                        ProcessReceivedPacket(netEvent.packet->data, netEvent.packet->dataLength);
+                        enet_packet_destroy(netEvent.packet);
+                    }
+                    else if (netEvent.type == ENET_EVENT_TYPE_DISCONNECT)
+                    {
+                        // The server dropped us, the host is serviced here again
+                        StopNetThread();
+                    }
+                }
+            }
+            while (!this->netThread.Running() && this->conditioner.Service(client, &event, 0) > 0)
             {
                 switch (event.type)
                 {
@@ -217,6 +252,7 @@ namespace Game
                         event.peer->address.port,
                         event.channelID);*/
                         ProcessReceivedPacket(event.packet->data, event.packet->dataLength);
+                        enet_packet_destroy(event.packet);
                         break;
                 }
             }
@@ -235,9 +271,17 @@ namespace Game
                 ShaderResource::ReloadShaders();
             }
 
-            if (peer && peer->state == ENET_PEER_STATE_CONNECTED)
+            uint64_t const localTime = Net::LocalTime();
+            uint64_t const serverTime = this->clock.ServerTime(localTime);
+            this->interpolation.minDelay = (double)std::max(0, Core::CVarReadInt(this->interpolationDelay));
+            this->interpolation.adaptive = Core::CVarReadInt(this->interpolationAdaptive) != 0;
+            double const renderTime = this->interpolation.Advance((float)dt, serverTime);
+            if (Connected())
             {
-                SendInputToServer(kbd, duration_cast<chrono::milliseconds>(chrono::system_clock::now().time_since_epoch()).count());
+                if (this->clock.RequestDue(localTime))
+                    SendClockSyncC2S(localTime);
+                SendInputToServer(kbd, serverTime, (uint64_t)renderTime, (float)dt);
+                UpdatePrediction((float)dt);
             }
 
             // Draw some debug text
@@ -250,8 +294,8 @@ namespace Game
             }
 
             // Update and draw all lasers
-            for (int i = 0; i < SpaceGameApp::lasers.size(); i++) {
-                SpaceGameApp::lasers[i].Update(dt);
+            for (size_t i = SpaceGameApp::lasers.Size(); i-- > 0;) {
+                SpaceGameApp::lasers[i].Update(dt, (uint64_t)renderTime);
                 if (SpaceGameApp::lasers[i].marked_for_deletion)
                 {
                     /*printf("Server Laser marked for deletion: UUID: %u Position: (%f, %f, %f)\n",
@@ -259,7 +303,7 @@ namespace Game
                         lasers[i].position.x,
                         lasers[i].position.y,
                         lasers[i].position.z);*/
-                    lasers.erase(lasers.begin() + i);
+                    lasers.RemoveAt(i);
                 }
                 else
                     RenderDevice::Draw(laserModel, SpaceGameApp::lasers[i].transform);
@@ -269,7 +313,7 @@ namespace Game
             for (SpaceShip& ship : SpaceGameApp::spaceShips)
             {
                 //Update here
-                ship.Update(dt, SpaceGameApp::playerID);
+                ship.Update(dt, SpaceGameApp::playerID, renderTime);
                 RenderDevice::Draw(shipModel, ship.transform);
             }
 
@@ -287,9 +331,10 @@ namespace Game
         }
 
         //Disconnect
+        StopNetThread();
         if (peer != nullptr && peer->state == ENET_PEER_STATE_CONNECTED) {
             enet_peer_disconnect(peer, 0);
-            while (enet_host_service(client, &event, 3000) > 0)
+            while (this->conditioner.Service(client, &event, 3000) > 0)
             {
                 switch (event.type)
                 {
@@ -331,7 +376,7 @@ namespace Game
             if (ImGui::Button("Connect"))
             {
                 // Check if the peer is already connected
-                if (peer && peer->state == ENET_PEER_STATE_CONNECTED)
+                if (Connected())
                 {
                     puts("Already connected to the server.");
                 }
@@ -341,16 +386,18 @@ namespace Game
                     enet_address_set_host(&address, ip);
                     address.port = port;
 
-                    peer = enet_host_connect(client, &address, 1, 0);
+                    peer = enet_host_connect(client, &address, Net::ChannelCount, 0);
                     if (peer == NULL)
                     {
                         fprintf(stderr, "No available peers for initiating an ENEt connection! \n");
                     }
 
                     //Check if server has contacted us
-                    if (enet_host_service(client, &event, 5000) > 0 && event.type == ENET_EVENT_TYPE_CONNECT)
+                    if (this->conditioner.Service(client, &event, 5000) > 0 && event.type == ENET_EVENT_TYPE_CONNECT)
                     {
                         puts("Connection successful");
+                        if (Core::CVarReadInt(this->useNetThread) != 0)
+                            this->netThread.Start(client, &this->conditioner);
                     }
                     else
                     {
@@ -360,14 +407,25 @@ namespace Game
                 }
             }
             ImGui::SameLine();
-            if (ImGui::Button("Disconnect") && peer != nullptr && peer->state == ENET_PEER_STATE_CONNECTED)
+            if (ImGui::Button("Disconnect") && Connected())
             {
+                StopNetThread();
                 Render::ParticleSystem::Instance()->ClearEmitters();
-                SpaceGameApp::spaceShips.clear();
-                SpaceGameApp::lasers.clear();
+                SpaceGameApp::spaceShips.Clear();
+                SpaceGameApp::lasers.Clear();
                 playerID = -1;
+                lastSnapshotTick = 0;
+                gameStateReceived = false;
+                earlyEvents.clear();
+                snapshots.Clear();
+                inputSender.Reset();
+                clock.Reset();
+                interpolation.Reset();
+                inputAccumulator = 0;
+                pendingInputs.clear();
+                predicting = false;
                 enet_peer_disconnect(peer, 0);
-                while (enet_host_service(client, &event, 100) > 0)
+                while (this->conditioner.Service(client, &event, 100) > 0)
                 {
                     switch (event.type)
                     {
@@ -387,12 +445,19 @@ namespace Game
 
             // Display assigned player ID
             ImGui::Text("Assigned id: %d", playerID);
+            ImGui::Text("Clock offset: %lld ms, round trip: %u ms", (long long)clock.Offset(), clock.RoundTripTime());
+            ImGui::Text("Interpolation delay: %.0f ms, jitter: %.1f ms", interpolation.Delay(), interpolation.Jitter());
+            if (conditioner.Attached())
+            {
+                Net::Conditioner::Stats const conditioned = conditioner.GetStats();
+                ImGui::Text("Conditioner: %llu of %llu dropped, %u queued", (unsigned long long)(conditioned.dropped + conditioned.overflowed), (unsigned long long)conditioned.received, conditioned.queued);
+            }
 
             // Add a divider
             ImGui::Separator();
 
             // Display the number of players
-            int playerCount = static_cast<int>(spaceShips.size());
+            int playerCount = static_cast<int>(spaceShips.Size());
             ImGui::Text("Number of players: %d", playerCount);
 
             // Add another divider before the list of ships
@@ -419,7 +484,7 @@ namespace Game
         }
     }
 
-    void SpaceGameApp::SendInputToServer(Input::Keyboard* kbd, uint64_t currentTime) {
+    void SpaceGameApp::SendInputToServer(Input::Keyboard* kbd, uint64_t currentTime, uint64_t renderTime, float dt) {
         uint16_t bitmap = 0;
         // Iterate over the keys to build the bitmap of pressed keys
         if (kbd->held[Input::Key::W]){
@@ -450,13 +515,176 @@ namespace Game
             bitmap |= (1 << 8);
         }
 
+        // The server applies one input per tick, so they are sampled at its tick rate. A long frame catches up a few ticks at most.
+        this->inputAccumulator = std::min(this->inputAccumulator + dt, this->tickDelta * 4);
+        while (this->inputAccumulator >= this->tickDelta)
+        {
+            this->inputAccumulator -= this->tickDelta;
+
+            // Unchanged inputs are only sent as a heartbeat, the server assumes the ones in between
+            if (this->inputSender.Sample(bitmap))
+            {
+                flatbuffers::FlatBufferBuilder builder;
+                auto previous = builder.CreateVector(this->inputSender.Previous(), this->inputSender.PreviousCount());
+                auto inputPacket = Protocol::CreateInputC2S(builder, currentTime, bitmap, this->lastSnapshotTick, this->inputSender.Sequence(), previous, renderTime);
+                auto packetWrapper = Protocol::CreatePacketWrapper(builder, Protocol::PacketType_InputC2S, inputPacket.Union());
+
+                builder.Finish(packetWrapper);
+                ENetPacket* packet = enet_packet_create(builder.GetBufferPointer(), builder.GetSize(), ENET_PACKET_FLAG_UNRELIABLE_FRAGMENT);
+                this->netThread.Send(peer, (uint8_t)Net::Channel::State, packet);
+            }
+
+            if (this->predicting)
+            {
+                Net::StepShip(this->predicted, bitmap, this->tickDelta);
+                this->pendingInputs.push_back({ this->inputSender.Sequence(), bitmap, this->predicted });
+                // Only happens when the server stops answering, the oldest inputs can no longer be acknowledged
+                if (this->pendingInputs.size() > MaxPendingInputs)
+                    this->pendingInputs.erase(this->pendingInputs.begin());
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+        Flushed right away, a request waiting for the next service would make
+        the outgoing leg look longer and skew the estimate.
+    */
+    void SpaceGameApp::SendClockSyncC2S(uint64_t localTime) {
         flatbuffers::FlatBufferBuilder builder;
-        auto inputPacket = Protocol::CreateInputC2S(builder, currentTime, bitmap);
-        auto packetWrapper = Protocol::CreatePacketWrapper(builder, Protocol::PacketType_InputC2S, inputPacket.Union());
+        auto syncPacket = Protocol::CreateClockSyncC2S(builder, localTime);
+        auto packetWrapper = Protocol::CreatePacketWrapper(builder, Protocol::PacketType_ClockSyncC2S, syncPacket.Union());
 
         builder.Finish(packetWrapper);
-        ENetPacket* packet = enet_packet_create(builder.GetBufferPointer(), builder.GetSize(), ENET_PACKET_FLAG_UNRELIABLE_FRAGMENT);
-        enet_peer_send(peer, 0, packet);
+        ENetPacket* packet = enet_packet_create(builder.GetBufferPointer(), builder.GetSize(), 0);
+        this->netThread.Send(peer, (uint8_t)Net::Channel::State, packet);
+        if (this->netThread.Running())
+            this->netThread.Flush();
+        else
+            enet_host_flush(client);
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+        The network thread only runs while connected and stops when the server
+        disconnects us, so it running means the connection is up.
+    */
+    bool SpaceGameApp::Connected() const
+    {
+        return this->netThread.Running() || (this->peer != nullptr && this->peer->state == ENET_PEER_STATE_CONNECTED);
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+        Hands the host back to this thread, packets it had not delivered yet are
+        dropped.
+    */
+    void SpaceGameApp::StopNetThread()
+    {
+        this->netThread.Stop();
+        Net::NetEvent event;
+        while (this->netThread.Poll(event))
+        {
+            if (event.packet != nullptr)
+                enet_packet_destroy(event.packet);
+        }
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+        Show our ship at its predicted pose, plus what is left of the errors of
+        earlier predictions.
+    */
+    void SpaceGameApp::UpdatePrediction(float dt)
+    {
+        SpaceShip* ship = spaceShips.Find(this->playerID);
+        bool const enabled = Core::CVarReadInt(this->prediction) != 0;
+        if (ship == nullptr || !enabled)
+        {
+            if (ship != nullptr)
+                ship->predicted = false;
+            this->predicting = false;
+            this->pendingInputs.clear();
+            return;
+        }
+
+        // Start from the last state the server sent, the next snapshot reconciles it
+        if (!this->predicting)
+        {
+            const Net::InterpolationBuffer::State* newest = ship->states.Newest();
+            glm::vec3 const position = (newest != nullptr) ? newest->position : ship->position;
+            glm::quat const orientation = (newest != nullptr) ? newest->orientation : ship->orientation;
+            static_cast<Net::ShipMovement&>(*ship) = Net::ShipMovement();
+            ship->position = position;
+            ship->orientation = orientation;
+            if (newest != nullptr)
+                ship->linearVelocity = newest->velocity / Net::ShipMovement::velocityScale;
+            ship->transform = glm::translate(ship->position) * (glm::mat4)ship->orientation;
+            this->predicted = *ship;
+            this->correctionOffset = glm::vec3(0);
+            this->correctionRotation = glm::identity<glm::quat>();
+            this->predicting = true;
+        }
+
+        float const rate = Core::CVarReadFloat(this->predictionSmoothing);
+        float const blend = (rate > 0.0f) ? 1.0f - std::exp(-rate * dt) : 1.0f;
+        this->correctionOffset = glm::mix(this->correctionOffset, glm::vec3(0), blend);
+        this->correctionRotation = glm::slerp(this->correctionRotation, glm::identity<glm::quat>(), blend);
+
+        static_cast<Net::ShipMovement&>(*ship) = this->predicted;
+        ship->position = this->predicted.position + this->correctionOffset;
+        ship->orientation = glm::normalize(this->correctionRotation * this->predicted.orientation);
+        glm::mat4 rotation = this->predicted.transform;
+        rotation[3] = glm::vec4(0, 0, 0, 1);
+        ship->transform = glm::translate(ship->position) * (glm::mat4)this->correctionRotation * rotation;
+        ship->predicted = true;
+    }
+
+    //------------------------------------------------------------------------------
+    /**
+        Rewind to the server's state of our ship after input ack and replay the
+        inputs it has not applied yet. The snapshot only carries the replicated
+        state, the smoothing state comes from our own prediction of ack, which
+        ran the same inputs. The difference to the old prediction is blended out
+        by UpdatePrediction, large ones like teleports are applied at once.
+    */
+    void SpaceGameApp::Reconcile(const Net::PlayerState& server, uint32_t ack)
+    {
+        Net::ShipMovement state = this->predicted;
+        auto acked = std::find_if(this->pendingInputs.begin(), this->pendingInputs.end(), [ack](const PredictedInput& input) {
+            return input.sequence == ack;
+        });
+        if (acked != this->pendingInputs.end())
+            state = acked->state;
+        this->pendingInputs.erase(std::remove_if(this->pendingInputs.begin(), this->pendingInputs.end(), [ack](const PredictedInput& input) {
+            return input.sequence <= ack;
+        }), this->pendingInputs.end());
+
+        // Keep the roll StepShip put into the transform
+        glm::quat const roll = glm::inverse(state.orientation) * glm::quat_cast(glm::mat3(state.transform));
+        state.position = server.position;
+        state.orientation = server.direction;
+        state.linearVelocity = server.velocity;
+        state.transform = glm::translate(state.position) * (glm::mat4)(state.orientation * roll);
+
+        for (PredictedInput& input : this->pendingInputs)
+        {
+            Net::StepShip(state, input.bitmap, this->tickDelta);
+            input.state = state;
+        }
+
+        glm::vec3 const error = this->correctionOffset + this->predicted.position - state.position;
+        if (glm::length(error) > MaxCorrectionDistance)
+        {
+            this->correctionOffset = glm::vec3(0);
+            this->correctionRotation = glm::identity<glm::quat>();
+        }
+        else
+        {
+            this->correctionOffset = error;
+            this->correctionRotation = glm::normalize(this->correctionRotation * this->predicted.orientation * glm::inverse(state.orientation));
+        }
+        this->predicted = state;
     }
 
     void SpaceGameApp::ProcessReceivedPacket(const void* data, size_t dataLength)
@@ -481,6 +709,10 @@ namespace Game
                 {
                     printf("id recived: %u\n", packet->uuid());
                     SpaceGameApp::playerID = packet->uuid();
+                    if (packet->tick_rate() > 0)
+                        this->tickDelta = (float)(1.0 / packet->tick_rate());
+                    // Off by the one way latency until the first clock sync reply
+                    this->clock.Seed(packet->time(), Net::LocalTime());
                 }
                 break;
             }
@@ -493,11 +725,14 @@ namespace Game
                     auto players = packet->players();
                     auto lasers = packet->lasers();
                     for (auto p : *players) {
+                        // The constructor registers particle emitters, so check before creating one
+                        if (SpaceGameApp::spaceShips.Contains(p->uuid()))
+                            continue;
                         const auto& position = p->position();
                         const auto& velocity = p->velocity();
                         const auto& acceleration = p->acceleration();
                         const auto& orientation = p->direction();
-                        SpaceGameApp::spaceShips.push_back(SpaceShip(
+                        SpaceGameApp::spaceShips.Insert(p->uuid(), SpaceShip(
                             p->uuid(),
                             glm::vec3(position.x(), position.y(), position.z()),
                             glm::vec3(velocity.x(), velocity.y(), velocity.z()),
@@ -505,20 +740,45 @@ namespace Game
                             glm::quat(orientation.w(), orientation.x(), orientation.y(), orientation.z())
                         ));
                     }
+
+                    this->gameStateReceived = true;
+                    for (const std::vector<uint8_t>& events : this->earlyEvents)
+                        ProcessReceivedPacket(events.data(), events.size());
+                    this->earlyEvents.clear();
+                }
+                break;
+            }
+            case Protocol::PacketType_EventsS2C:
+            {
+                // The game state comes on another channel and can be overtaken, the events happened after it
+                if (!this->gameStateReceived)
+                {
+                    const uint8_t* bytes = (const uint8_t*)data;
+                    this->earlyEvents.emplace_back(bytes, bytes + dataLength);
+                    break;
+                }
+                const auto packet = packetWrapper->packet_as_EventsS2C();
+                if (packet && packet->events())
+                {
+                    const uint8_t* event = nullptr;
+                    size_t eventLength = 0;
+                    size_t offset = 0;
+                    while (Net::EventBatch::Next(packet->events()->data(), packet->events()->size(), offset, event, eventLength))
+                        ProcessReceivedPacket(event, eventLength);
                 }
                 break;
             }
             case Protocol::PacketType_SpawnPlayerS2C:
             {
                 const auto packet = packetWrapper->packet_as_SpawnPlayerS2C();
-                if (packet)
+                if (packet && !SpaceGameApp::spaceShips.Contains(packet->player()->uuid()))
                 {
                     printf("Spawn ship with id: %u\n", packet->player()->uuid());
                     const auto& position = packet->player()->position();
                     const auto& velocity = packet->player()->velocity();
                     const auto& acceleration = packet->player()->acceleration();
                     const auto& orientation = packet->player()->direction();
-                    SpaceGameApp::spaceShips.push_back(SpaceShip(
+                    SpaceGameApp::spaceShips.Insert(packet->player()->uuid(), SpaceShip(
                         packet->player()->uuid(),
                         glm::vec3(position.x(), position.y(), position.z()),
                         glm::vec3(velocity.x(), velocity.y(), velocity.z()),
@@ -534,15 +794,11 @@ namespace Game
                 if (packet)
                 {
                     printf("despawn ship with id: %u\n", packet->uuid());
-                    auto toDespawn = packet->uuid();
-                    auto it = std::find_if(spaceShips.begin(), spaceShips.end(), [toDespawn](const SpaceShip& player) {
-                        return player.uuid == toDespawn;
-                        });
-
-                    if (it != spaceShips.end()) {
-                        Render::ParticleSystem::Instance()->RemoveEmitter(it->particleEmitterLeft);
-                        Render::ParticleSystem::Instance()->RemoveEmitter(it->particleEmitterRight);
-                        spaceShips.erase(it);
+                    SpaceShip* ship = spaceShips.Find(packet->uuid());
+                    if (ship != nullptr) {
+                        Render::ParticleSystem::Instance()->RemoveEmitter(ship->particleEmitterLeft);
+                        Render::ParticleSystem::Instance()->RemoveEmitter(ship->particleEmitterRight);
+                        spaceShips.RemoveKey(packet->uuid());
                     }
                 }
                 break;
@@ -552,26 +808,25 @@ namespace Game
                 const auto packet = packetWrapper->packet_as_UpdatePlayerS2C();
                 if (packet)
                 {
-                    const auto& time = packet->time();
-                    const auto& position = packet->player()->position();
-                    const auto& direction = packet->player()->direction();
-                    const auto& velocity = packet->player()->velocity();
-                    const auto& acceleration = packet->player()->acceleration();
-
-                    for (auto& ship : spaceShips) {
-                        if (ship.uuid == packet->player()->uuid()) {
-                            //ship.position = glm::vec3(position.x(), position.y(), position.z());
-                            //ship.orientation = glm::quat(direction.w(), direction.x(), direction.y(), direction.z());
-                            //ship.transform = translate(ship.position) * (glm::mat4)ship.orientation;
-                            ship.lastUpdateTime = time;
-                            ship.lastPosition = glm::vec3(position.x(), position.y(), position.z());
-                            ship.lastOrientation = glm::quat(direction.w(), direction.x(), direction.y(), direction.z());
-                            ship.lastVelocity = glm::vec3(velocity.x(), velocity.y(), velocity.z());
-                            ship.lastAcceleration = glm::vec3(acceleration.x(), acceleration.y(), acceleration.z());
-                            ship.timeSinceLastPacket = 0;
-                            break;
-                        }
-                    }
+                    ApplyPlayerUpdate(packet->player(), packet->time());
+                }
+                break;
+            }
+            case Protocol::PacketType_ClockSyncS2C:
+            {
+                const auto packet = packetWrapper->packet_as_ClockSyncS2C();
+                if (packet)
+                {
+                    this->clock.AddSample(packet->client_time(), packet->server_time(), Net::LocalTime());
+                }
+                break;
+            }
+            case Protocol::PacketType_SnapshotS2C:
+            {
+                const auto packet = packetWrapper->packet_as_SnapshotS2C();
+                if (packet)
+                {
+                    ApplySnapshot(packet);
                 }
                 break;
             }
@@ -584,12 +839,14 @@ namespace Game
                     const auto& direction = packet->player()->direction();
                     const auto& velocity = packet->player()->velocity();
                     const auto& acceleration = packet->player()->acceleration();
-                    for (auto& ship : spaceShips) {
-                        if (ship.uuid == packet->player()->uuid()) {
-                            ship.position = glm::vec3(position.x(), position.y(), position.z());
-                            ship.orientation = glm::quat(direction.w(), direction.x(), direction.y(), direction.z());
-                            ship.transform = translate(ship.position) * (glm::mat4)ship.orientation;
-                        }
+                    SpaceShip* ship = spaceShips.Find(packet->player()->uuid());
+                    if (ship != nullptr) {
+                        ship->position = glm::vec3(position.x(), position.y(), position.z());
+                        ship->orientation = glm::quat(direction.w(), direction.x(), direction.y(), direction.z());
+                        ship->transform = translate(ship->position) * (glm::mat4)ship->orientation;
+                        // Don't interpolate across the jump
+                        ship->states.Clear();
+                        ship->states.Add(packet->time(), ship->position, glm::vec3(velocity.x(), velocity.y(), velocity.z()) * Net::ShipMovement::velocityScale, ship->orientation);
                     }
 
                 }
@@ -598,14 +855,22 @@ namespace Game
             case Protocol::PacketType_SpawnLaserS2C:
             {
                 const auto packet = packetWrapper->packet_as_SpawnLaserS2C();
-                if (packet)
+                if (packet && packet->data())
+                {
+                    Net::LaserState laser;
+                    if (Net::ReadLaserState(packet->data()->data(), packet->data()->size(), packet->time(), laser))
+                        SpaceGameApp::lasers.Insert(laser.uuid, Laser(laser.uuid, laser.startTime, laser.endTime, laser.origin, laser.direction));
+                    else
+                        printf("Received malformed laser.\n");
+                }
+                else if (packet && packet->laser())
                 {
                     const auto& id = packet->laser()->uuid();
                     const auto& position = packet->laser()->origin();
                     const auto& direction = packet->laser()->direction();
                     const auto& startTime = packet->laser()->start_time();
                     const auto& endTime = packet->laser()->end_time();
-                    SpaceGameApp::lasers.push_back(Laser(
+                    SpaceGameApp::lasers.Insert(id, Laser(
                         id,
                         startTime,
                         endTime,
@@ -620,11 +885,7 @@ namespace Game
                 const auto packet = packetWrapper->packet_as_DespawnLaserS2C();
                 if (packet)
                 {
-                    const auto& id = packet->uuid();
-                    for (int i = 0; i < SpaceGameApp::lasers.size(); i++) {
-                        if (SpaceGameApp::lasers[i].uuid == id)
-                            SpaceGameApp::lasers.erase(SpaceGameApp::lasers.begin() + i);
-                    }
+                    SpaceGameApp::lasers.RemoveKey(packet->uuid());
                 }
                 break;
             }
@@ -634,4 +895,98 @@ namespace Game
         }
     }
 
-} // namespace Game
\ No newline at end of file
+    static Net::PlayerState ToPlayerState(const Protocol::Player& player)
+    {
+        Net::PlayerState state;
+        state.uuid = player.uuid();
+        state.position = glm::vec3(player.position().x(), player.position().y(), player.position().z());
+        state.velocity = glm::vec3(player.velocity().x(), player.velocity().y(), player.velocity().z());
+        state.acceleration = glm::vec3(player.acceleration().x(), player.acceleration().y(), player.acceleration().z());
+        state.direction = glm::quat(player.direction().w(), player.direction().x(), player.direction().y(), player.direction().z());
+        return state;
+    }
+
+    void SpaceGameApp::ApplySnapshot(const Protocol::SnapshotS2C* snapshot)
+    {
+        // Snapshots are unreliable and may arrive out of order
+        if (snapshot->tick() <= this->lastSnapshotTick)
+            return;
+
+        Net::Snapshot& decoded = this->decodedSnapshot;
+        Net::Encoding const encoding = snapshot->quantized() ? Net::Encoding::Quantized : Net::Encoding::Raw;
+        const auto delta = snapshot->delta();
+        if (delta != nullptr)
+        {
+            const Net::Snapshot* baseline = nullptr;
+            if (snapshot->baseline() != 0)
+            {
+                // Baseline got lost or fell out of the history, wait for a snapshot we can decode
+                baseline = this->snapshots.Find(snapshot->baseline());
+                if (baseline == nullptr)
+                    return;
+            }
+            if (!Net::ReadSnapshotDelta(baseline, delta->data(), delta->size(), encoding, decoded))
+            {
+                printf("Received malformed snapshot.\n");
+                return;
+            }
+        }
+        else
+        {
+            decoded.players.clear();
+            if (snapshot->players() != nullptr)
+            {
+                for (const Protocol::Player* player : *snapshot->players())
+                    decoded.players.push_back(ToPlayerState(*player));
+            }
+            std::sort(decoded.players.begin(), decoded.players.end(), [](const Net::PlayerState& a, const Net::PlayerState& b) {
+                return a.uuid < b.uuid;
+            });
+        }
+
+        // Players outside the delta stream come in full, distant ones at a low rate or all others picked by the server's priority scheduler
+        this->farPlayers.clear();
+        if (snapshot->far() != nullptr && !Net::ReadPlayerStates(snapshot->far()->data(), snapshot->far()->size(), encoding, this->farPlayers))
+        {
+            printf("Received malformed snapshot.\n");
+            return;
+        }
+
+        this->lastSnapshotTick = snapshot->tick();
+        this->interpolation.AddSnapshot(snapshot->time(), Net::LocalTime());
+        decoded.tick = snapshot->tick();
+
+        const uint64_t time = snapshot->time();
+        for (const Net::PlayerState& player : decoded.players)
+            ApplyPlayerState(player, time);
+        for (const Net::PlayerState& player : this->farPlayers)
+            ApplyPlayerState(player, time);
+
+        if (this->predicting && snapshot->input_ack() != 0)
+        {
+            auto own = std::lower_bound(decoded.players.begin(), decoded.players.end(), this->playerID, [](const Net::PlayerState& player, uint32_t uuid) {
+                return player.uuid < uuid;
+            });
+            if (own != decoded.players.end() && own->uuid == this->playerID)
+                Reconcile(*own, snapshot->input_ack());
+        }
+
+        // Keep it as a baseline, the swap hands the evicted entry's storage back to the scratch snapshot
+        Net::Snapshot& stored = this->snapshots.Store(decoded.tick);
+        std::swap(stored.players, decoded.players);
+    }
+
+    void SpaceGameApp::ApplyPlayerUpdate(const Protocol::Player* player, uint64_t time)
+    {
+        ApplyPlayerState(ToPlayerState(*player), time);
+    }
+
+    void SpaceGameApp::ApplyPlayerState(const Net::PlayerState& player, uint64_t time)
+    {
+        SpaceShip* ship = spaceShips.Find(player.uuid);
+        if (ship != nullptr) {
+            ship->states.Add(time, player.position, player.velocity * Net::ShipMovement::velocityScale, player.direction);
+        }
+    }
+
+} // namespace Game
@@ -11,6 +11,22 @@
 #include "enet/enet.h"
 #include "render/input/inputserver.h"
 #include "spaceship.h"
+#include "core/slotmap.h"
+#include "net/snapshot.h"
+#include "net/shipmovement.h"
+#include "net/inputstream.h"
+#include "net/clocksync.h"
+#include "net/interpolation.h"
+#include "net/netthread.h"
+#include "net/conditioner.h"
+#include "net/channels.h"
+#include "net/eventbatch.h"
+#include <proto.h>
+
+namespace Core
+{
+struct CVar;
+}
 
 namespace Game
 {
@@ -30,8 +46,16 @@ public:
 	void Exit();
 private:
 	void RenderUI();
-	void SendInputToServer(Input::Keyboard* kbd, uint64_t currentTime);
+	void SendInputToServer(Input::Keyboard* kbd, uint64_t currentTime, uint64_t renderTime, float dt);
+	void SendClockSyncC2S(uint64_t localTime);
+	bool Connected() const;
+	void StopNetThread();
+	void UpdatePrediction(float dt);
+	void Reconcile(const Net::PlayerState& server, uint32_t ack);
 	void ProcessReceivedPacket(const void* data, size_t dataLength);
+	void ApplySnapshot(const Protocol::SnapshotS2C* snapshot);
+	void ApplyPlayerUpdate(const Protocol::Player* player, uint64_t time);
+	void ApplyPlayerState(const Net::PlayerState& player, uint64_t time);
 
 	Display::Window* window;
 	ENetHost* client = nullptr;
@@ -40,8 +64,59 @@ private:
 	ENetPeer* peer = nullptr;
 
 	uint32_t playerID = -1;
+	/// newest snapshot applied, older ones arriving out of order are dropped
+	uint64_t lastSnapshotTick = 0;
+	/// events are held back until the game state they follow has arrived
+	bool gameStateReceived = false;
+	std::vector<std::vector<uint8_t>> earlyEvents;
+	/// received snapshots, baselines for decoding the server's deltas
+	Net::SnapshotHistory snapshots;
+	/// scratch snapshot a delta is decoded into
+	Net::Snapshot decodedSnapshot;
+	/// players outside our interest radius from the last snapshot
+	std::vector<Net::PlayerState> farPlayers;
+	/// estimate of the server clock, all S2C timestamps are in server time
+	Net::ClockSync clock;
+	/// server time remote ships and lasers are shown at
+	Net::InterpolationClock interpolation;
+	Core::CVar* interpolationDelay = nullptr;
+	Core::CVar* interpolationAdaptive = nullptr;
+	/// services client while connected if cl_net_thread is set
+	Net::NetThread netThread;
+	Core::CVar* useNetThread = nullptr;
+	Core::CVar* compression = nullptr;
+	/// simulated latency, loss and bandwidth of received datagrams, controlled by the cl_netsim_ cvars
+	Net::Conditioner conditioner;
+
+	/// keyed by uuid
+	Util::SlotMap<SpaceShip> spaceShips;
+	Util::SlotMap<Laser> lasers;
+
+	/// input sent to the server and the state our prediction reached with it
+	struct PredictedInput
+	{
+		uint32_t sequence;
+		uint16_t bitmap;
+		Net::ShipMovement state;
+	};
+	/// inputs kept for replay, about one round trip's worth
+	static constexpr size_t MaxPendingInputs = 128;
+	/// errors larger than this are teleports and not blended out
+	static constexpr float MaxCorrectionDistance = 5.0f;
 
-	std::vector<SpaceShip> spaceShips;
-	std::vector<Laser> lasers;
+	Core::CVar* prediction = nullptr;
+	Core::CVar* predictionSmoothing = nullptr;
+	/// server simulation step, inputs are sent and predicted at this rate
+	float tickDelta = 1.0f / 60.0f;
+	float inputAccumulator = 0.0f;
+	Net::InputSender inputSender;
+	/// inputs the server has not acknowledged yet, oldest first
+	std::vector<PredictedInput> pendingInputs;
+	bool predicting = false;
+	/// our ship after the newest input
+	Net::ShipMovement predicted;
+	/// remaining error of earlier predictions, added to the shown pose
+	glm::vec3 correctionOffset = glm::vec3(0);
+	glm::quat correctionRotation = glm::identity<glm::quat>();
 };
 } // namespace Game
\ No newline at end of file
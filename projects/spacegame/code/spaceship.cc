@@ -79,10 +79,8 @@ namespace Game
     
     }
 
-    void SpaceShip::Update(float dt, uint32_t id)
+    void SpaceShip::Update(float dt, uint32_t id, double renderTime)
     {
-        glm::vec3 predictedPosition = PredictPosition();
-
         if (id == uuid) {
             // Update camera view transform
             Camera* cam = CameraManager::GetCamera(CAMERA_MAIN);
@@ -91,29 +89,16 @@ namespace Game
             cam->view = lookAt(this->camPos, this->camPos + vec3(this->transform[2]), vec3(this->transform[1]));
         }
 
-        ApplyInterpolation(dt);
+        if (!this->predicted)
+            ApplyInterpolation(renderTime);
 
         UpdateThrusters(dt);
-
-        timeSinceLastPacket += dt;
-    }
-
-    glm::vec3 SpaceShip::PredictPosition() {
-        return this->lastPosition + (this->lastVelocity * timeSinceLastPacket) + (0.5f * this->lastAcceleration * timeSinceLastPacket * timeSinceLastPacket);
     }
 
-    void SpaceShip::ApplyInterpolation(float dt) {
-        // Calculate interpolation factor (alpha)
-        float alpha = timeSinceLastPacket / dt;
-        alpha = glm::clamp(alpha, 0.0f, 1.0f);
-
-        // Interpolate between last known position and predicted position
-        glm::vec3 interpolatedPosition = glm::mix(this->lastPosition, PredictPosition(), alpha);    // Seems okay at 200ms and 10% packet drop
-        this->position = interpolatedPosition;
-
-        // Interpolate between the current orientation and the last known orientation
-        glm::quat interpolatedOrientation = glm::slerp(this->orientation, this->lastOrientation, alpha);    // Seems okay at 200ms and 10% packet drop
-        this->orientation = glm::normalize(interpolatedOrientation);
+    void SpaceShip::ApplyInterpolation(double renderTime) {
+        // Between the two states around the render time, extrapolated for a short while when the next one is late
+        if (!this->states.Sample(renderTime, maxExtrapolationTime, this->position, this->orientation))
+            return;
 
         transform = glm::translate(glm::mat4(1.0f), this->position) * (glm::mat4)this->orientation;
     }
@@ -4,6 +4,8 @@
 #include <chrono>
 #include "render/physics.h"
 #include "render/debugrender.h"
+#include "net/shipmovement.h"
+#include "net/interpolation.h"
 
 namespace Render
 {
@@ -15,14 +17,15 @@ namespace Game
 
     struct Laser {
         Laser(uint32_t uuid, uint64_t start_time, uint64_t end_time, glm::vec3 pos, glm::quat direction)
-            : uuid(uuid), position(pos), direction(direction), start_time(start_time), end_time(end_time)
+            : uuid(uuid), origin(pos), position(pos), direction(direction), start_time(start_time), end_time(end_time)
         {
             transform = glm::translate(glm::mat4(1.0f), pos) * glm::mat4_cast(direction);
         }
 
         uint32_t uuid;	        // Unique universal identifier of the laser.
-        uint64_t start_time;	// The UNIX time in ms when the laser was created.
-        uint64_t end_time;	    // The UNIX time in ms when the laser should die.
+        uint64_t start_time;	// The server time in ms when the laser was created.
+        uint64_t end_time;	    // The server time in ms when the laser should die.
+        glm::vec3 origin;		// the position of the laser at start_time.
         glm::vec3 position;		// the position of the laser.
         glm::quat direction;	// The quaternion direction of the laser.
 
@@ -30,17 +33,17 @@ namespace Game
         float Speed = 10.0f;
         bool marked_for_deletion = false;
 
-        void Update(float dt)
+        void Update(float dt, uint64_t server_time)
         {
             // Get the forward vector (Z-axis) from the quaternion direction
             glm::vec3 forward = direction * glm::vec3(0, 0, 1);
-            // Move the laser in the direction it's facing
-            position += forward * Speed * dt;
+            // Place the laser where it is on the server, however late its spawn arrived
+            float age = (server_time > start_time) ? (float)(server_time - start_time) / 1000.0f : 0.0f;
+            position = origin + forward * Speed * age;
             // Update the transformation matrix with the new position and direction
             transform = glm::translate(glm::mat4(1.0f), position) * glm::mat4_cast(direction);
 
-            uint64_t current_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
-            if (current_time >= end_time) {
+            if (server_time >= end_time) {
                 marked_for_deletion = true;
             }
 
@@ -63,61 +66,21 @@ namespace Game
         }
     };
 
-    struct SpaceShip
+    // Movement state and constants are in Net::ShipMovement, shared with the server
+    struct SpaceShip : Net::ShipMovement
     {
         SpaceShip();
         SpaceShip(int32_t uuid , glm::vec3 pos, glm::vec3 vel, glm::vec3 acc, glm::quat ori);
         ~SpaceShip();
-        SpaceShip& operator=(const SpaceShip& other) {
-            if (this != &other) {
-                position = other.position;
-                orientation = other.orientation;
-                camPos = other.camPos;
-                transform = other.transform;
-                linearVelocity = other.linearVelocity;
-                currentSpeed = other.currentSpeed;
-                rotationZ = other.rotationZ;
-                rotXSmooth = other.rotXSmooth;
-                rotYSmooth = other.rotYSmooth;
-                rotZSmooth = other.rotZSmooth;
-                uuid = other.uuid;
-                // Handle particle emitters if necessary
-                // Assuming we need to copy the pointers (make sure to manage ownership correctly)
-                particleEmitterLeft = other.particleEmitterLeft;
-                particleEmitterRight = other.particleEmitterRight;
-            }
-            return *this;
-        }
 
-        glm::vec3 position = glm::vec3(0);
-        glm::quat orientation = glm::identity<glm::quat>();
         glm::vec3 camPos = glm::vec3(0, 1.0f, -2.0f);
-        glm::mat4 transform = glm::mat4(1);
-        glm::vec3 linearVelocity = glm::vec3(0);
-
-        uint64_t lastUpdateTime;
-        glm::vec3 lastPosition;
-        glm::quat lastOrientation;
-        glm::vec3 lastVelocity;
-        glm::vec3 lastAcceleration;
 
-        glm::vec3 predictedPosition;
-        glm::quat predictedOrientation;
+        Net::InterpolationBuffer states;    // States received from the server, the ship is shown at the app's render time between them.
+        bool predicted = false;     // Our own ship while predicting, the app sets its pose instead of the interpolation.
 
-        float timeSinceLastPacket = 0;
-
-        const float normalSpeed = 1.0f;
-        const float boostSpeed = normalSpeed * 2.0f;
-        const float accelerationFactor = 1.0f;
-        const float camOffsetY = 1.0f;
-        const float cameraSmoothFactor = 10.0f;
-
-        float currentSpeed = 0.0f;
-
-        float rotationZ = 0;
-        float rotXSmooth = 0;
-        float rotYSmooth = 0;
-        float rotZSmooth = 0;
+        static constexpr float camOffsetY = 1.0f;
+        static constexpr float cameraSmoothFactor = 10.0f;
+        static constexpr float maxExtrapolationTime = 0.25f;    // Seconds a state is extrapolated at most.
 
         uint32_t uuid;
 
@@ -125,13 +88,11 @@ namespace Game
         Render::ParticleEmitter* particleEmitterRight;
         float emitterOffset = -0.5f;
 
-        void Update(float dt, uint32_t id);
+        void Update(float dt, uint32_t id, double renderTime);
 
         void UpdateThrusters(float dt);
 
-        glm::vec3 PredictPosition();
-
-        void ApplyInterpolation(float dt);
+        void ApplyInterpolation(double renderTime);
 
         bool CheckCollisions();
 
@@ -139,7 +100,7 @@ namespace Game
 
         glm::vec3 SpawnInRandomPosition(float radius);
 
-        const glm::vec3 colliderEndPoints[8] = {
+        static inline const glm::vec3 colliderEndPoints[8] = {
             glm::vec3(-1.10657, -0.480347, -0.346542),  // right wing
             glm::vec3(1.10657, -0.480347, -0.346542),  // left wing
             glm::vec3(-0.342382, 0.25109, -0.010299),   // right top